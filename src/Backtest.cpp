@@ -0,0 +1,596 @@
+// src/Backtest.cpp
+#include "Backtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+const char kHistoryMagic[8] = { 'M', 'M', 'H', 'I', 'S', 'T', '1', '\n' };
+const uint64_t kNever = std::numeric_limits<uint64_t>::max();
+const uint64_t kQuoteTimerTickNs = 1000; // Requote and stale timers to the microsecond
+
+MarketAnalytics::Params quoteOnlyAnalytics() {
+    MarketAnalytics::Params params;
+    params.barIntervalNs = 0; // Only the microprice is used
+    params.volumeBarSize = 0.0;
+    return params;
+}
+
+} // namespace
+
+// --- MarketHistory ---
+
+bool MarketHistory::loadCsv(const std::string& path, std::string& error) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        error = "Cannot open " + path;
+        return false;
+    }
+
+    std::unordered_map<std::string, uint32_t> index;
+    std::string line;
+    std::vector<std::string> fields;
+    size_t lineNumber = 0;
+    bool sorted = true;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        fields.clear();
+        size_t begin = 0;
+        for (;;) {
+            size_t comma = line.find(',', begin);
+            fields.push_back(line.substr(begin, comma == std::string::npos ? std::string::npos : comma - begin));
+            if (comma == std::string::npos) {
+                break;
+            }
+            begin = comma + 1;
+        }
+
+        bool isQuote = fields.size() == 7 && fields[2] == "Q";
+        bool isTrade = fields.size() == 5 && fields[2] == "T";
+        if (!isQuote && !isTrade) {
+            std::ostringstream message;
+            message << path << ":" << lineNumber << ": expected ts,symbol,Q,bid,bid_size,ask,ask_size or ts,symbol,T,price,size";
+            error = message.str();
+            return false;
+        }
+
+        auto it = index.find(fields[1]);
+        if (it == index.end()) {
+            it = index.emplace(fields[1], static_cast<uint32_t>(symbols.size())).first;
+            symbols.push_back(fields[1]);
+        }
+
+        Event event;
+        event.timeNs = std::strtoull(fields[0].c_str(), nullptr, 10);
+        event.symbol = it->second;
+        event.type = isQuote ? Event::Quote : Event::Trade;
+        event.bid = std::strtod(fields[3].c_str(), nullptr);
+        event.bidSize = static_cast<uint32_t>(std::strtoul(fields[4].c_str(), nullptr, 10));
+        event.ask = isQuote ? std::strtod(fields[5].c_str(), nullptr) : 0.0;
+        event.askSize = isQuote ? static_cast<uint32_t>(std::strtoul(fields[6].c_str(), nullptr, 10)) : 0;
+        if (!events.empty() && event.timeNs < events.back().timeNs) {
+            sorted = false;
+        }
+        events.push_back(event);
+    }
+
+    if (!sorted) {
+        std::stable_sort(events.begin(), events.end(),
+                         [](const Event& a, const Event& b) { return a.timeNs < b.timeNs; });
+    }
+    return true;
+}
+
+bool MarketHistory::save(const std::string& path, std::string& error) const {
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "Cannot create " + path;
+        return false;
+    }
+    out.write(kHistoryMagic, sizeof(kHistoryMagic));
+    uint32_t symbolCount = static_cast<uint32_t>(symbols.size());
+    out.write(reinterpret_cast<const char*>(&symbolCount), sizeof(symbolCount));
+    for (const std::string& symbol : symbols) {
+        uint32_t length = static_cast<uint32_t>(symbol.size());
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(symbol.data(), length);
+    }
+    uint64_t eventCount = events.size();
+    out.write(reinterpret_cast<const char*>(&eventCount), sizeof(eventCount));
+    out.write(reinterpret_cast<const char*>(events.data()), events.size() * sizeof(Event));
+    if (!out) {
+        error = "Write failed on " + path;
+        return false;
+    }
+    return true;
+}
+
+bool MarketHistory::load(const std::string& path, std::string& error) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    char magic[sizeof(kHistoryMagic)];
+    if (!in || !in.read(magic, sizeof(magic)) || std::memcmp(magic, kHistoryMagic, sizeof(magic)) != 0) {
+        error = path + " is not a market history file";
+        return false;
+    }
+    uint32_t symbolCount = 0;
+    in.read(reinterpret_cast<char*>(&symbolCount), sizeof(symbolCount));
+    symbols.clear();
+    for (uint32_t i = 0; in && i < symbolCount; ++i) {
+        uint32_t length = 0;
+        in.read(reinterpret_cast<char*>(&length), sizeof(length));
+        std::string symbol(length, '\0');
+        in.read(&symbol[0], length);
+        symbols.push_back(symbol);
+    }
+    uint64_t eventCount = 0;
+    in.read(reinterpret_cast<char*>(&eventCount), sizeof(eventCount));
+    if (!in) {
+        error = path + " is truncated";
+        return false;
+    }
+    events.resize(eventCount);
+    if (!in.read(reinterpret_cast<char*>(events.data()), eventCount * sizeof(Event))) {
+        error = path + " is truncated";
+        return false;
+    }
+    return true;
+}
+
+bool MarketHistory::isBinary(const std::string& path) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    char magic[sizeof(kHistoryMagic)];
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, kHistoryMagic, sizeof(magic)) == 0;
+}
+
+MarketHistory MarketHistory::synthetic(const std::vector<std::pair<std::string, double> >& symbols,
+                                       size_t eventCount, uint64_t seed) {
+    const double tick = 0.01;
+    MarketHistory history;
+    std::vector<long long> midTicks;
+    for (const auto& entry : symbols) {
+        history.symbols.push_back(entry.first);
+        midTicks.push_back(std::llround(entry.second / tick));
+    }
+    if (symbols.empty()) {
+        return history;
+    }
+
+    std::mt19937_64 random(seed);
+    history.events.reserve(eventCount);
+    uint64_t timeNs = 0;
+    for (size_t i = 0; i < eventCount; ++i) {
+        timeNs += 100 + random() % 2000;
+        uint32_t symbol = static_cast<uint32_t>(random() % symbols.size());
+        uint64_t draw = random();
+
+        Event event;
+        event.timeNs = timeNs;
+        event.symbol = symbol;
+        long long spreadTicks = 1 + static_cast<long long>((draw >> 8) % 3);
+        double bid = (midTicks[symbol] - spreadTicks / 2) * tick;
+        double ask = bid + spreadTicks * tick;
+        if (draw % 10 == 0) {
+            // A trade at the touch
+            event.type = Event::Trade;
+            event.bid = (draw >> 16) % 2 == 0 ? bid : ask;
+            event.ask = 0.0;
+            event.bidSize = static_cast<uint32_t>(1 + (draw >> 20) % 500);
+            event.askSize = 0;
+        } else {
+            // Mid random walk, one tick at a time
+            int move = static_cast<int>((draw >> 4) % 5) - 2;
+            midTicks[symbol] += move > 1 ? 1 : move < -1 ? -1 : 0;
+            event.type = Event::Quote;
+            event.bid = (midTicks[symbol] - spreadTicks / 2) * tick;
+            event.ask = event.bid + spreadTicks * tick;
+            event.bidSize = static_cast<uint32_t>(100 + (draw >> 24) % 1900);
+            event.askSize = static_cast<uint32_t>(100 + (draw >> 40) % 1900);
+        }
+        history.events.push_back(event);
+    }
+    return history;
+}
+
+// --- BacktestResult ---
+
+double BacktestResult::pnl() const {
+    double total = 0.0;
+    for (const SymbolResult& symbol : symbols) {
+        total += symbol.pnl();
+    }
+    return total;
+}
+
+double BacktestResult::fees() const {
+    double total = 0.0;
+    for (const SymbolResult& symbol : symbols) {
+        total += symbol.fees;
+    }
+    return total;
+}
+
+long long BacktestResult::volume() const {
+    long long total = 0;
+    for (const SymbolResult& symbol : symbols) {
+        total += symbol.volume;
+    }
+    return total;
+}
+
+long long BacktestResult::maxAbsPosition() const {
+    long long largest = 0;
+    for (const SymbolResult& symbol : symbols) {
+        largest = std::max(largest, symbol.maxAbsPosition);
+    }
+    return largest;
+}
+
+// --- Backtester ---
+
+Backtester::Backtester(const MarketHistory& history, const BacktestConfig& config)
+    : m_history(history), m_config(config), m_now(0),
+      m_levels(history.symbols.size()),
+      m_venueOrders(history.symbols.size() * 2),
+      m_book(history.symbols),
+      m_analytics(history.symbols, quoteOnlyAnalytics()),
+      m_quoting(history.symbols, kQuoteTimerTickNs, 0),
+      m_quotes(config.quoting.signal.tickSize),
+      m_ids("BT-QUOTE"),
+      m_positions(history.symbols.size(), 0),
+      m_bookUpdated(history.symbols.size(), 0),
+      m_cycleScheduled(false), m_nextCycleNs(0)
+{
+    m_quoting.params() = config.quoting;
+    for (size_t i = 0; i < history.symbols.size(); ++i) {
+        m_symbolIndex[history.symbols[i]] = static_cast<uint32_t>(i);
+    }
+    m_result.config = config;
+    m_result.symbols.resize(history.symbols.size());
+}
+
+long long Backtester::toTicks(double price) const {
+    return std::llround(price / m_config.quoting.signal.tickSize);
+}
+
+BacktestResult Backtester::run() {
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<MarketHistory::Event>& events = m_history.events;
+    uint64_t lastEventNs = events.empty() ? 0 : events.back().timeNs;
+    size_t next = 0;
+
+    for (;;) {
+        uint64_t reportNs = m_toStrategy.empty() ? kNever : m_toStrategy.front().timeNs;
+        uint64_t arrivalNs = m_toVenue.empty() ? kNever : m_toVenue.front().timeNs;
+        uint64_t marketNs = next < events.size() ? events[next].timeNs : kNever;
+        uint64_t timerNs = m_quoting.nextTimerNs();
+        uint64_t cycleNs = m_cycleScheduled ? m_nextCycleNs : kNever;
+        uint64_t now = std::min(std::min(std::min(reportNs, arrivalNs), std::min(marketNs, timerNs)), cycleNs);
+        if (now == kNever || (next == events.size() && now > lastEventNs)) {
+            break; // Past the last market event nothing fills, so the rest is only churn
+        }
+        m_now = now;
+
+        // At equal times: reports, venue arrivals, market data, quoting timers, then the cycle
+        if (reportNs == now) {
+            Report report = std::move(m_toStrategy.front());
+            m_toStrategy.pop_front();
+            onReport(report);
+        } else if (arrivalNs == now) {
+            InFlightRequest request = std::move(m_toVenue.front());
+            m_toVenue.pop_front();
+            onRequestArrival(request);
+        } else if (marketNs == now) {
+            onMarketEvent(events[next++]);
+        } else if (timerNs == now) {
+            onQuoteTimers();
+        } else {
+            quoteCycle();
+        }
+    }
+
+    m_result.requests = m_quotes.stats();
+    m_result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return m_result;
+}
+
+void Backtester::onMarketEvent(const MarketHistory::Event& event) {
+    ++m_result.events;
+    uint32_t symbol = event.symbol;
+    if (event.type == MarketHistory::Event::Trade) {
+        onTrade(symbol, QuoteBook::Bid, event.bid, event.bidSize);
+        onTrade(symbol, QuoteBook::Ask, event.bid, event.bidSize);
+        return;
+    }
+
+    Level& level = m_levels[symbol];
+    level.bid = event.bid;
+    level.ask = event.ask;
+    level.bidSize = event.bidSize;
+    level.askSize = event.askSize;
+    if (event.bid > 0.0 && event.ask > 0.0) {
+        m_result.symbols[symbol].markPrice = (event.bid + event.ask) / 2.0;
+    }
+    if (m_config.quoting.quoteAroundMicroprice) {
+        m_analytics.onQuote(symbol, event.bid, event.ask, event.bidSize, event.askSize, m_now);
+    }
+    updateQueue(symbol, QuoteBook::Bid);
+    updateQueue(symbol, QuoteBook::Ask);
+
+    m_book.updateMarketData(m_history.symbols[symbol], event.bid, event.ask);
+    markChanged(symbol);
+}
+
+void Backtester::updateQueue(uint32_t symbol, QuoteBook::Side side) {
+    VenueOrder& order = venueOrder(symbol, side);
+    if (!order.live) {
+        return;
+    }
+    const Level& level = m_levels[symbol];
+    // Prices are compared as signed ticks, so "better" is larger on both sides
+    long long direction = side == QuoteBook::Bid ? 1 : -1;
+    long long ours = direction * toTicks(order.price);
+    double sameSide = side == QuoteBook::Bid ? level.bid : level.ask;
+    double farSide = side == QuoteBook::Bid ? level.ask : level.bid;
+    long long sameSize = side == QuoteBook::Bid ? level.bidSize : level.askSize;
+
+    if (farSide > 0.0 && direction * toTicks(farSide) <= ours) {
+        // The far side moved onto or through our price: we were taken out
+        fill(symbol, side, order, order.orderQty - order.cumQty, order.price, true);
+        return;
+    }
+    long long best = direction * toTicks(sameSide);
+    if (sameSide <= 0.0 || best < ours) {
+        order.ahead = 0; // We would be the best price
+    } else if (best == ours) {
+        order.ahead = order.ahead < 0 ? sameSize : std::min(order.ahead, sameSize);
+    }
+}
+
+void Backtester::onTrade(uint32_t symbol, QuoteBook::Side side, double price, long long size) {
+    VenueOrder& order = venueOrder(symbol, side);
+    if (!order.live) {
+        return;
+    }
+    long long direction = side == QuoteBook::Bid ? 1 : -1;
+    long long ours = direction * toTicks(order.price);
+    long long traded = direction * toTicks(price);
+    if (traded < ours) {
+        fill(symbol, side, order, size, order.price, true); // Traded through us
+    } else if (traded == ours && order.ahead >= 0) {
+        long long reachesUs = size - order.ahead;
+        order.ahead = std::max(0LL, order.ahead - size);
+        if (reachesUs > 0) {
+            fill(symbol, side, order, reachesUs, order.price, true);
+        }
+    }
+}
+
+void Backtester::onRequestArrival(const InFlightRequest& request) {
+    const QuoteBook::Action& action = request.action;
+    VenueOrder& order = venueOrder(request.symbol, action.side);
+
+    switch (action.type) {
+    case QuoteBook::Action::New:
+        order = VenueOrder();
+        order.live = true;
+        order.clOrdID = action.clOrdID;
+        order.price = action.price;
+        order.orderQty = action.size;
+        report(NewAck, request.symbol, action.clOrdID, 0, action.size);
+        place(request.symbol, action.side, order, false);
+        break;
+
+    case QuoteBook::Action::Replace: {
+        if (!order.live || order.clOrdID != action.origClOrdID) {
+            // Filled or gone before the replace arrived; the live engine frees the side
+            // the same way on an unknown-order cancel reject
+            report(Canceled, request.symbol, action.clOrdID, 0, 0);
+            break;
+        }
+        bool keepPriority = samePrice(order.price, action.price) && action.size <= order.orderQty;
+        order.clOrdID = action.clOrdID;
+        order.price = action.price;
+        order.orderQty = std::max(action.size, order.cumQty);
+        long long leaves = order.orderQty - order.cumQty;
+        if (leaves <= 0) {
+            order.live = false;
+            report(Canceled, request.symbol, action.clOrdID, 0, 0);
+            break;
+        }
+        report(ReplaceAck, request.symbol, action.clOrdID, 0, leaves);
+        place(request.symbol, action.side, order, keepPriority);
+        break;
+    }
+
+    case QuoteBook::Action::Cancel:
+        if (order.live && order.clOrdID == action.origClOrdID) {
+            order.live = false;
+        }
+        report(Canceled, request.symbol, action.clOrdID, 0, 0);
+        break;
+    }
+}
+
+void Backtester::place(uint32_t symbol, QuoteBook::Side side, VenueOrder& order, bool keepPriority) {
+    const Level& level = m_levels[symbol];
+    long long direction = side == QuoteBook::Bid ? 1 : -1;
+    long long ours = direction * toTicks(order.price);
+    double sameSide = side == QuoteBook::Bid ? level.bid : level.ask;
+    double farSide = side == QuoteBook::Bid ? level.ask : level.bid;
+
+    if (farSide > 0.0 && direction * toTicks(farSide) <= ours) {
+        // Marketable on arrival: takes liquidity at the far side's price
+        fill(symbol, side, order, order.orderQty - order.cumQty, farSide, false);
+        return;
+    }
+    if (keepPriority) {
+        return;
+    }
+    long long best = direction * toTicks(sameSide);
+    if (sameSide <= 0.0 || best < ours) {
+        order.ahead = 0;
+    } else if (best == ours) {
+        order.ahead = side == QuoteBook::Bid ? level.bidSize : level.askSize;
+    } else {
+        order.ahead = -1; // Behind the best price; queued for real once it reaches us
+    }
+}
+
+void Backtester::fill(uint32_t symbol, QuoteBook::Side side, VenueOrder& order, long long qty, double price, bool maker) {
+    long long leaves = order.orderQty - order.cumQty;
+    qty = std::min(qty, leaves);
+    if (qty <= 0) {
+        return;
+    }
+    order.cumQty += qty;
+    leaves -= qty;
+    if (leaves == 0) {
+        order.live = false;
+    }
+
+    long long delta = side == QuoteBook::Bid ? qty : -qty;
+    BacktestResult::SymbolResult& result = m_result.symbols[symbol];
+    result.position += delta;
+    result.cashFlow -= delta * price;
+    result.fees += qty * (maker ? m_config.makerFee : m_config.takerFee);
+    ++result.fills;
+    result.volume += qty;
+    result.maxAbsPosition = std::max(result.maxAbsPosition, std::abs(result.position));
+    if (maker) {
+        ++m_result.makerFills;
+    } else {
+        ++m_result.takerFills;
+    }
+    report(Fill, symbol, order.clOrdID, delta, leaves);
+}
+
+void Backtester::report(ReportType type, uint32_t symbol, const std::string& clOrdID, long long qtyDelta, long long leavesQty) {
+    Report report;
+    report.timeNs = m_now + m_config.reportLatencyNs;
+    report.type = type;
+    report.symbol = symbol;
+    report.clOrdID = clOrdID;
+    report.qtyDelta = qtyDelta;
+    report.leavesQty = leavesQty;
+    m_toStrategy.push_back(std::move(report));
+}
+
+void Backtester::onReport(const Report& report) {
+    switch (report.type) {
+    case NewAck:
+        m_quotes.onNewAck(report.clOrdID, report.clOrdID);
+        break;
+    case ReplaceAck:
+        m_quotes.onReplaceAck(report.clOrdID, "", report.leavesQty);
+        break;
+    case Canceled:
+        m_quotes.onCanceled(report.clOrdID);
+        break;
+    case Fill:
+        // Booked even if the quote has since been replaced or canceled on our side
+        m_positions[report.symbol] += report.qtyDelta;
+        m_quoting.setPosition(report.symbol, m_positions[report.symbol]);
+        m_quotes.onFill(report.clOrdID, report.leavesQty);
+        break;
+    }
+}
+
+void Backtester::markChanged(uint32_t symbol) {
+    if (!m_bookUpdated[symbol]) {
+        m_bookUpdated[symbol] = 1;
+        m_changedSymbols.push_back(symbol);
+    }
+    if (m_config.quoteIntervalNs == 0) {
+        quoteCycle();
+    } else if (!m_cycleScheduled) {
+        m_nextCycleNs = (m_now / m_config.quoteIntervalNs + 1) * m_config.quoteIntervalNs;
+        m_cycleScheduled = true;
+    }
+}
+
+void Backtester::onQuoteTimers() {
+    // A symbol still waiting for its cycle has updated, so it is not stale
+    m_actions.clear();
+    m_quoting.advance(m_now, [this](size_t index) { return m_bookUpdated[index] != 0; }, m_quotes, m_ids, m_actions);
+    sendActions();
+    if (!m_quoting.changes().empty()) {
+        quoteCycle(); // A deferred requote is due; the live engine runs a pass for it at once
+    }
+}
+
+void Backtester::quoteCycle() {
+    m_cycleScheduled = false;
+    ++m_result.quoteCycles;
+
+    // StrategyEngine::manageQuotes with a simulated clock: the latest top of book for
+    // each symbol that moved, one compute(), then decide() against what is working
+    for (uint32_t symbol : m_changedSymbols) {
+        m_bookUpdated[symbol] = 0;
+        TopOfBook top = m_book.getMarketData(m_history.symbols[symbol]);
+        double microprice = m_config.quoting.quoteAroundMicroprice ? m_analytics.microprice(symbol) : 0.0;
+        m_quoting.onMarket(symbol, top.bid, top.ask, microprice, 1, m_now);
+    }
+    m_changedSymbols.clear();
+    if (m_quoting.changes().empty()) {
+        return;
+    }
+    m_quoting.compute();
+    m_actions.clear();
+    m_quoting.decide(m_now, m_quotes, m_ids, m_actions);
+    sendActions();
+}
+
+void Backtester::sendActions() {
+    for (QuoteBook::Action& action : m_actions) {
+        InFlightRequest request;
+        request.timeNs = m_now + m_config.orderLatencyNs;
+        request.symbol = m_symbolIndex[action.symbol];
+        request.action = std::move(action);
+        m_toVenue.push_back(std::move(request));
+    }
+    m_actions.clear();
+}
+
+// --- Parameter sweeps ---
+
+std::vector<BacktestResult> runBacktests(const MarketHistory& history, const std::vector<BacktestConfig>& configs,
+                                         unsigned threads) {
+    std::vector<BacktestResult> results(configs.size());
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min<unsigned>(threads, std::max<size_t>(configs.size(), 1));
+
+    // Workers pull the next config as they finish, so uneven run times balance out
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < configs.size(); i = next.fetch_add(1)) {
+            Backtester backtester(history, configs[i]);
+            results[i] = backtester.run();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.push_back(std::thread(worker));
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    return results;
+}
@@ -0,0 +1,216 @@
+//
+// Backtest.h
+// HFT
+//
+#ifndef BACKTEST_H
+#define BACKTEST_H
+
+#include "OrderBook.h"
+#include "QuotingCycle.h"
+#include "QuoteBook.h"
+#include "IdGenerator.h"
+#include "MarketAnalytics.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+
+// Recorded market data, loaded once and shared read-only by every backtest run
+struct MarketHistory {
+    // One top-of-book update or one trade, in time order
+    struct Event {
+        enum Type : uint32_t { Quote = 0, Trade = 1 };
+
+        uint64_t timeNs;
+        uint32_t symbol;  // Index into symbols
+        uint32_t type;
+        double bid;       // Trade: trade price
+        double ask;
+        uint32_t bidSize; // Trade: trade size
+        uint32_t askSize;
+    };
+
+    std::vector<std::string> symbols;
+    std::vector<Event> events;
+
+    // CSV, one event per line (lines starting with # are skipped):
+    //   timestamp_ns,symbol,Q,bid,bid_size,ask,ask_size
+    //   timestamp_ns,symbol,T,price,size
+    // Events are sorted by time if the file is not already in order.
+    bool loadCsv(const std::string& path, std::string& error);
+
+    // Binary form of the same events: far faster to reload than CSV for repeated runs
+    bool save(const std::string& path, std::string& error) const;
+    bool load(const std::string& path, std::string& error);
+    static bool isBinary(const std::string& path);
+
+    // Random-walk quotes and trades for the given symbols, reproducible from seed
+    static MarketHistory synthetic(const std::vector<std::pair<std::string, double> >& symbols,
+                                   size_t eventCount, uint64_t seed);
+};
+
+struct BacktestConfig {
+    QuotingCycle::Params quoting; // The live engine's quoting parameters
+    uint64_t quoteIntervalNs;     // Quote cycle period (QuoteRefreshMs); 0 re-quotes a symbol on each of its updates
+    uint64_t orderLatencyNs;      // Strategy -> venue
+    uint64_t reportLatencyNs;     // Venue -> strategy
+    double makerFee;              // Per share filled while resting; negative is a rebate
+    double takerFee;              // Per share filled on arrival (our order crossed the market)
+
+    BacktestConfig() : quoteIntervalNs(0),
+                       orderLatencyNs(20000), reportLatencyNs(20000),
+                       makerFee(-0.002), takerFee(0.003) {}
+};
+
+struct BacktestResult {
+    struct SymbolResult {
+        long long position;
+        long long maxAbsPosition;
+        double cashFlow;
+        double fees;
+        double markPrice; // Last mid, used to value the open position
+        uint64_t fills;
+        long long volume;
+
+        SymbolResult() : position(0), maxAbsPosition(0), cashFlow(0.0), fees(0.0), markPrice(0.0),
+                         fills(0), volume(0) {}
+        double pnl() const { return cashFlow + position * markPrice - fees; }
+    };
+
+    BacktestConfig config;
+    std::vector<SymbolResult> symbols;
+
+    uint64_t events;
+    uint64_t quoteCycles;
+    QuoteBook::Stats requests; // News, replaces and cancels sent to the venue
+    uint64_t makerFills;
+    uint64_t takerFills;
+    double wallSeconds;
+
+    BacktestResult() : events(0), quoteCycles(0), makerFills(0), takerFills(0), wallSeconds(0.0) {}
+
+    double pnl() const;
+    double fees() const;
+    long long volume() const;
+    long long maxAbsPosition() const;
+};
+
+// Replays a MarketHistory through the live quoting pipeline on a simulated clock:
+// a ShardOrderBook holds top of book and MarketAnalytics the microprice, and each
+// pass runs the StrategyEngine's QuotingCycle, so pricing, the position limit, the
+// minimum quote life and stale pulls all behave as they do live. As live, a pass
+// re-quotes the symbols whose market moved (plus due requotes); acks and fills alone
+// do not trigger one. Requests reach a simulated venue after orderLatencyNs and its
+// acks and fills come back after reportLatencyNs, so the strategy always acts on
+// slightly stale state. The run ends at the last market event: nothing can fill after it.
+//
+// Queue position at the venue, from top-of-book sizes and trades:
+//  - joining the best price queues behind its whole displayed size; improving it
+//    puts us first; resting behind it, we join the back once it becomes the best
+//  - the size ahead only shrinks (to at most the displayed size, and by trades at
+//    our price); a trade through our price, or the far side crossing it, fills us
+//  - an order that crosses the market on arrival fills immediately at the far
+//    side as a taker; a replace keeps its place only when the price is unchanged
+//    and the size does not grow
+//
+// Single-threaded; one Backtester per run. Runs share nothing but the history.
+class Backtester {
+public:
+    Backtester(const MarketHistory& history, const BacktestConfig& config);
+
+    BacktestResult run();
+
+private:
+    enum ReportType { NewAck, ReplaceAck, Canceled, Fill };
+
+    struct InFlightRequest {
+        uint64_t timeNs; // Arrival at the venue
+        uint32_t symbol;
+        QuoteBook::Action action;
+    };
+
+    struct Report {
+        uint64_t timeNs; // Arrival at the strategy
+        ReportType type;
+        uint32_t symbol;
+        std::string clOrdID;
+        long long qtyDelta; // Fill: signed, + when our bid was hit
+        long long leavesQty;
+    };
+
+    // Our order resting at the venue; at most one per symbol and side
+    struct VenueOrder {
+        bool live;
+        std::string clOrdID;
+        double price;
+        long long orderQty;
+        long long cumQty;
+        long long ahead; // Displayed size queued in front of us; -1 while behind the best price
+
+        VenueOrder() : live(false), price(0.0), orderQty(0), cumQty(0), ahead(-1) {}
+    };
+
+    struct Level {
+        double bid;
+        double ask;
+        long long bidSize;
+        long long askSize;
+
+        Level() : bid(0.0), ask(0.0), bidSize(0), askSize(0) {}
+    };
+
+    // Venue side
+    void onMarketEvent(const MarketHistory::Event& event);
+    void onRequestArrival(const InFlightRequest& request);
+    void updateQueue(uint32_t symbol, QuoteBook::Side side);
+    void onTrade(uint32_t symbol, QuoteBook::Side side, double price, long long size);
+    void place(uint32_t symbol, QuoteBook::Side side, VenueOrder& order, bool keepPriority);
+    void fill(uint32_t symbol, QuoteBook::Side side, VenueOrder& order, long long qty, double price, bool maker);
+    void report(ReportType type, uint32_t symbol, const std::string& clOrdID, long long qtyDelta, long long leavesQty);
+
+    // Strategy side
+    void onReport(const Report& report);
+    void markChanged(uint32_t symbol);
+    void quoteCycle();
+    void onQuoteTimers();
+    void sendActions();
+
+    bool samePrice(double a, double b) const { return toTicks(a) == toTicks(b); }
+    long long toTicks(double price) const;
+    VenueOrder& venueOrder(uint32_t symbol, QuoteBook::Side side) { return m_venueOrders[symbol * 2 + side]; }
+
+    const MarketHistory& m_history;
+    BacktestConfig m_config;
+    uint64_t m_now;
+
+    // What the venue sees
+    std::vector<Level> m_levels;
+    std::vector<VenueOrder> m_venueOrders;
+    BacktestResult m_result;
+
+    // What the strategy sees
+    ShardOrderBook m_book;
+    MarketAnalytics m_analytics;
+    QuotingCycle m_quoting;
+    QuoteBook m_quotes;
+    IdGenerator m_ids;
+    std::unordered_map<std::string, uint32_t> m_symbolIndex;
+    std::vector<long long> m_positions;       // As reported by fills that have arrived
+    std::vector<char> m_bookUpdated;          // New top of book since the last cycle
+    std::vector<uint32_t> m_changedSymbols;   // The symbols with m_bookUpdated set
+    std::vector<QuoteBook::Action> m_actions;
+    bool m_cycleScheduled;
+    uint64_t m_nextCycleNs;
+
+    std::deque<InFlightRequest> m_toVenue;   // Latencies are fixed, so both directions stay FIFO
+    std::deque<Report> m_toStrategy;
+};
+
+// Runs every config over the same history on `threads` worker threads (0: one per
+// core). Results come back in config order.
+std::vector<BacktestResult> runBacktests(const MarketHistory& history, const std::vector<BacktestConfig>& configs,
+                                         unsigned threads);
+
+#endif // BACKTEST_H
@@ -0,0 +1,211 @@
+//
+// CoStrategy.h
+// HFT
+//
+#ifndef CO_STRATEGY_H
+#define CO_STRATEGY_H
+
+#if __cplusplus < 202002L
+#error "CoStrategy.h is C++20; C++14 code drives the runtime through StrategyRuntime.h"
+#endif
+
+#include "StrategyRuntime.h"
+#include "IdGenerator.h"
+#include "TimerWheel.h"
+#include "TscClock.h"
+
+#include <algorithm>
+#include <coroutine>
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+// Coroutine strategies: sequential code that suspends on market events.
+//
+//   StrategyTask hedge(StrategyShard& shard, std::string symbol) {
+//       for (;;) {
+//           StrategyFill fill = co_await shard.nextFill(symbol);
+//           StrategyReport report = co_await shard.send(order, std::chrono::milliseconds(500));
+//           if (report.status != StrategyReport::Filled) {
+//               co_await shard.sleepFor(std::chrono::milliseconds(100));
+//           }
+//       }
+//   }
+//   shard.spawn([](StrategyShard& shard) { return hedge(shard, "AAPL"); });
+//
+// A coroutine only ever runs on its shard's loop thread, so strategy state needs no
+// locks. Awaitables must only be awaited from that thread.
+
+// Fire-and-forget coroutine: starts on spawn, frees itself when it returns. One still
+// suspended when the runtime stops is destroyed where it waits.
+class StrategyTask {
+public:
+    struct promise_type {
+        StrategyTask get_return_object() { return StrategyTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception(); // Logged; the coroutine ends
+    };
+};
+
+class StrategyShard {
+public:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::function<StrategyTask(StrategyShard& shard)> Body;
+
+    struct QuoteAwaiter {
+        StrategyShard& shard;
+        std::string symbol;
+        StrategyQuote quote;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { shard.waitQuote(symbol, handle, &quote); }
+        StrategyQuote await_resume() const noexcept { return quote; }
+    };
+
+    struct FillAwaiter {
+        StrategyShard& shard;
+        std::string symbol;
+        StrategyFill fill;
+
+        bool await_ready() { return shard.takeFill(symbol, fill); }
+        void await_suspend(std::coroutine_handle<> handle) { shard.waitFill(symbol, handle, &fill); }
+        StrategyFill await_resume() const noexcept { return fill; }
+    };
+
+    struct OrderAwaiter {
+        StrategyShard& shard;
+        StrategyOrder order;
+        Clock::duration timeout;
+        StrategyReport report;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) { return shard.sendOrder(order, timeout, handle, &report); }
+        StrategyReport await_resume() const noexcept { return report; }
+    };
+
+    struct SleepAwaiter {
+        StrategyShard& shard;
+        uint64_t deadlineNs; // TscClock
+
+        bool await_ready() const noexcept { return deadlineNs <= TscClock::nowNs(); }
+        void await_suspend(std::coroutine_handle<> handle) { shard.addTimer(deadlineNs, handle, nullptr); }
+        void await_resume() const noexcept {}
+    };
+
+    StrategyShard(size_t index, const StrategyRuntime::OrderSender& sender);
+    ~StrategyShard();
+
+    void start();
+    void stop();
+
+    size_t index() const { return m_index; }
+
+    // Any thread, once started: runs body on the loop thread and starts the coroutine it returns
+    void spawn(const Body& body);
+
+    // Any thread
+    void postQuote(const std::string& symbol, const StrategyQuote& quote);
+    void postFill(const StrategyFill& fill);
+    void postExecution(const StrategyExecution& execution);
+
+    // --- Loop thread only ---
+
+    // Next quote update for symbol
+    QuoteAwaiter nextQuote(const std::string& symbol) { return QuoteAwaiter{*this, symbol, StrategyQuote()}; }
+    // Next fill in symbol. Fills are queued from the first call on, so none are
+    // missed while the coroutine is busy awaiting something else.
+    FillAwaiter nextFill(const std::string& symbol) { return FillAwaiter{*this, symbol, StrategyFill()}; }
+    bool hasFill(const std::string& symbol) const;
+    // Sends order and resumes with its outcome: once it is done (or acked, if it may
+    // rest), or with TimedOut after timeout
+    OrderAwaiter send(const StrategyOrder& order, Clock::duration timeout) {
+        return OrderAwaiter{*this, order, timeout, StrategyReport()};
+    }
+    SleepAwaiter sleepFor(Clock::duration duration) { return SleepAwaiter{*this, deadlineAfter(duration)}; }
+
+    // Latest quote seen for symbol, or null
+    const StrategyQuote* latestQuote(const std::string& symbol) const;
+
+private:
+    struct Event {
+        enum Kind { Quote, Fill, Execution, Spawn };
+
+        Kind kind;
+        std::string symbol;
+        StrategyQuote quote;
+        StrategyFill fill;
+        StrategyExecution execution;
+        Body body;
+    };
+
+    // A sleeping coroutine (handle set) or an order timeout (clOrdID set: the key of
+    // its m_orders entry, which cancels the timer when it goes)
+    struct Timer {
+        std::coroutine_handle<> handle;
+        const std::string* clOrdID = nullptr;
+    };
+    typedef TimerWheel<Timer> TimerQueue;
+
+    struct PendingOrder {
+        std::coroutine_handle<> handle;
+        StrategyReport* report;
+        bool immediateOrCancel;
+        double notional;
+        TimerQueue::TimerId timeout;
+    };
+
+    struct FillQueue {
+        std::deque<StrategyFill> fills;
+        std::coroutine_handle<> waiter;
+        StrategyFill* target;
+
+        FillQueue() : target(nullptr) {}
+    };
+
+    struct QuoteWaiter {
+        std::coroutine_handle<> handle;
+        StrategyQuote* target;
+    };
+
+    void enqueue(Event& event);
+    void run();
+    void dispatch(Event& event);
+    void onExecution(const StrategyExecution& execution);
+    void fireTimers();
+    void destroySuspended();
+
+    void waitQuote(const std::string& symbol, std::coroutine_handle<> handle, StrategyQuote* target);
+    bool takeFill(const std::string& symbol, StrategyFill& fill);
+    void waitFill(const std::string& symbol, std::coroutine_handle<> handle, StrategyFill* target);
+    bool sendOrder(StrategyOrder& order, Clock::duration timeout, std::coroutine_handle<> handle, StrategyReport* report);
+    TimerQueue::TimerId addTimer(uint64_t deadlineNs, std::coroutine_handle<> handle, const std::string* clOrdID);
+    static uint64_t deadlineAfter(Clock::duration duration) {
+        return TscClock::nowNs() + static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::max(duration, Clock::duration::zero())).count());
+    }
+
+    size_t m_index;
+    StrategyRuntime::OrderSender m_sender;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<Event> m_pending; // Guarded by m_mutex
+    bool m_running;
+    std::thread m_thread;
+
+    // Loop thread only
+    IdGenerator m_orderIds;
+    std::unordered_map<std::string, StrategyQuote> m_latest;
+    std::unordered_map<std::string, std::vector<QuoteWaiter> > m_quoteWaiters;
+    std::unordered_map<std::string, FillQueue> m_fills;
+    std::unordered_map<std::string, PendingOrder> m_orders; // ClOrdID -> awaiting coroutine
+    TimerQueue m_timers;
+};
+
+#endif // CO_STRATEGY_H
@@ -0,0 +1,127 @@
+//
+// ConflationBuffer.h
+// HFT
+//
+#ifndef CONFLATION_BUFFER_H
+#define CONFLATION_BUFFER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+
+#include "MemoryRegion.h"
+
+// Latest-value-wins buffer between the market data producer and a slow consumer.
+//
+// The producer overwrites one slot per symbol (guarded by a per-slot seqlock) and
+// sets that symbol's bit in a dirty bitmap. The consumer atomically swaps each
+// bitmap word to zero and reads only the symbols that changed, so one drain costs
+// O(symbols) no matter how many ticks arrived while it was busy.
+//
+// One producer thread per buffer; any single consumer thread may drain.
+class ConflationBuffer {
+public:
+    // Latest state for one symbol as seen by the consumer
+    struct Update {
+        size_t index;
+        double bid;
+        double ask;
+        uint64_t ticksConflated; // Ticks folded into this update since the last drain
+    };
+
+    explicit ConflationBuffer(const std::vector<std::string>& symbols)
+        : m_symbols(symbols),
+          m_slots(symbols.size()),
+          m_wordCount((symbols.size() + 63) / 64),
+          m_dirty(m_wordCount)
+    {
+        for (size_t i = 0; i < m_symbols.size(); ++i) {
+            m_indexBySymbol[m_symbols[i]] = i;
+        }
+        for (size_t w = 0; w < m_wordCount; ++w) {
+            m_dirty[w].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    size_t size() const { return m_symbols.size(); }
+    const std::string& symbolAt(size_t index) const { return m_symbols[index]; }
+
+    // Returns -1 for symbols this buffer does not carry
+    long indexOf(const std::string& symbol) const {
+        auto it = m_indexBySymbol.find(symbol);
+        return it != m_indexBySymbol.end() ? static_cast<long>(it->second) : -1;
+    }
+
+    // Producer side: overwrite the pending state and mark the symbol dirty
+    void publish(size_t index, double bid, double ask) {
+        Slot& slot = m_slots[index];
+        uint32_t seq = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(seq + 1, std::memory_order_relaxed); // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.bid.store(bid, std::memory_order_relaxed);
+        slot.ask.store(ask, std::memory_order_relaxed);
+        slot.pendingTicks.fetch_add(1, std::memory_order_relaxed);
+        slot.sequence.store(seq + 2, std::memory_order_release);
+
+        m_dirty[index / 64].fetch_or(uint64_t(1) << (index % 64), std::memory_order_release);
+    }
+
+    // Consumer side: whether the symbol changed since the previous drain, without draining it
+    bool pending(size_t index) const {
+        return (m_dirty[index / 64].load(std::memory_order_acquire) >> (index % 64)) & 1;
+    }
+
+    // Consumer side: calls fn(const Update&) once per symbol that changed since the
+    // previous drain, with its most recent state. Returns the number of symbols visited.
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        size_t visited = 0;
+        for (size_t w = 0; w < m_wordCount; ++w) {
+            uint64_t bits = m_dirty[w].exchange(0, std::memory_order_acquire);
+            while (bits != 0) {
+                size_t index = w * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+                bits &= bits - 1;
+
+                Update update;
+                update.index = index;
+                read(m_slots[index], update);
+                fn(update);
+                ++visited;
+            }
+        }
+        return visited;
+    }
+
+private:
+    struct alignas(64) Slot { // One cache line per symbol
+        std::atomic<double> bid;
+        std::atomic<double> ask;
+        std::atomic<uint64_t> pendingTicks;
+        std::atomic<uint32_t> sequence;
+
+        Slot() : bid(0.0), ask(0.0), pendingTicks(0), sequence(0) {}
+    };
+
+    static void read(Slot& slot, Update& update) {
+        uint32_t before, after;
+        do {
+            before = slot.sequence.load(std::memory_order_acquire);
+            update.bid = slot.bid.load(std::memory_order_relaxed);
+            update.ask = slot.ask.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = slot.sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+        update.ticksConflated = slot.pendingTicks.exchange(0, std::memory_order_relaxed);
+    }
+
+    std::vector<std::string> m_symbols;
+    std::unordered_map<std::string, size_t> m_indexBySymbol;
+    RegionVector<Slot> m_slots; // Cache-line aligned on the huge-page arena
+    size_t m_wordCount;
+    RegionVector<std::atomic<uint64_t> > m_dirty;
+};
+
+#endif // CONFLATION_BUFFER_H
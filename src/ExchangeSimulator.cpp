@@ -0,0 +1,441 @@
+// src/ExchangeSimulator.cpp
+#include "ExchangeSimulator.h"
+#include "ThreadTopology.h"
+#include "FixValidator.h"
+#include "TscClock.h"
+#include <quickfix/Session.h>
+#include <quickfix/FieldConvertors.h> // For FIX::UtcTimeStamp
+#include <quickfix/FixFields.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+
+namespace {
+
+const uint64_t kExpiryTickNs = 1000000;        // Expiry resolution: 1 ms
+const uint64_t kExpiryMaxWaitNs = 1000000000;  // The expiry thread re-checks at least once a second
+const int kSecondsPerDay = 24 * 60 * 60;
+
+// YYYYMMDD or YYYYMMDD-HH:MM:SS[.sss] as UTC seconds; a bare date means secondsOfDay
+// into that day. Fractions round up, so an order never expires early.
+bool parseUtc(const std::string& text, int secondsOfDay, time_t& result) {
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    int parsed = std::sscanf(text.c_str(), "%4d%2d%2d-%2d:%2d:%2d", &year, &month, &day, &hour, &minute, &second);
+    if (parsed != 3 && parsed != 6) {
+        return false;
+    }
+    struct tm fields = {};
+    fields.tm_year = year - 1900;
+    fields.tm_mon = month - 1;
+    fields.tm_mday = day;
+    result = timegm(&fields);
+    if (parsed == 3) {
+        result += secondsOfDay;
+    } else {
+        result += hour * 3600 + minute * 60 + second + (text.find('.') != std::string::npos ? 1 : 0);
+    }
+    return true;
+}
+
+// A wall-clock deadline on the TscClock timeline the expiry wheel runs on
+uint64_t clockNsAt(time_t utcSeconds) {
+    long long remainingNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::from_time_t(utcSeconds) - std::chrono::system_clock::now()).count();
+    uint64_t now = TscClock::nowNs();
+    return remainingNs > 0 ? now + static_cast<uint64_t>(remainingNs) : now;
+}
+
+} // namespace
+
+ExchangeSimulator::ExchangeSimulator(OrderBook* marketBook)
+    : m_marketBook(marketBook),
+      m_dayEndSeconds(23 * 3600 + 59 * 60),
+      m_expiries(kExpiryTickNs, TscClock::nowNs()),
+      m_running(false), m_expiryWakeNs(0),
+      m_orderIds("EX-ORD"), m_execIds("EX-EXEC"),
+      m_randGen(std::chrono::system_clock::now().time_since_epoch().count()),
+      m_takerQtyDist(50, 300)
+{}
+
+ExchangeSimulator::~ExchangeSimulator() {
+    stop();
+}
+
+void ExchangeSimulator::start() {
+    if (m_running.exchange(true)) {
+        return;
+    }
+    m_expiryThread = std::thread([this]() {
+        ThreadTopology::apply(ThreadTopology::Background);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_running) {
+            ReportBatch reports;
+            expireOrders(reports);
+            if (!reports.empty()) {
+                lock.unlock();
+                sendReports(reports);
+                lock.lock();
+                continue;
+            }
+            // Until the next deadline; rest() wakes us early for a sooner one
+            uint64_t now = TscClock::nowNs();
+            m_expiryWakeNs = std::min(m_expiries.nextExpiryNs(), now + kExpiryMaxWaitNs);
+            m_expiryCond.wait_for(lock, std::chrono::nanoseconds(m_expiryWakeNs > now ? m_expiryWakeNs - now : 0));
+        }
+    });
+}
+
+void ExchangeSimulator::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_expiryCond.notify_all();
+    if (m_expiryThread.joinable()) {
+        m_expiryThread.join();
+    }
+}
+
+void ExchangeSimulator::onCreate(const FIX::SessionID& sessionID) {
+    std::cout << "ExchangeSimulator onCreate: " << sessionID << std::endl;
+}
+
+void ExchangeSimulator::onLogon(const FIX::SessionID& sessionID) {
+    std::cout << "ExchangeSimulator onLogon: " << sessionID << std::endl;
+}
+
+void ExchangeSimulator::onLogout(const FIX::SessionID& sessionID) {
+    std::cout << "ExchangeSimulator onLogout: " << sessionID << std::endl;
+    // Quotes are day orders tied to the session: pull everything the participant had resting
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_orders.begin(); it != m_orders.end();) {
+        if (it->second.sessionID == sessionID) {
+            it = erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ExchangeSimulator::toAdmin(FIX::Message& message, const FIX::SessionID& sessionID) {}
+
+void ExchangeSimulator::toApp(FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::DoNotSend) {}
+
+void ExchangeSimulator::fromAdmin(const FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::RejectLogon) {
+    ThreadTopology::applyOnce(ThreadTopology::Fix);
+}
+
+void ExchangeSimulator::fromApp(const FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::UnsupportedMessageType) {
+    ThreadTopology::applyOnce(ThreadTopology::Fix);
+    FixValidator::validate(message);
+    crack(message, sessionID);
+}
+
+// --- Order Entry ---
+
+void ExchangeSimulator::onMessage(const FIX42::NewOrderSingle& message, const FIX::SessionID& sessionID) {
+    FIX::ClOrdID clOrdID;
+    FIX::Symbol symbol;
+    FIX::Side side;
+    FIX::OrderQty orderQty;
+    FIX::Price price;
+    message.get(clOrdID);
+    message.get(symbol);
+    message.get(side);
+    message.get(orderQty);
+    message.get(price); // Only limit quotes are accepted
+    FIX::TimeInForce timeInForce(FIX::TimeInForce_DAY);
+    if (message.isSetField(FIX::FIELD::TimeInForce)) {
+        message.get(timeInForce);
+    }
+
+    RestingOrder order;
+    order.orderID = m_orderIds.next().str();
+    order.clOrdID = clOrdID.getValue();
+    order.symbol = symbol.getValue();
+    order.side = side.getValue();
+    order.price = price.getValue();
+    order.orderQty = static_cast<long long>(orderQty.getValue());
+    order.cumQty = 0;
+    order.notional = 0.0;
+    order.sessionID = sessionID;
+    order.expiresNs = expiryFor(message, timeInForce.getValue());
+    order.expiryTimer = 0;
+
+    ReportBatch reports;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_orders.count(order.clOrdID)) {
+            FIX42::ExecutionReport reject = makeReport(order, FIX::ExecType_REJECTED, FIX::OrdStatus_REJECTED, 0, 0.0);
+            reject.set(FIX::OrdRejReason(FIX::OrdRejReason_DUPLICATE_ORDER));
+            reports.push_back(std::make_pair(reject, sessionID));
+        } else {
+            reports.push_back(std::make_pair(makeReport(order, FIX::ExecType_NEW, FIX::OrdStatus_NEW, 0, 0.0), sessionID));
+            // A quote that is marketable on arrival trades immediately
+            OrderBook::MarketData market = m_marketBook->getMarketData(order.symbol);
+            bool done = matchAgainst(order, market.bid, market.ask, reports);
+            if (!done && timeInForce == FIX::TimeInForce_IMMEDIATE_OR_CANCEL) {
+                // Whatever did not trade on arrival is canceled instead of resting
+                FIX42::ExecutionReport canceled = makeReport(order, FIX::ExecType_CANCELED, FIX::OrdStatus_CANCELED, 0, 0.0);
+                canceled.set(FIX::LeavesQty(0));
+                reports.push_back(std::make_pair(canceled, sessionID));
+            } else if (!done) {
+                rest(order);
+            }
+        }
+    }
+    sendReports(reports);
+}
+
+void ExchangeSimulator::onMessage(const FIX42::OrderCancelReplaceRequest& message, const FIX::SessionID& sessionID) {
+    FIX::OrigClOrdID origClOrdID;
+    FIX::ClOrdID clOrdID;
+    FIX::OrderQty orderQty;
+    FIX::Price price;
+    message.get(origClOrdID);
+    message.get(clOrdID);
+    message.get(orderQty);
+    message.get(price);
+
+    ReportBatch reports;
+    bool unknownOrder = false;
+    bool duplicateClOrdID = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_orders.find(origClOrdID.getValue());
+        if (it == m_orders.end()) {
+            unknownOrder = true; // Already filled or canceled
+        } else if (m_orders.count(clOrdID.getValue())) {
+            duplicateClOrdID = true; // In use by a working order, the original included; it stays as it is
+        } else {
+            RestingOrder order = it->second;
+            erase(it);
+            order.clOrdID = clOrdID.getValue();
+            order.price = price.getValue();
+            order.orderQty = std::max(static_cast<long long>(orderQty.getValue()), order.cumQty);
+
+            FIX42::ExecutionReport replaced = makeReport(order, FIX::ExecType_REPLACE, FIX::OrdStatus_REPLACED, 0, 0.0);
+            replaced.set(origClOrdID);
+            reports.push_back(std::make_pair(replaced, sessionID));
+
+            OrderBook::MarketData market = m_marketBook->getMarketData(order.symbol);
+            bool done = order.cumQty >= order.orderQty || matchAgainst(order, market.bid, market.ask, reports);
+            if (!done) {
+                rest(order); // Keeps its original expiry
+            }
+        }
+    }
+
+    if (unknownOrder) {
+        rejectCancel(sessionID, clOrdID.getValue(), origClOrdID.getValue(),
+                     FIX::CxlRejResponseTo_ORDER_CANCEL_REPLACE_REQUEST);
+        return;
+    }
+    if (duplicateClOrdID) {
+        rejectCancel(sessionID, clOrdID.getValue(), origClOrdID.getValue(),
+                     FIX::CxlRejResponseTo_ORDER_CANCEL_REPLACE_REQUEST, FIX::CxlRejReason_BROKER_OPTION,
+                     "Duplicate ClOrdID");
+        return;
+    }
+    sendReports(reports);
+}
+
+void ExchangeSimulator::onMessage(const FIX42::OrderCancelRequest& message, const FIX::SessionID& sessionID) {
+    FIX::OrigClOrdID origClOrdID;
+    FIX::ClOrdID clOrdID;
+    message.get(origClOrdID);
+    message.get(clOrdID);
+
+    ReportBatch reports;
+    bool unknownOrder = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_orders.find(origClOrdID.getValue());
+        if (it == m_orders.end()) {
+            unknownOrder = true;
+        } else {
+            RestingOrder order = it->second;
+            erase(it);
+            order.clOrdID = clOrdID.getValue();
+            FIX42::ExecutionReport canceled = makeReport(order, FIX::ExecType_CANCELED, FIX::OrdStatus_CANCELED, 0, 0.0);
+            canceled.set(FIX::LeavesQty(0));
+            canceled.set(origClOrdID);
+            reports.push_back(std::make_pair(canceled, sessionID));
+        }
+    }
+
+    if (unknownOrder) {
+        rejectCancel(sessionID, clOrdID.getValue(), origClOrdID.getValue(),
+                     FIX::CxlRejResponseTo_ORDER_CANCEL_REQUEST);
+        return;
+    }
+    sendReports(reports);
+}
+
+// --- Matching ---
+
+void ExchangeSimulator::onMarketTick(const std::string& symbol, double bid, double ask) {
+    ReportBatch reports;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_orders.begin(); it != m_orders.end();) {
+            if (it->second.symbol == symbol && matchAgainst(it->second, bid, ask, reports)) {
+                it = erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    sendReports(reports);
+}
+
+bool ExchangeSimulator::matchAgainst(RestingOrder& order, double bid, double ask, ReportBatch& reports) {
+    // Our resting bid is hit when the market offers at or below it, our offer is lifted
+    // when the market bids at or above it. The resting order sets the trade price.
+    bool crossed = (order.side == FIX::Side_BUY && ask > 0.0 && order.price >= ask) ||
+                   (order.side == FIX::Side_SELL && bid > 0.0 && order.price <= bid);
+    if (!crossed) {
+        return false;
+    }
+
+    long long leaves = order.orderQty - order.cumQty;
+    long long lastQty = std::min<long long>(leaves, m_takerQtyDist(m_randGen));
+    order.cumQty += lastQty;
+    order.notional += lastQty * order.price;
+
+    bool filled = order.cumQty >= order.orderQty;
+    reports.push_back(std::make_pair(
+        makeReport(order, filled ? FIX::ExecType_FILL : FIX::ExecType_PARTIAL_FILL,
+                   filled ? FIX::OrdStatus_FILLED : FIX::OrdStatus_PARTIALLY_FILLED, lastQty, order.price),
+        order.sessionID));
+    std::cout << "ExchangeSimulator: Trade " << order.symbol << " " << lastQty << " @ " << order.price
+              << " against " << order.clOrdID << (filled ? " (filled)" : " (partial)") << std::endl;
+    return filled;
+}
+
+// --- Expiry ---
+
+uint64_t ExchangeSimulator::expiryFor(const FIX42::NewOrderSingle& message, char timeInForce) const {
+    time_t now = std::time(nullptr);
+    time_t expires = 0;
+    if (timeInForce == FIX::TimeInForce_GOOD_TILL_DATE) {
+        if (message.isSetField(FIX::FIELD::ExpireTime) &&
+            parseUtc(message.getField(FIX::FIELD::ExpireTime), m_dayEndSeconds, expires)) {
+            return clockNsAt(expires);
+        }
+        if (message.isSetField(FIX::FIELD::ExpireDate) &&
+            parseUtc(message.getField(FIX::FIELD::ExpireDate), m_dayEndSeconds, expires)) {
+            return clockNsAt(expires);
+        }
+        std::cout << "ExchangeSimulator: GTD order without ExpireTime/ExpireDate, treating it as DAY" << std::endl;
+    } else if (timeInForce != FIX::TimeInForce_DAY) {
+        return 0; // GTC rests until canceled; IOC never rests
+    }
+    // Today's end time, or tomorrow's once today's has passed
+    expires = now - now % kSecondsPerDay + m_dayEndSeconds;
+    if (expires <= now) {
+        expires += kSecondsPerDay;
+    }
+    return clockNsAt(expires);
+}
+
+void ExchangeSimulator::rest(const RestingOrder& order) {
+    auto existing = m_orders.find(order.clOrdID);
+    if (existing != m_orders.end()) {
+        // Order entry turns away ClOrdIDs that are working, so this is a bug; at least
+        // stop the old order's expiry timer from firing on the one replacing it
+        std::cerr << "ExchangeSimulator: " << order.clOrdID << " was already resting; replacing it" << std::endl;
+        erase(existing);
+    }
+    RestingOrder& resting = m_orders[order.clOrdID];
+    resting = order;
+    resting.expiryTimer = 0;
+    if (resting.expiresNs != 0) {
+        resting.expiryTimer = m_expiries.schedule(resting.expiresNs, &resting);
+        if (resting.expiresNs < m_expiryWakeNs) {
+            m_expiryCond.notify_one();
+        }
+    }
+}
+
+ExchangeSimulator::OrderMap::iterator ExchangeSimulator::erase(OrderMap::iterator it) {
+    if (it->second.expiryTimer != 0) {
+        m_expiries.cancel(it->second.expiryTimer);
+    }
+    return m_orders.erase(it);
+}
+
+void ExchangeSimulator::expireOrders(ReportBatch& reports) {
+    m_expiries.advance(TscClock::nowNs(), [this, &reports](RestingOrder* order) {
+        FIX42::ExecutionReport expired = makeReport(*order, FIX::ExecType_EXPIRED, FIX::OrdStatus_EXPIRED, 0, 0.0);
+        expired.set(FIX::LeavesQty(0));
+        reports.push_back(std::make_pair(expired, order->sessionID));
+        std::cout << "ExchangeSimulator: Expired " << order->clOrdID << " (" << order->symbol << ", "
+                  << (order->orderQty - order->cumQty) << " unfilled)" << std::endl;
+        m_orders.erase(m_orders.find(order->clOrdID));
+    });
+}
+
+FIX42::ExecutionReport ExchangeSimulator::makeReport(const RestingOrder& order, char execType, char ordStatus,
+                                                     long long lastQty, double lastPx) {
+    FIX42::ExecutionReport report(
+        FIX::OrderID(order.orderID),
+        FIX::ExecID(m_execIds.next().str()),
+        FIX::ExecTransType_NEW,
+        FIX::ExecType(execType),
+        FIX::OrdStatus(ordStatus),
+        FIX::Symbol(order.symbol),
+        FIX::Side(order.side),
+        FIX::LeavesQty(ordStatus == FIX::OrdStatus_REJECTED ? 0 : static_cast<int>(order.orderQty - order.cumQty)),
+        FIX::CumQty(static_cast<int>(order.cumQty)),
+        FIX::AvgPx(order.cumQty > 0 ? order.notional / order.cumQty : 0.0)
+    );
+    report.set(FIX::ClOrdID(order.clOrdID));
+    report.set(FIX::OrderQty(static_cast<int>(order.orderQty)));
+    report.set(FIX::Price(order.price));
+    report.setField(FIX::LastQty(static_cast<int>(lastQty)));
+    report.setField(FIX::LastPx(lastPx));
+    report.set(FIX::TransactTime(FIX::UtcTimeStamp::now()));
+    return report;
+}
+
+void ExchangeSimulator::rejectCancel(const FIX::SessionID& sessionID, const std::string& clOrdID,
+                                     const std::string& origClOrdID, char responseTo, int reason,
+                                     const std::string& text) {
+    FIX42::OrderCancelReject reject(
+        FIX::OrderID("NONE"),
+        FIX::ClOrdID(clOrdID),
+        FIX::OrigClOrdID(origClOrdID),
+        FIX::OrdStatus(FIX::OrdStatus_REJECTED),
+        FIX::CxlRejResponseTo(responseTo)
+    );
+    reject.set(FIX::CxlRejReason(reason));
+    reject.set(FIX::Text(text));
+    try {
+        FIX::Session::sendToTarget(reject, sessionID);
+    } catch (const FIX::SessionNotFound& e) {
+        std::cerr << "ExchangeSimulator Error sending cancel reject: " << e.what() << std::endl;
+    }
+}
+
+void ExchangeSimulator::sendReports(ReportBatch& reports) {
+    // A tick usually fills several orders of the same session: look it up once per run
+    FIX::Session* session = nullptr;
+    const FIX::SessionID* current = nullptr;
+    for (auto& entry : reports) {
+        if (!current || !(entry.second == *current)) {
+            current = &entry.second;
+            session = FIX::Session::lookupSession(entry.second);
+        }
+        if (!session) {
+            std::cerr << "ExchangeSimulator Error sending ExecutionReport: Session Not Found - " << entry.second << std::endl;
+            continue;
+        }
+        session->send(entry.first);
+    }
+}
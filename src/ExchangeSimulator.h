@@ -0,0 +1,116 @@
+#ifndef EXCHANGE_SIMULATOR_H
+#define EXCHANGE_SIMULATOR_H
+
+#include <quickfix/Application.h>
+#include <quickfix/MessageCracker.h>
+#include <quickfix/fix42/NewOrderSingle.h>
+#include <quickfix/fix42/OrderCancelRequest.h>
+#include <quickfix/fix42/OrderCancelReplaceRequest.h>
+#include <quickfix/fix42/ExecutionReport.h>
+#include <quickfix/fix42/OrderCancelReject.h>
+
+#include "OrderBook.h"
+#include "IdGenerator.h"
+#include "TimerWheel.h"
+
+#include <string>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <random>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
+// Local stand-in for an upstream venue. The market maker connects to it as a FIX
+// initiator and routes its quotes here. Quotes rest in the simulator's own book and
+// are filled whenever the simulator's market (an independent mock feed) trades
+// through them; acks and fills go back as ExecutionReports.
+//
+// Resting orders expire like a venue's: DAY orders at the day's end time, GTD orders
+// at their ExpireTime (or at the end of their ExpireDate). Their deadlines sit in a
+// timer wheel under m_mutex; start() runs the thread that sends the Expired reports.
+class ExchangeSimulator : public FIX::Application, public FIX::MessageCracker {
+public:
+    // marketBook holds the simulator's own top of book, driven by its own feed
+    ExchangeSimulator(OrderBook* marketBook);
+    ~ExchangeSimulator();
+
+    // Seconds after midnight UTC at which DAY orders expire (default 23:59:00)
+    void setDayOrderEndTime(int secondsOfDay) { m_dayEndSeconds = secondsOfDay; }
+    // Start/stop the order expiry thread
+    void start();
+    void stop();
+
+    void onCreate(const FIX::SessionID& sessionID) override;
+    void onLogon(const FIX::SessionID& sessionID) override;
+    void onLogout(const FIX::SessionID& sessionID) override;
+    void toAdmin(FIX::Message& message, const FIX::SessionID& sessionID) override;
+    void toApp(FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::DoNotSend) override;
+    void fromAdmin(const FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::RejectLogon) override;
+    void fromApp(const FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::UnsupportedMessageType) override;
+
+    // Order entry from the market maker
+    void onMessage(const FIX42::NewOrderSingle& message, const FIX::SessionID& sessionID) override;
+    void onMessage(const FIX42::OrderCancelReplaceRequest& message, const FIX::SessionID& sessionID) override;
+    void onMessage(const FIX42::OrderCancelRequest& message, const FIX::SessionID& sessionID) override;
+
+    // Called for every tick of the simulator's market; fills resting orders it crosses
+    void onMarketTick(const std::string& symbol, double bid, double ask);
+
+private:
+    struct RestingOrder {
+        std::string orderID;
+        std::string clOrdID;
+        std::string symbol;
+        char side;
+        double price;
+        long long orderQty;
+        long long cumQty;
+        double notional; // Sum of fill qty * price, for AvgPx
+        FIX::SessionID sessionID;
+        uint64_t expiresNs;  // TscClock time; 0 if the order never expires
+        uint64_t expiryTimer; // In m_expiries while the order rests
+    };
+
+    typedef RegionMap<std::string, RestingOrder> OrderMap;
+    typedef std::vector<std::pair<FIX42::ExecutionReport, FIX::SessionID> > ReportBatch;
+
+    FIX42::ExecutionReport makeReport(const RestingOrder& order, char execType, char ordStatus,
+                                      long long lastQty, double lastPx);
+    // Fills order against the given market if it crosses it; appends the fill report
+    bool matchAgainst(RestingOrder& order, double bid, double ask, ReportBatch& reports);
+    void sendReports(ReportBatch& reports);
+    void rejectCancel(const FIX::SessionID& sessionID, const std::string& clOrdID,
+                      const std::string& origClOrdID, char responseTo,
+                      int reason = FIX::CxlRejReason_UNKNOWN_ORDER, const std::string& text = "Unknown order");
+
+    // When an order of this TimeInForce expires, in TscClock ns; 0 for never
+    uint64_t expiryFor(const FIX42::NewOrderSingle& message, char timeInForce) const;
+    // Caller holds m_mutex. Orders enter m_orders through rest() and leave through
+    // erase(), which keep their expiry timers in step.
+    void rest(const RestingOrder& order);
+    OrderMap::iterator erase(OrderMap::iterator it);
+    void expireOrders(ReportBatch& reports);
+
+    OrderBook* m_marketBook;
+    std::mutex m_mutex; // FIX thread (order entry) and feed thread (matching) share the book
+    OrderMap m_orders; // Working ClOrdID -> order
+
+    // Order expiry. Timers point at entries of m_orders, whose addresses are stable.
+    int m_dayEndSeconds;
+    TimerWheel<RestingOrder*> m_expiries;
+    std::atomic<bool> m_running;
+    std::thread m_expiryThread;
+    std::condition_variable m_expiryCond; // Waited on with m_mutex
+    uint64_t m_expiryWakeNs; // When the expiry thread next wakes by itself
+
+    IdGenerator m_orderIds;
+    IdGenerator m_execIds;
+
+    // Size each simulated aggressor takes from a crossed quote (partial fills happen)
+    std::mt19937 m_randGen;
+    std::uniform_int_distribution<> m_takerQtyDist;
+};
+
+#endif // EXCHANGE_SIMULATOR_H
@@ -0,0 +1,59 @@
+// src/FillHedger.cpp
+// Built as C++20 (see CMakeLists.txt); must not include QuickFIX headers.
+#include "FillHedger.h"
+#include "CoStrategy.h"
+
+#include <iostream>
+#include <cstdlib>
+
+namespace {
+
+StrategyTask hedgeFills(StrategyShard& shard, std::string symbol, FillHedgerParams params, long long position) {
+    // position: booked at start, then net of every fill since, our hedges included.
+    // Inventory restored on a warm restart is hedged before waiting for a fill.
+    bool restored = std::llabs(position) >= params.minQty;
+    for (;;) {
+        if (!restored) {
+            position += (co_await shard.nextFill(symbol)).qty;
+        }
+        restored = false;
+
+        for (int attempt = 0; std::llabs(position) >= params.minQty && attempt < params.maxAttempts; ++attempt) {
+            if (!shard.latestQuote(symbol)) {
+                co_await shard.nextQuote(symbol);
+            }
+            const StrategyQuote& quote = *shard.latestQuote(symbol);
+
+            StrategyOrder order;
+            order.symbol = symbol;
+            order.qty = -position;
+            order.limitPrice = order.qty > 0 ? quote.ask + params.slippage : quote.bid - params.slippage;
+            order.immediateOrCancel = true;
+            StrategyReport report = co_await shard.send(order, std::chrono::milliseconds(params.ackTimeoutMs));
+
+            // Hedge fills are queued before the report that ends the order, so they are
+            // already here; take them (and any new client fills) into the position
+            while (shard.hasFill(symbol)) {
+                position += (co_await shard.nextFill(symbol)).qty;
+            }
+            std::cout << "FillHedger: " << symbol << " hedge of " << order.qty << " @ " << order.limitPrice << ": "
+                      << report.filledQty << " filled (status " << report.status << "), position now " << position
+                      << std::endl;
+            if (report.status != StrategyReport::Filled) {
+                co_await shard.sleepFor(std::chrono::milliseconds(params.retryDelayMs));
+            }
+        }
+    }
+}
+
+} // namespace
+
+void startFillHedgers(StrategyRuntime& runtime, const std::vector<std::string>& symbols, const FillHedgerParams& params,
+                      const PositionSource& bookedPosition) {
+    for (const std::string& symbol : symbols) {
+        long long position = bookedPosition ? bookedPosition(symbol) : 0;
+        runtime.shardFor(symbol).spawn([symbol, params, position](StrategyShard& shard) {
+            return hedgeFills(shard, symbol, params, position);
+        });
+    }
+}
@@ -0,0 +1,39 @@
+//
+// FillHedger.h
+// HFT
+//
+#ifndef FILL_HEDGER_H
+#define FILL_HEDGER_H
+
+#include "StrategyRuntime.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Coroutine strategy that flattens our position after fills: one coroutine per symbol
+// follows every fill (client orders, quotes and its own hedges), and once the net
+// position reaches minQty it sends IOC orders at the touch until it is back under
+// minQty, backing off after rejects, timeouts and unfilled attempts. The position
+// starts from what is already booked, so inventory restored on a warm restart is
+// hedged like any other.
+struct FillHedgerParams {
+    long long minQty;     // Smallest position worth hedging
+    int maxAttempts;      // Orders per hedge before waiting for the next fill
+    int ackTimeoutMs;
+    int retryDelayMs;
+    double slippage;      // Price added beyond the touch so the IOC trades
+
+    FillHedgerParams() : minQty(100), maxAttempts(3), ackTimeoutMs(500), retryDelayMs(100), slippage(0.01) {}
+};
+
+// Booked net position in a symbol (StrategyEngine::positionQty)
+typedef std::function<long long(const std::string& symbol)> PositionSource;
+
+// Starts one hedger per symbol on the symbol's shard, each from the symbol's booked
+// position; runtime must be started. Call before fills can arrive: a fill booked
+// before its hedger starts is counted both in the position and as a fill.
+void startFillHedgers(StrategyRuntime& runtime, const std::vector<std::string>& symbols, const FillHedgerParams& params,
+                      const PositionSource& bookedPosition);
+
+#endif // FILL_HEDGER_H
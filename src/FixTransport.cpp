@@ -0,0 +1,424 @@
+// src/FixTransport.cpp
+#include "FixTransport.h"
+
+#include <quickfix/SocketAcceptor.h>
+#include <quickfix/SocketInitiator.h>
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+namespace {
+
+const int kSendTimeoutMs = 1000;  // Peer not draining its ring for this long: give up on the message
+const int kClaimTimeoutMs = 1000; // Acceptor not answering a claim
+const int kSessionPollMs = 200;   // Session::next() cadence for heartbeats and timeouts
+const int kReadWaitMs = 100;
+
+// BufferingResponder of each connected shm session, for SendBatch
+std::mutex g_respondersMutex;
+std::map<FIX::SessionID, std::shared_ptr<BufferingResponder> > g_responders;
+
+std::shared_ptr<BufferingResponder> attachResponder(const FIX::SessionID& sessionID, ShmLink& link) {
+    std::shared_ptr<BufferingResponder> responder(new BufferingResponder(link));
+    std::lock_guard<std::mutex> lock(g_respondersMutex);
+    g_responders[sessionID] = responder;
+    return responder;
+}
+
+void detachResponder(const FIX::SessionID& sessionID, BufferingResponder& responder) {
+    {
+        std::lock_guard<std::mutex> lock(g_respondersMutex);
+        auto it = g_responders.find(sessionID);
+        if (it != g_responders.end() && it->second.get() == &responder) {
+            g_responders.erase(it);
+        }
+    }
+    responder.detach(); // A SendBatch may still hold it; the link itself is about to go
+}
+
+std::string getOr(const FIX::Dictionary& dictionary, const std::string& key, const std::string& fallback) {
+    return dictionary.has(key) ? dictionary.getString(key) : fallback;
+}
+
+// Counts the sessions of connectionType that use shm and socket; mixing them is an error
+bool sessionsUseShm(const FIX::SessionSettings& settings, const std::string& connectionType) throw(FIX::ConfigError) {
+    int shm = 0;
+    int socket = 0;
+    for (const FIX::SessionID& sessionID : settings.getSessions()) {
+        const FIX::Dictionary& session = settings.get(sessionID);
+        if (getOr(session, "ConnectionType", "") != connectionType) {
+            continue;
+        }
+        ++(FixTransport::usesShm(session) ? shm : socket);
+    }
+    if (shm > 0 && socket > 0) {
+        throw FIX::ConfigError("All " + connectionType + " sessions must use the same ConnectionTransport");
+    }
+    return shm > 0;
+}
+
+} // namespace
+
+namespace FixTransport {
+
+bool usesShm(const FIX::Dictionary& session) {
+    return getOr(session, "ConnectionTransport", "socket") == "shm";
+}
+
+ShmSettings shmSettings(const FIX::Dictionary& session) throw(FIX::ConfigError) {
+    ShmSettings settings;
+    std::string port = getOr(session, "SocketAcceptPort", getOr(session, "SocketConnectPort", ""));
+    settings.name = getOr(session, "SharedMemoryName", port.empty() ? "" : "/fix_shm_" + port);
+    if (settings.name.empty() || settings.name[0] != '/') {
+        throw FIX::ConfigError("SharedMemoryName must be set and start with '/' (" + settings.name + ")");
+    }
+    settings.ringBytes = static_cast<size_t>(std::atoll(getOr(session, "SharedMemoryRingBytes", "1048576").c_str()));
+
+    std::string wait = getOr(session, "SharedMemoryWait", "futex");
+    if (wait == "spin") {
+        settings.wait = ShmTransport::Spin;
+    } else if (wait == "futex") {
+        settings.wait = ShmTransport::Futex;
+    } else {
+        throw FIX::ConfigError("SharedMemoryWait must be futex or spin, not " + wait);
+    }
+    settings.spinUs = std::atoi(getOr(session, "SharedMemorySpinUs", "50").c_str());
+    return settings;
+}
+
+void SendBatch::add(const FIX::SessionID& sessionID) {
+    std::shared_ptr<BufferingResponder> responder;
+    {
+        std::lock_guard<std::mutex> lock(g_respondersMutex);
+        auto it = g_responders.find(sessionID);
+        if (it == g_responders.end()) {
+            return; // Socket session, or not connected
+        }
+        responder = it->second;
+    }
+    for (const std::shared_ptr<BufferingResponder>& held : m_held) {
+        if (held == responder) {
+            return;
+        }
+    }
+    responder->hold();
+    m_held.push_back(responder);
+}
+
+void SendBatch::flush() {
+    for (const std::shared_ptr<BufferingResponder>& responder : m_held) {
+        responder->flush();
+    }
+    m_held.clear();
+}
+
+std::unique_ptr<FIX::Acceptor> makeAcceptor(FIX::Application& application, FIX::MessageStoreFactory& storeFactory,
+                                            const FIX::SessionSettings& settings, FIX::LogFactory& logFactory)
+    throw(FIX::ConfigError) {
+    if (sessionsUseShm(settings, "acceptor")) {
+        return std::unique_ptr<FIX::Acceptor>(new ShmAcceptor(application, storeFactory, settings, logFactory));
+    }
+    return std::unique_ptr<FIX::Acceptor>(new FIX::SocketAcceptor(application, storeFactory, settings, logFactory));
+}
+
+std::unique_ptr<FIX::Initiator> makeInitiator(FIX::Application& application, FIX::MessageStoreFactory& storeFactory,
+                                              const FIX::SessionSettings& settings, FIX::LogFactory& logFactory)
+    throw(FIX::ConfigError) {
+    if (sessionsUseShm(settings, "initiator")) {
+        return std::unique_ptr<FIX::Initiator>(new ShmInitiator(application, storeFactory, settings, logFactory));
+    }
+    return std::unique_ptr<FIX::Initiator>(new FIX::SocketInitiator(application, storeFactory, settings, logFactory));
+}
+
+} // namespace FixTransport
+
+// --- ShmLink ---
+
+ShmLink::ShmLink(ShmTransport::Channel& channel, const FixTransport::ShmSettings& settings)
+    : m_channel(channel), m_settings(settings) {}
+
+bool ShmLink::send(const std::string& message) {
+    // Session holds its lock here, so sends are already one at a time
+    return m_channel.send(message.data(), message.size(), kSendTimeoutMs);
+}
+
+bool ShmLink::send(const std::string* messages, size_t count) {
+    return m_channel.send(messages, count, kSendTimeoutMs);
+}
+
+void ShmLink::disconnect() {
+    m_channel.markClosed();
+}
+
+// --- BufferingResponder ---
+
+bool BufferingResponder::send(const std::string& message) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_link) {
+        return false;
+    }
+    if (m_holds > 0) {
+        // Already in the session's store, so a lost batch is resent like a lost message
+        m_held.push_back(message);
+        return true;
+    }
+    return m_link->send(message);
+}
+
+void BufferingResponder::disconnect() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_link) {
+        m_link->disconnect();
+    }
+}
+
+void BufferingResponder::hold() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_holds;
+}
+
+bool BufferingResponder::flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_holds > 0 && --m_holds > 0) {
+        return true; // An outer hold flushes
+    }
+    if (m_held.empty()) {
+        return true;
+    }
+    bool sent = m_link && m_link->send(m_held.data(), m_held.size());
+    if (!sent) {
+        std::cerr << "BufferingResponder: Dropped " << m_held.size() << " held messages; the peer recovers them by resend"
+                  << std::endl;
+    }
+    m_held.clear();
+    return sent;
+}
+
+void BufferingResponder::detach() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_link = nullptr;
+    m_held.clear();
+}
+
+void ShmLink::serve(FIX::Session& session, const std::atomic<bool>& stopping) {
+    typedef std::chrono::steady_clock Clock;
+
+    session.next(); // An initiator sends its Logon from here
+    Clock::time_point nextPoll = Clock::now() + std::chrono::milliseconds(kSessionPollMs);
+    std::string message;
+    while (!m_channel.closed() && !stopping) {
+        bool received = false;
+        while (m_channel.receive(message)) {
+            received = true;
+            try {
+                session.next(message, FIX::UtcTimeStamp());
+            } catch (const FIX::InvalidMessage&) {
+                // As the socket transport does: garbage before logon ends the connection
+                if (!session.isLoggedOn()) {
+                    m_channel.markClosed();
+                }
+            }
+            if (m_channel.closed()) {
+                break;
+            }
+        }
+        if (!received && m_channel.peerClosed()) {
+            break; // Everything the peer sent has been read
+        }
+        if (Clock::now() >= nextPoll) {
+            session.next();
+            nextPoll = Clock::now() + std::chrono::milliseconds(kSessionPollMs);
+        }
+        if (!received) {
+            m_channel.waitReadable(m_settings.wait, m_settings.spinUs, kReadWaitMs);
+        }
+    }
+    // Detaches us from the session (a no-op if the session disconnected itself) and
+    // tells the peer we are gone
+    session.disconnect();
+    m_channel.markClosed();
+}
+
+// --- ShmAcceptor ---
+
+ShmAcceptor::ShmAcceptor(FIX::Application& application, FIX::MessageStoreFactory& storeFactory,
+                         const FIX::SessionSettings& settings, FIX::LogFactory& logFactory) throw(FIX::ConfigError)
+    : FIX::Acceptor(application, storeFactory, settings, logFactory), m_stopping(false) {}
+
+ShmAcceptor::~ShmAcceptor() {
+    onStop();
+}
+
+void ShmAcceptor::onConfigure(const FIX::SessionSettings& settings) throw(FIX::ConfigError) {
+    for (const FIX::SessionID& sessionID : getSessions()) {
+        FixTransport::shmSettings(settings.get(sessionID)); // Throws on bad settings
+    }
+}
+
+void ShmAcceptor::onInitialize(const FIX::SessionSettings& settings) throw(FIX::RuntimeError) {
+    m_endpoints.clear();
+    m_stopping = false;
+    for (const FIX::SessionID& sessionID : getSessions()) {
+        std::unique_ptr<Endpoint> endpoint(new Endpoint());
+        endpoint->sessionID = sessionID;
+        endpoint->settings = FixTransport::shmSettings(settings.get(sessionID));
+        std::string error;
+        if (!endpoint->channel.create(endpoint->settings.name, endpoint->settings.ringBytes, error)) {
+            throw FIX::RuntimeError(error);
+        }
+        std::cout << "ShmAcceptor: " << sessionID << " listening on " << endpoint->settings.name << std::endl;
+        m_endpoints[sessionID] = std::move(endpoint);
+    }
+}
+
+void ShmAcceptor::onStart() {
+    for (auto& entry : m_endpoints) {
+        Endpoint* endpoint = entry.second.get();
+        endpoint->thread = std::thread([this, endpoint]() { serveEndpoint(*endpoint); });
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_wake.wait(lock, [this]() { return m_stopping.load(); });
+}
+
+bool ShmAcceptor::onPoll(double timeout) {
+    return false; // Session threads do the work; poll() is not supported
+}
+
+void ShmAcceptor::onStop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& entry : m_endpoints) {
+        if (entry.second->thread.joinable()) {
+            entry.second->thread.join();
+        }
+        entry.second->channel.close();
+    }
+}
+
+bool ShmAcceptor::waitStopping(int ms) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_wake.wait_for(lock, std::chrono::milliseconds(ms), [this]() { return m_stopping.load(); });
+}
+
+void ShmAcceptor::serveEndpoint(Endpoint& endpoint) {
+    ShmTransport::Channel& channel = endpoint.channel;
+    while (!m_stopping) {
+        if (!channel.claimed()) {
+            waitStopping(10);
+            continue;
+        }
+        FIX::Session* session = FIX::Session::registerSession(endpoint.sessionID);
+        if (!session) {
+            std::cerr << "ShmAcceptor: " << endpoint.sessionID << " is already connected; turning away "
+                      << endpoint.settings.name << std::endl;
+            channel.reject();
+            continue;
+        }
+        channel.accept();
+        std::cout << "ShmAcceptor: " << endpoint.sessionID << " connected over " << endpoint.settings.name << std::endl;
+
+        ShmLink link(channel, endpoint.settings);
+        std::shared_ptr<BufferingResponder> responder = attachResponder(endpoint.sessionID, link);
+        session->setResponder(responder.get());
+        link.serve(*session, m_stopping);
+        detachResponder(endpoint.sessionID, *responder);
+        FIX::Session::unregisterSession(endpoint.sessionID);
+
+        // The initiator may still be reading; the rings are only reset once it has let go
+        while (!channel.peerClosed() && !waitStopping(10)) {
+        }
+        channel.release();
+        std::cout << "ShmAcceptor: " << endpoint.sessionID << " disconnected" << std::endl;
+    }
+}
+
+// --- ShmInitiator ---
+
+ShmInitiator::ShmInitiator(FIX::Application& application, FIX::MessageStoreFactory& storeFactory,
+                           const FIX::SessionSettings& settings, FIX::LogFactory& logFactory) throw(FIX::ConfigError)
+    : FIX::Initiator(application, storeFactory, settings, logFactory), m_reconnectInterval(30), m_stopping(false) {}
+
+ShmInitiator::~ShmInitiator() {
+    onStop();
+}
+
+void ShmInitiator::onConfigure(const FIX::SessionSettings& settings) throw(FIX::ConfigError) {
+    const FIX::Dictionary& defaults = settings.get();
+    if (defaults.has("ReconnectInterval")) {
+        m_reconnectInterval = defaults.getInt("ReconnectInterval");
+    }
+    for (const FIX::SessionID& sessionID : getSessions()) {
+        FixTransport::shmSettings(settings.get(sessionID)); // Throws on bad settings
+    }
+    m_stopping = false;
+}
+
+void ShmInitiator::onStart() {
+    connect();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_wake.wait_for(lock, std::chrono::seconds(m_reconnectInterval), [this]() { return m_stopping.load(); })) {
+        lock.unlock();
+        connect(); // Sessions that are disconnected and in their session time
+        lock.lock();
+    }
+}
+
+bool ShmInitiator::onPoll(double timeout) {
+    return false; // Connection threads do the work; poll() is not supported
+}
+
+void ShmInitiator::onStop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    // No new connections once m_stopping is set
+    for (auto& entry : m_connections) {
+        if (entry.second.joinable()) {
+            entry.second.join();
+        }
+    }
+}
+
+void ShmInitiator::doConnect(const FIX::SessionID& sessionID, const FIX::Dictionary& settings) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopping) {
+        return;
+    }
+    // The session is disconnected, so its previous thread has finished
+    std::thread& thread = m_connections[sessionID];
+    if (thread.joinable()) {
+        thread.join();
+    }
+    setPending(sessionID);
+    thread = std::thread(&ShmInitiator::runConnection, this, sessionID, FixTransport::shmSettings(settings));
+}
+
+void ShmInitiator::runConnection(FIX::SessionID sessionID, FixTransport::ShmSettings settings) {
+    ShmTransport::Channel channel;
+    std::string error;
+    if (!channel.claim(settings.name, kClaimTimeoutMs, error)) {
+        std::cerr << "ShmInitiator: " << sessionID << ": " << error << std::endl;
+        setDisconnected(sessionID);
+        return;
+    }
+    std::cout << "ShmInitiator: " << sessionID << " connected over " << settings.name << std::endl;
+
+    ShmLink link(channel, settings);
+    std::shared_ptr<BufferingResponder> responder = attachResponder(sessionID, link);
+    FIX::Session* session = getSession(sessionID, *responder);
+    if (session) {
+        setConnected(sessionID);
+        link.serve(*session, m_stopping);
+    }
+    detachResponder(sessionID, *responder);
+    channel.markClosed();
+    channel.close();
+    std::cout << "ShmInitiator: " << sessionID << " disconnected" << std::endl;
+    setDisconnected(sessionID); // Last: doConnect may join this thread from here on
+}
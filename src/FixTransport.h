@@ -0,0 +1,177 @@
+//
+// FixTransport.h
+// HFT
+//
+#ifndef FIX_TRANSPORT_H
+#define FIX_TRANSPORT_H
+
+#include "ShmTransport.h"
+
+#include <quickfix/Acceptor.h>
+#include <quickfix/Initiator.h>
+#include <quickfix/Session.h>
+#include <quickfix/SessionSettings.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class BufferingResponder;
+
+// Chooses how FIX sessions reach their counterparty. Per session:
+//
+//   ConnectionTransport=socket|shm   (default socket)
+//   SharedMemoryName=/fix_shm_9876   (default /fix_shm_<SocketAcceptPort|SocketConnectPort>)
+//   SharedMemoryRingBytes=1048576    (per direction)
+//   SharedMemoryWait=futex|spin      (spin keeps the reader on its core)
+//   SharedMemorySpinUs=50            (futex: how long to poll before sleeping)
+//
+// shm only works between processes on the same host; the session layer (logon,
+// sequence numbers, resends, heartbeats) is QuickFIX's either way. All sessions of
+// one acceptor or initiator must use the same transport.
+namespace FixTransport {
+
+struct ShmSettings {
+    std::string name;
+    size_t ringBytes;
+    ShmTransport::WaitMode wait;
+    int spinUs;
+
+    ShmSettings() : ringBytes(1 << 20), wait(ShmTransport::Futex), spinUs(50) {}
+};
+
+bool usesShm(const FIX::Dictionary& session);
+ShmSettings shmSettings(const FIX::Dictionary& session) throw(FIX::ConfigError);
+
+// Socket or shared-memory acceptor/initiator for the sessions of that ConnectionType in settings
+std::unique_ptr<FIX::Acceptor> makeAcceptor(FIX::Application& application, FIX::MessageStoreFactory& storeFactory,
+                                            const FIX::SessionSettings& settings, FIX::LogFactory& logFactory)
+    throw(FIX::ConfigError);
+std::unique_ptr<FIX::Initiator> makeInitiator(FIX::Application& application, FIX::MessageStoreFactory& storeFactory,
+                                              const FIX::SessionSettings& settings, FIX::LogFactory& logFactory)
+    throw(FIX::ConfigError);
+
+// Holds what the application sends on the added sessions and writes each one's
+// messages as a single transport write on flush() (or destruction), instead of one
+// write per message. Only shm sessions can: QuickFIX's socket connections install
+// themselves as the session's Responder and cannot be wrapped from outside, so adding
+// a socket session is a no-op and it keeps writing per message.
+class SendBatch {
+public:
+    SendBatch() {}
+    ~SendBatch() { flush(); }
+
+    void add(const FIX::SessionID& sessionID);
+    void flush();
+
+private:
+    SendBatch(const SendBatch&);
+    SendBatch& operator=(const SendBatch&);
+
+    std::vector<std::shared_ptr<BufferingResponder> > m_held;
+};
+
+} // namespace FixTransport
+
+// One connected session over a shared-memory channel. The session sends through it
+// (Responder); serve() feeds it what the peer sent until either side disconnects.
+class ShmLink : public FIX::Responder {
+public:
+    ShmLink(ShmTransport::Channel& channel, const FixTransport::ShmSettings& settings);
+
+    bool send(const std::string& message);
+    void disconnect();
+
+    // Several messages as one ring write; see ShmTransport::Channel
+    bool send(const std::string* messages, size_t count);
+
+    // Reader thread: runs session until the link closes or stopping is set
+    void serve(FIX::Session& session, const std::atomic<bool>& stopping);
+
+private:
+    ShmTransport::Channel& m_channel;
+    FixTransport::ShmSettings m_settings;
+};
+
+// The Responder a shm session is given: passes sends through to its ShmLink, except
+// while held, when they queue in send order (whichever thread sends) until the
+// outermost flush() writes them to the link at once. FixTransport::SendBatch holds
+// and flushes it by session.
+class BufferingResponder : public FIX::Responder {
+public:
+    explicit BufferingResponder(ShmLink& link) : m_link(&link), m_holds(0) {}
+
+    bool send(const std::string& message);
+    void disconnect();
+
+    void hold();
+    bool flush(); // False if the link did not take what was held
+    void detach(); // The link is going away: later sends fail, held ones are dropped
+
+private:
+    std::mutex m_mutex;
+    ShmLink* m_link;
+    int m_holds;
+    std::vector<std::string> m_held;
+};
+
+// Creates one segment per session and serves whichever initiator claims it, one
+// thread per session
+class ShmAcceptor : public FIX::Acceptor {
+public:
+    ShmAcceptor(FIX::Application& application, FIX::MessageStoreFactory& storeFactory,
+                const FIX::SessionSettings& settings, FIX::LogFactory& logFactory) throw(FIX::ConfigError);
+    ~ShmAcceptor();
+
+private:
+    struct Endpoint {
+        FIX::SessionID sessionID;
+        FixTransport::ShmSettings settings;
+        ShmTransport::Channel channel;
+        std::thread thread;
+    };
+
+    void onConfigure(const FIX::SessionSettings& settings) throw(FIX::ConfigError);
+    void onInitialize(const FIX::SessionSettings& settings) throw(FIX::RuntimeError);
+    void onStart();
+    bool onPoll(double timeout);
+    void onStop();
+
+    void serveEndpoint(Endpoint& endpoint);
+    bool waitStopping(int ms);
+
+    std::map<FIX::SessionID, std::unique_ptr<Endpoint> > m_endpoints;
+    std::atomic<bool> m_stopping;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+};
+
+// Claims the acceptor's segment for each session, retrying every ReconnectInterval
+class ShmInitiator : public FIX::Initiator {
+public:
+    ShmInitiator(FIX::Application& application, FIX::MessageStoreFactory& storeFactory,
+                 const FIX::SessionSettings& settings, FIX::LogFactory& logFactory) throw(FIX::ConfigError);
+    ~ShmInitiator();
+
+private:
+    void onConfigure(const FIX::SessionSettings& settings) throw(FIX::ConfigError);
+    void onStart();
+    bool onPoll(double timeout);
+    void onStop();
+    void doConnect(const FIX::SessionID& sessionID, const FIX::Dictionary& settings);
+
+    void runConnection(FIX::SessionID sessionID, FixTransport::ShmSettings settings);
+
+    int m_reconnectInterval; // Seconds
+    std::map<FIX::SessionID, std::thread> m_connections; // Guarded by m_mutex; one reader per session
+    std::atomic<bool> m_stopping;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+};
+
+#endif // FIX_TRANSPORT_H
@@ -0,0 +1,168 @@
+// src/FixValidator.cpp
+#include "FixValidator.h"
+#include "Fix42Dictionary.h" // Generated at build time from FIX42.xml
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+using Fix42Dictionary::FieldDef;
+
+bool isDigits(const char* text, size_t length) {
+    if (length == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+int twoDigits(const char* text) {
+    return (text[0] - '0') * 10 + (text[1] - '0');
+}
+
+bool isDate(const char* text, size_t length) { // YYYYMMDD
+    if (length != 8 || !isDigits(text, 8)) {
+        return false;
+    }
+    int month = twoDigits(text + 4);
+    int day = twoDigits(text + 6);
+    return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+bool isTime(const char* text, size_t length) { // HH:MM:SS[.fraction]
+    if (length < 8 || text[2] != ':' || text[5] != ':' || !isDigits(text, 2) || !isDigits(text + 3, 2) ||
+        !isDigits(text + 6, 2)) {
+        return false;
+    }
+    if (twoDigits(text) > 23 || twoDigits(text + 3) > 59 || twoDigits(text + 6) > 60) { // 60: leap second
+        return false;
+    }
+    return length == 8 || (text[8] == '.' && length - 9 <= 9 && isDigits(text + 9, length - 9));
+}
+
+bool isFloat(const char* text, size_t length) {
+    size_t i = length > 0 && text[0] == '-' ? 1 : 0;
+    bool digits = false;
+    bool point = false;
+    for (; i < length; ++i) {
+        if (text[i] >= '0' && text[i] <= '9') {
+            digits = true;
+        } else if (text[i] == '.' && !point) {
+            point = true;
+        } else {
+            return false;
+        }
+    }
+    return digits;
+}
+
+bool hasFormat(const FieldDef& field, const std::string& value) {
+    const char* text = value.data();
+    size_t length = value.size();
+    switch (field.type) {
+    case Fix42Dictionary::Int:
+        return length > 0 && text[0] == '-' ? isDigits(text + 1, length - 1) : isDigits(text, length);
+    case Fix42Dictionary::Length:
+        return isDigits(text, length);
+    case Fix42Dictionary::DayOfMonth:
+        return isDigits(text, length) && length <= 2 && std::atoi(text) >= 1 && std::atoi(text) <= 31;
+    case Fix42Dictionary::Float:
+        return isFloat(text, length);
+    case Fix42Dictionary::Char:
+        return length == 1;
+    case Fix42Dictionary::Boolean:
+        return length == 1 && (text[0] == 'Y' || text[0] == 'N');
+    case Fix42Dictionary::UtcTimestamp:
+        return length >= 17 && isDate(text, 8) && text[8] == '-' && isTime(text + 9, length - 9);
+    case Fix42Dictionary::UtcTimeOnly:
+        return isTime(text, length);
+    case Fix42Dictionary::UtcDate:
+    case Fix42Dictionary::LocalMktDate:
+        return isDate(text, length);
+    case Fix42Dictionary::MonthYear: // YYYYMM, YYYYMMDD or YYYYMMwN
+        if (length == 6) {
+            return isDigits(text, 6) && twoDigits(text + 4) >= 1 && twoDigits(text + 4) <= 12;
+        }
+        if (length == 8 && text[6] == 'w') {
+            return isDigits(text, 6) && text[7] >= '1' && text[7] <= '5';
+        }
+        return isDate(text, length);
+    case Fix42Dictionary::String:
+    case Fix42Dictionary::MultipleValueString:
+    case Fix42Dictionary::Data:
+    case Fix42Dictionary::Undefined:
+        return length > 0;
+    }
+    return false;
+}
+
+bool isEnumValue(const FieldDef& field, const char* text, size_t length) {
+    if (field.chars) {
+        return length == 1 && text[0] != '\0' && std::strchr(field.chars, text[0]) != nullptr;
+    }
+    for (uint16_t i = 0; i < field.stringCount; ++i) {
+        if (std::strlen(field.strings[i]) == length && std::memcmp(field.strings[i], text, length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool hasEnumValue(const FieldDef& field, const std::string& value) {
+    if (!field.chars && !field.strings) {
+        return true;
+    }
+    if (field.type != Fix42Dictionary::MultipleValueString) {
+        return isEnumValue(field, value.data(), value.size());
+    }
+    // Space-separated, each one of the values
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t end = value.find(' ', start);
+        if (end == std::string::npos) {
+            end = value.size();
+        }
+        if (!isEnumValue(field, value.data() + start, end - start)) {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+} // namespace
+
+void FixValidator::validate(const FIX::Message& message) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat,
+                                                               FIX::IncorrectTagValue, FIX::UnsupportedMessageType) {
+    const std::string& msgType = message.getHeader().getField(35);
+    const Fix42Dictionary::MessageDef* definition = Fix42Dictionary::findMessage(msgType.data(), msgType.size());
+    if (!definition) {
+        throw FIX::UnsupportedMessageType();
+    }
+
+    for (FIX::FieldMap::const_iterator it = message.begin(); it != message.end(); ++it) {
+        int tag = it->getTag();
+        if (!definition->carries(tag)) {
+            throw FIX::IncorrectTagValue(tag); // Also every tag the dictionary does not define
+        }
+        const FieldDef& field = Fix42Dictionary::kFields[tag];
+        const std::string& value = it->getString();
+        if (!hasFormat(field, value)) {
+            throw FIX::IncorrectDataFormat(tag, value);
+        }
+        if (!hasEnumValue(field, value)) {
+            throw FIX::IncorrectTagValue(tag);
+        }
+    }
+
+    for (uint16_t i = 0; i < definition->requiredCount; ++i) {
+        if (!message.isSetField(definition->required[i])) {
+            throw FIX::FieldNotFound(definition->required[i]);
+        }
+    }
+}
@@ -0,0 +1,31 @@
+//
+// FixValidator.h
+// HFT
+//
+#ifndef FIX_VALIDATOR_H
+#define FIX_VALIDATOR_H
+
+#include <quickfix/Message.h>
+#include <quickfix/Exceptions.h>
+
+// Application-message validation from tables compiled out of FIX42.xml at build time
+// (fixdict_gen -> Fix42Dictionary.h), for sessions that run with UseDataDictionary=N
+// so QuickFIX neither loads the XML nor validates through its generic dictionary.
+//
+// Only the message types the build compiled in are accepted (CMakeLists.txt,
+// FIX_VALIDATED_MSGTYPES); the rest are UnsupportedMessageType. For those it checks
+// that every body tag is defined and allowed in the message, that values parse as
+// the field's type and are among its enum values, and that required fields are set.
+// Failures are thrown as the exceptions fromApp may throw, so QuickFIX answers them
+// with a session Reject:
+//   required field missing             FieldNotFound(tag)
+//   value not of the field's type      IncorrectDataFormat(tag)
+//   bad enum value, undefined tag or
+//   tag not allowed in the message     IncorrectTagValue(tag)
+class FixValidator {
+public:
+    static void validate(const FIX::Message& message) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat,
+                                                            FIX::IncorrectTagValue, FIX::UnsupportedMessageType);
+};
+
+#endif // FIX_VALIDATOR_H
@@ -0,0 +1,126 @@
+//
+// IdGenerator.h
+// HFT
+//
+#ifndef ID_GENERATOR_H
+#define ID_GENERATOR_H
+
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+
+// Lock-free, allocation-free ID generation for orders, executions and quotes.
+//
+// IDs look like PREFIX-EPOCH-SHARD-SEQ, e.g. "MM-EXEC-LKF3Q9Z2X1-0-42":
+//  - EPOCH is the session start in microseconds (base 36), so a restart never
+//    reissues an ID from a previous run
+//  - SHARD is a per-thread number handed out on first use, so worker threads
+//    never collide and never share a counter cache line
+//  - SEQ is a monotonic per-thread counter
+class IdGenerator {
+public:
+    static const size_t kMaxLength = 64;
+    static const unsigned kMaxShards = 256;
+
+    // Fixed buffer result; convert with str() only at the FIX boundary
+    struct Id {
+        char data[kMaxLength];
+        size_t length;
+
+        std::string str() const { return std::string(data, length); }
+    };
+
+    explicit IdGenerator(const char* prefix) {
+        reseed(prefix, sessionEpoch());
+    }
+
+    // Session epoch shared by every generator in this process
+    static uint64_t sessionEpoch() {
+        static const uint64_t epoch = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return epoch;
+    }
+
+    uint64_t epoch() const { return m_epoch; }
+
+    // Moves this generator past a previous session's epoch (e.g. restored from a
+    // snapshot after the wall clock stepped backwards). Not thread-safe: call before use.
+    void ensureEpochAfter(uint64_t previousEpoch) {
+        if (previousEpoch >= m_epoch) {
+            std::string prefix(m_prefix, m_prefixBaseLength);
+            reseed(prefix.c_str(), previousEpoch + 1);
+        }
+    }
+
+    Id next() {
+        Id id;
+        id.length = format(id.data);
+        return id;
+    }
+
+    // Writes the next ID into out (at least kMaxLength bytes), returns its length
+    size_t format(char* out) {
+        unsigned shard = currentShard();
+        Slot& slot = m_slots[shard < kMaxShards ? shard : kMaxShards - 1];
+        uint64_t sequence = slot.counter.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        std::memcpy(out, m_prefix, m_prefixLength);
+        size_t length = m_prefixLength;
+        length += appendDigits(out + length, shard, 10);
+        out[length++] = '-';
+        length += appendDigits(out + length, sequence, 10);
+        return length;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> counter;
+        char padding[64 - sizeof(std::atomic<uint64_t>)]; // One cache line per shard
+
+        Slot() : counter(0) {}
+    };
+
+    static unsigned currentShard() {
+        static std::atomic<unsigned> nextShard(0);
+        thread_local unsigned shard = nextShard.fetch_add(1);
+        return shard;
+    }
+
+    static size_t appendDigits(char* out, uint64_t value, unsigned base) {
+        static const char kDigits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        char reversed[24];
+        size_t count = 0;
+        do {
+            reversed[count++] = kDigits[value % base];
+            value /= base;
+        } while (value != 0);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = reversed[count - 1 - i];
+        }
+        return count;
+    }
+
+    void reseed(const char* prefix, uint64_t epoch) {
+        m_epoch = epoch;
+        m_prefixBaseLength = std::strlen(prefix);
+        if (m_prefixBaseLength > 16) {
+            m_prefixBaseLength = 16;
+        }
+        std::memcpy(m_prefix, prefix, m_prefixBaseLength);
+        size_t length = m_prefixBaseLength;
+        m_prefix[length++] = '-';
+        length += appendDigits(m_prefix + length, epoch, 36);
+        m_prefix[length++] = '-';
+        m_prefixLength = length;
+    }
+
+    char m_prefix[32]; // "PREFIX-EPOCH-", formatted once
+    size_t m_prefixLength;
+    size_t m_prefixBaseLength;
+    uint64_t m_epoch;
+    Slot m_slots[kMaxShards];
+};
+
+#endif // ID_GENERATOR_H
@@ -0,0 +1,338 @@
+//
+// MarketAnalytics.h
+// HFT
+//
+#ifndef MARKET_ANALYTICS_H
+#define MARKET_ANALYTICS_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+
+// Per-symbol trade and quote analytics, updated in O(1) per event:
+//  - top of book with sizes, mid, microprice and size imbalance
+//  - last trade, cumulative volume and VWAP since start
+//  - OHLCV bars by time (aligned to barIntervalNs) and by volume (volumeBarSize each)
+//
+// State is kept as structure-of-arrays columns over a fixed symbol universe, so a
+// consumer scanning one statistic for every symbol walks contiguous memory.
+//
+// Writers (the feed thread for quotes, order and FIX threads for fills) serialise
+// per symbol through that symbol's sequence word. Readers never block: single
+// statistics are one atomic load, and read() copies a consistent View of a symbol,
+// retrying if a write overlapped it.
+class MarketAnalytics {
+public:
+    struct Params {
+        uint64_t barIntervalNs; // Time bars; 0 disables them
+        double volumeBarSize;   // A volume bar closes once it holds at least this much; 0 disables them
+
+        Params() : barIntervalNs(1000000000ULL), volumeBarSize(10000.0) {}
+    };
+
+    // A bar with no trades yet carries the previous close as its open, high, low and close
+    struct Bar {
+        uint64_t startNs; // Bucket start (time bars) or first trade (volume bars)
+        uint64_t trades;
+        double open;
+        double high;
+        double low;
+        double close;
+        double volume;
+        double notional;
+
+        Bar() : startNs(0), trades(0), open(0.0), high(0.0), low(0.0), close(0.0), volume(0.0), notional(0.0) {}
+        double vwap() const { return volume > 0.0 ? notional / volume : 0.0; }
+    };
+
+    // Consistent copy of one symbol's state
+    struct View {
+        double bid;
+        double ask;
+        double bidSize;
+        double askSize;
+        double mid;
+        double microprice; // Size-weighted: leans towards the side with less size; mid without sizes
+        double imbalance;  // (bidSize - askSize) / (bidSize + askSize), in [-1, 1]
+        double lastPrice;
+        double lastSize;
+        double volume;     // Since start
+        double notional;
+        uint64_t trades;
+        uint64_t updatedNs;
+        Bar timeBar;       // Being built
+        Bar lastTimeBar;   // Most recently completed
+        Bar volumeBar;
+        Bar lastVolumeBar;
+
+        double vwap() const { return volume > 0.0 ? notional / volume : 0.0; }
+    };
+
+    explicit MarketAnalytics(const std::vector<std::string>& symbols, const Params& params = Params())
+        : m_symbols(symbols), m_params(params), m_sequence(new std::atomic<uint32_t>[symbols.size()]),
+          m_bid(symbols.size()), m_ask(symbols.size()), m_bidSize(symbols.size()), m_askSize(symbols.size()),
+          m_mid(symbols.size()), m_microprice(symbols.size()), m_imbalance(symbols.size()),
+          m_lastPrice(symbols.size()), m_lastSize(symbols.size()), m_volume(symbols.size()),
+          m_notional(symbols.size()), m_trades(symbols.size()), m_updatedNs(symbols.size()),
+          m_timeBars(symbols.size() * 2), m_volumeBars(symbols.size() * 2)
+    {
+        for (size_t i = 0; i < m_symbols.size(); ++i) {
+            m_indexBySymbol[m_symbols[i]] = i;
+            m_sequence[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    size_t size() const { return m_symbols.size(); }
+    const std::string& symbolAt(size_t index) const { return m_symbols[index]; }
+    const Params& params() const { return m_params; }
+
+    // Returns -1 for symbols outside the universe
+    long indexOf(const std::string& symbol) const {
+        auto it = m_indexBySymbol.find(symbol);
+        return it != m_indexBySymbol.end() ? static_cast<long>(it->second) : -1;
+    }
+
+    // Event time for callers without their own; bars align to the wall clock
+    static uint64_t wallClockNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // --- Writers ---
+
+    // New top of book. Sizes of 0 mean unknown: microprice falls back to mid.
+    void onQuote(size_t index, double bid, double ask, double bidSize, double askSize, uint64_t timeNs) {
+        double mid = bid > 0.0 && ask > 0.0 ? (bid + ask) / 2.0 : 0.0;
+        double microprice = mid;
+        double imbalance = 0.0;
+        double totalSize = bidSize + askSize;
+        if (mid > 0.0 && bidSize > 0.0 && askSize > 0.0) {
+            microprice = (bid * askSize + ask * bidSize) / totalSize;
+            imbalance = (bidSize - askSize) / totalSize;
+        }
+
+        beginWrite(index);
+        store(m_bid[index], bid);
+        store(m_ask[index], ask);
+        store(m_bidSize[index], bidSize);
+        store(m_askSize[index], askSize);
+        store(m_mid[index], mid);
+        store(m_microprice[index], microprice);
+        store(m_imbalance[index], imbalance);
+        rollTimeBar(index, timeNs); // Bars close on time even while nothing trades
+        store(m_updatedNs[index], timeNs);
+        endWrite(index);
+    }
+
+    // A trade print or one of our fills; size is unsigned volume
+    void onTrade(size_t index, double price, double size, uint64_t timeNs) {
+        if (!(price > 0.0) || !(size > 0.0)) {
+            return;
+        }
+        beginWrite(index);
+        store(m_lastPrice[index], price);
+        store(m_lastSize[index], size);
+        store(m_volume[index], m_volume[index] + size);
+        store(m_notional[index], m_notional[index] + price * size);
+        store(m_trades[index], m_trades[index] + 1);
+
+        if (m_params.barIntervalNs > 0) {
+            rollTimeBar(index, timeNs);
+            Bar bar = m_timeBars[index * 2];
+            addTrade(bar, price, size);
+            storeBar(m_timeBars[index * 2], bar);
+        }
+        if (m_params.volumeBarSize > 0.0) {
+            Bar bar = m_volumeBars[index * 2];
+            if (bar.trades == 0) {
+                bar.startNs = timeNs;
+            }
+            addTrade(bar, price, size);
+            if (bar.volume >= m_params.volumeBarSize) {
+                // The trade that fills the bar stays whole in it; the next bar starts empty
+                storeBar(m_volumeBars[index * 2 + 1], bar);
+                Bar next;
+                next.open = next.high = next.low = next.close = bar.close;
+                bar = next;
+            }
+            storeBar(m_volumeBars[index * 2], bar);
+        }
+        store(m_updatedNs[index], timeNs);
+        endWrite(index);
+    }
+
+    // --- Lock-free readers ---
+
+    double mid(size_t index) const { return load(m_mid[index]); }
+    double microprice(size_t index) const { return load(m_microprice[index]); }
+    double imbalance(size_t index) const { return load(m_imbalance[index]); }
+    double lastPrice(size_t index) const { return load(m_lastPrice[index]); }
+
+    double vwap(size_t index) const {
+        double volume, notional;
+        uint32_t before;
+        do {
+            before = readBegin(index);
+            volume = load(m_volume[index]);
+            notional = load(m_notional[index]);
+        } while (!readValid(index, before));
+        return volume > 0.0 ? notional / volume : 0.0;
+    }
+
+    void read(size_t index, View& view) const {
+        uint32_t before;
+        do {
+            before = readBegin(index);
+            view.bid = load(m_bid[index]);
+            view.ask = load(m_ask[index]);
+            view.bidSize = load(m_bidSize[index]);
+            view.askSize = load(m_askSize[index]);
+            view.mid = load(m_mid[index]);
+            view.microprice = load(m_microprice[index]);
+            view.imbalance = load(m_imbalance[index]);
+            view.lastPrice = load(m_lastPrice[index]);
+            view.lastSize = load(m_lastSize[index]);
+            view.volume = load(m_volume[index]);
+            view.notional = load(m_notional[index]);
+            view.trades = load(m_trades[index]);
+            view.updatedNs = load(m_updatedNs[index]);
+            view.timeBar = loadBar(m_timeBars[index * 2]);
+            view.lastTimeBar = loadBar(m_timeBars[index * 2 + 1]);
+            view.volumeBar = loadBar(m_volumeBars[index * 2]);
+            view.lastVolumeBar = loadBar(m_volumeBars[index * 2 + 1]);
+        } while (!readValid(index, before));
+    }
+
+private:
+    static const size_t kBarWords = sizeof(Bar) / sizeof(uint64_t);
+    static_assert(sizeof(Bar) % sizeof(uint64_t) == 0, "Bar must be a whole number of words");
+
+    // Writers take a symbol by moving its sequence from even to odd
+    void beginWrite(size_t index) {
+        std::atomic<uint32_t>& sequence = m_sequence[index];
+        for (;;) {
+            uint32_t seq = sequence.load(std::memory_order_relaxed);
+            if ((seq & 1) == 0 &&
+                sequence.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void endWrite(size_t index) {
+        m_sequence[index].fetch_add(1, std::memory_order_release);
+    }
+
+    uint32_t readBegin(size_t index) const {
+        for (;;) {
+            uint32_t seq = m_sequence[index].load(std::memory_order_acquire);
+            if ((seq & 1) == 0) {
+                return seq;
+            }
+        }
+    }
+
+    bool readValid(size_t index, uint32_t before) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return m_sequence[index].load(std::memory_order_relaxed) == before;
+    }
+
+    // Columns are plain memory accessed with relaxed atomics, as in SeqLock (OrderBook.h)
+    template <class T>
+    static T load(const T& from) {
+        T value;
+        __atomic_load(&from, &value, __ATOMIC_RELAXED);
+        return value;
+    }
+
+    template <class T>
+    static void store(T& to, T value) {
+        __atomic_store(&to, &value, __ATOMIC_RELAXED);
+    }
+
+    static Bar loadBar(const Bar& from) {
+        uint64_t words[kBarWords];
+        const uint64_t* source = reinterpret_cast<const uint64_t*>(&from);
+        for (size_t i = 0; i < kBarWords; ++i) {
+            words[i] = __atomic_load_n(source + i, __ATOMIC_RELAXED);
+        }
+        Bar bar;
+        std::memcpy(&bar, words, sizeof(bar));
+        return bar;
+    }
+
+    static void storeBar(Bar& to, const Bar& bar) {
+        uint64_t words[kBarWords];
+        std::memcpy(words, &bar, sizeof(bar));
+        uint64_t* target = reinterpret_cast<uint64_t*>(&to);
+        for (size_t i = 0; i < kBarWords; ++i) {
+            __atomic_store_n(target + i, words[i], __ATOMIC_RELAXED);
+        }
+    }
+
+    static void addTrade(Bar& bar, double price, double size) {
+        if (bar.trades == 0) {
+            bar.open = bar.high = bar.low = price;
+        } else if (price > bar.high) {
+            bar.high = price;
+        } else if (price < bar.low) {
+            bar.low = price;
+        }
+        bar.close = price;
+        bar.volume += size;
+        bar.notional += price * size;
+        ++bar.trades;
+    }
+
+    // Closes the building time bar once timeNs is past its bucket; caller is the writer
+    void rollTimeBar(size_t index, uint64_t timeNs) {
+        if (m_params.barIntervalNs == 0) {
+            return;
+        }
+        uint64_t bucket = timeNs - timeNs % m_params.barIntervalNs;
+        const Bar& building = m_timeBars[index * 2];
+        if (building.startNs == bucket) {
+            return;
+        }
+        if (building.startNs != 0 && bucket > building.startNs) {
+            // Empty buckets in between are skipped, not recorded
+            storeBar(m_timeBars[index * 2 + 1], building);
+        } else if (building.startNs != 0) {
+            return; // Event older than the building bar: it stays where it is
+        }
+        Bar next;
+        next.startNs = bucket;
+        next.open = next.high = next.low = next.close = building.close;
+        storeBar(m_timeBars[index * 2], next);
+    }
+
+    std::vector<std::string> m_symbols;
+    std::unordered_map<std::string, size_t> m_indexBySymbol;
+    Params m_params;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_sequence;
+
+    // Columns, one entry per symbol (bars: building and last completed per symbol)
+    std::vector<double> m_bid;
+    std::vector<double> m_ask;
+    std::vector<double> m_bidSize;
+    std::vector<double> m_askSize;
+    std::vector<double> m_mid;
+    std::vector<double> m_microprice;
+    std::vector<double> m_imbalance;
+    std::vector<double> m_lastPrice;
+    std::vector<double> m_lastSize;
+    std::vector<double> m_volume;
+    std::vector<double> m_notional;
+    std::vector<uint64_t> m_trades;
+    std::vector<uint64_t> m_updatedNs;
+    std::vector<Bar> m_timeBars;
+    std::vector<Bar> m_volumeBars;
+};
+
+#endif // MARKET_ANALYTICS_H
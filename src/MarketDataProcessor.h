@@ -8,23 +8,81 @@
 #define MARKET_DATA_PROCESSOR_H
 
 #include "OrderBook.h"
+#include "ConflationBuffer.h"
+#include "MarketAnalytics.h"
+#include "TickStore.h"
+#include "Metrics.h"
 #include <string>
+#include <vector>
+#include <functional>
 #include <iostream>
 
-class MarketDataProcessor {
+// Fans each incoming quote out to its consumers. Every consumer picks its own delivery:
+//  - full-rate listeners (the OrderBook used for matching) see every tick in order,
+//    with its sizes
+//  - analytics see every tick with its sizes, before any conflated consumer does
+//  - tick stores get a copy of every tick for the research archive
+//  - conflated consumers (quoting) only see the latest state per symbol when they drain
+// Book is the concrete book type, so the per-tick book update is a direct call.
+template <class Book>
+class BasicMarketDataProcessor {
 public:
-    MarketDataProcessor(OrderBook* orderBook) : m_orderBook(orderBook) {}
+    typedef std::function<void(const std::string& symbol, double bid, double ask, double bidSize, double askSize)>
+        Listener;
+
+    // orderBook must outlive the processor (never null)
+    explicit BasicMarketDataProcessor(Book* orderBook) : m_orderBook(orderBook) {}
+
+    // Registration is not thread-safe: wire consumers up before the feed starts
+    void addListener(const Listener& listener) { m_listeners.push_back(listener); }
+    void addConflatedConsumer(ConflationBuffer* buffer) { m_conflated.push_back(buffer); }
+    void addAnalytics(MarketAnalytics* analytics) { m_analytics.push_back(analytics); }
+    void addTickStore(TickStoreWriter* store) { m_tickStores.push_back(store); }
+
+    // Entry point for decoded quotes from the feed; sizes of 0 mean the feed has none
+    void onQuote(const std::string& symbol, double bid, double ask, double bidSize = 0.0, double askSize = 0.0) {
+        Metrics::increment(Metrics::TicksIn);
+        m_orderBook->updateMarketData(symbol, bid, ask);
+        for (const Listener& listener : m_listeners) {
+            listener(symbol, bid, ask, bidSize, askSize);
+        }
+        // Ahead of the conflated consumers, so a quoting cycle never sees a price its analytics lack
+        if (!m_analytics.empty() || !m_tickStores.empty()) {
+            uint64_t now = MarketAnalytics::wallClockNs();
+            for (MarketAnalytics* analytics : m_analytics) {
+                long index = analytics->indexOf(symbol);
+                if (index >= 0) {
+                    analytics->onQuote(static_cast<size_t>(index), bid, ask, bidSize, askSize, now);
+                }
+            }
+            for (TickStoreWriter* store : m_tickStores) {
+                store->recordQuote(symbol, bid, ask, bidSize, askSize, static_cast<int64_t>(now));
+            }
+        }
+        for (ConflationBuffer* buffer : m_conflated) {
+            long index = buffer->indexOf(symbol);
+            if (index >= 0) {
+                buffer->publish(static_cast<size_t>(index), bid, ask);
+            }
+        }
+    }
 
     // In a real system, this would receive raw market data messages
     // and parse/process them to update the OrderBook.
-    // For this mock, the MockMarketDataSource directly calls OrderBook.
+    // For this mock, the MockMarketDataSource calls onQuote() with decoded prices.
     void processMarketData(const std::string& rawData) {
         // Example: parse rawData and call m_orderBook->updateMarketData(...)
         // std::cout << "MarketDataProcessor: Processing raw data (mock): " << rawData << std::endl;
     }
 
 private:
-    OrderBook* m_orderBook;
+    Book* m_orderBook;
+    std::vector<Listener> m_listeners;
+    std::vector<ConflationBuffer*> m_conflated;
+    std::vector<MarketAnalytics*> m_analytics;
+    std::vector<TickStoreWriter*> m_tickStores;
 };
 
+typedef BasicMarketDataProcessor<OrderBook> MarketDataProcessor;
+
 #endif // MARKET_DATA_PROCESSOR_H
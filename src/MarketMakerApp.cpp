@@ -1,6 +1,10 @@
 #include "MarketMakerApp.h"
 #include "OrderBook.h"
 #include "StrategyEngine.h"
+#include "Metrics.h"
+#include "ThreadTopology.h"
+#include "FixValidator.h"
+#include "FixTransport.h" // For SendBatch
 #include <quickfix/Session.h>
 #include <quickfix/FieldConvertors.h>
 // Ensure these are included if you use them directly, though often
@@ -10,7 +14,9 @@
 
 
 MarketMakerApplication::MarketMakerApplication(OrderBook* orderBook, StrategyEngine* strategyEngine)
-    : m_orderBook(orderBook), m_strategyEngine(strategyEngine)
+    : m_orderBook(orderBook), m_strategyEngine(strategyEngine),
+      m_upstreamLoggedOn(false), m_orderBatcher(nullptr),
+      m_rejectOrderIds("MM-REJECT"), m_rejectExecIds("MM-REJECT-EXEC")
 {}
 
 void MarketMakerApplication::onCreate(const FIX::SessionID& sessionID) {
@@ -19,6 +25,14 @@ void MarketMakerApplication::onCreate(const FIX::SessionID& sessionID) {
 
 void MarketMakerApplication::onLogon(const FIX::SessionID& sessionID) {
     std::cout << "MarketMakerApp onLogon: " << sessionID << std::endl;
+    if (isUpstream(sessionID)) {
+        m_upstreamLoggedOn = true;
+        if (m_strategyEngine) {
+            m_strategyEngine->onUpstreamSessionChanged(true);
+            m_strategyEngine->startQuoting(); // Quotes can rest on the exchange even with no client
+        }
+        return;
+    }
     m_clientSessionID = sessionID; // Store client session ID
     if (m_strategyEngine) {
         m_strategyEngine->startQuoting(); // Start market making logic when client connects
@@ -27,8 +41,18 @@ void MarketMakerApplication::onLogon(const FIX::SessionID& sessionID) {
 
 void MarketMakerApplication::onLogout(const FIX::SessionID& sessionID) {
     std::cout << "MarketMakerApp onLogout: " << sessionID << std::endl;
-    if (m_strategyEngine) {
-        m_strategyEngine->stopQuoting(); // Stop market making when client disconnects
+    if (isUpstream(sessionID)) {
+        m_upstreamLoggedOn = false;
+        if (m_strategyEngine) {
+            m_strategyEngine->onUpstreamSessionChanged(false);
+            if (m_clientSessionID == FIX::SessionID()) {
+                m_strategyEngine->pauseQuoting(); // Never join here: see StrategyEngine::pauseQuoting
+            }
+        }
+        return;
+    }
+    if (m_strategyEngine && !m_upstreamLoggedOn) {
+        m_strategyEngine->pauseQuoting(); // Stop market making when client disconnects
     }
     m_clientSessionID = FIX::SessionID(); // Clear session ID
 }
@@ -44,22 +68,35 @@ void MarketMakerApplication::toApp(FIX::Message& message, const FIX::SessionID&
 }
 
 void MarketMakerApplication::fromAdmin(const FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::RejectLogon) {
+    // QuickFIX owns its socket threads; the first message received (the logon) places them
+    ThreadTopology::applyOnce(ThreadTopology::Fix);
     // std::cout << "MarketMakerApp fromAdmin: " << message << std::endl;
 }
 
 void MarketMakerApplication::fromApp(const FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::UnsupportedMessageType) {
     // This is the entry point for all incoming application messages from the client
+    ThreadTopology::applyOnce(ThreadTopology::Fix);
+    FixValidator::validate(message); // Sessions run with UseDataDictionary=N; see FixValidator.h
     crack(message, sessionID); // Dispatches to the appropriate onMessage handler
 }
 
 // --- Specific Client Order Handlers ---
 
 void MarketMakerApplication::onMessage(const FIX42::NewOrderSingle& message, const FIX::SessionID& sessionID) {
+    Metrics::increment(Metrics::ClientOrders);
+    if (m_orderBatcher) {
+        // Matched on the batch thread, which records OrderHandling latency from here
+        m_orderBatcher->submit(message, sessionID);
+        return;
+    }
+    Metrics::ScopedLatency latency(Metrics::OrderHandling);
+
     // MarketMakerApp receives client order and forwards it to StrategyEngine
     if (m_strategyEngine) {
         m_strategyEngine->onNewOrderSingle(message, sessionID);
     } else {
         std::cerr << "MarketMakerApp: No StrategyEngine hooked up to handle NewOrderSingle. Rejecting order." << std::endl;
+        Metrics::reject(Metrics::RejectNoStrategy);
 
         // Declare local QuickFIX field variables to hold the extracted values
         FIX::ClOrdID clOrdID;
@@ -75,8 +112,8 @@ void MarketMakerApplication::onMessage(const FIX42::NewOrderSingle& message, con
 
         // *** FIX: Added FIX::ExecTransType_NEW to the constructor call ***
         FIX42::ExecutionReport rejectReport(
-            FIX::OrderID("MM-REJECT-" + clOrdID.getValue()),
-            FIX::ExecID("MM-REJECT-EXEC-" + clOrdID.getValue()),
+            FIX::OrderID(m_rejectOrderIds.next().str()),
+            FIX::ExecID(m_rejectExecIds.next().str()),
             FIX::ExecTransType_NEW, // *** FIX: Missing argument for constructor ***
             FIX::ExecType_REJECTED,
             FIX::OrdStatus_REJECTED,
@@ -103,12 +140,45 @@ void MarketMakerApplication::onMessage(const FIX42::NewOrderSingle& message, con
     }
 }
 
+// --- Upstream Exchange Handlers (reports on our own quotes) ---
+
+void MarketMakerApplication::onMessage(const FIX42::ExecutionReport& message, const FIX::SessionID& sessionID) {
+    if (!isUpstream(sessionID)) {
+        throw FIX::UnsupportedMessageType(); // Clients don't send us ExecutionReports
+    }
+    if (m_strategyEngine) {
+        m_strategyEngine->onOurOwnExecutionReport(message);
+    }
+}
+
+void MarketMakerApplication::onMessage(const FIX42::OrderCancelReject& message, const FIX::SessionID& sessionID) {
+    if (!isUpstream(sessionID)) {
+        throw FIX::UnsupportedMessageType();
+    }
+    if (m_strategyEngine) {
+        m_strategyEngine->onOurOwnCancelReject(message);
+    }
+}
+
 // --- Public methods for StrategyEngine to send messages through MarketMakerApp ---
 
+bool MarketMakerApplication::sendToUpstream(FIX::Message& message) {
+    if (!m_upstreamLoggedOn) {
+        return false;
+    }
+    try {
+        return FIX::Session::sendToTarget(message, m_upstreamSessionID);
+    } catch (const FIX::SessionNotFound& e) {
+        std::cerr << "MarketMakerApp Error sending to exchange: Session Not Found - " << e.what() << std::endl;
+    }
+    return false;
+}
+
 // *** FIX: Changed the message parameter from const FIX42::ExecutionReport& to FIX42::ExecutionReport& ***
 void MarketMakerApplication::sendExecutionReportToClient(FIX42::ExecutionReport& message, const FIX::SessionID& clientSessionID) {
     try {
         FIX::Session::sendToTarget(message, clientSessionID);
+        Metrics::increment(Metrics::ExecReportsSent);
         // It's good practice to get the ClOrdID after sending, in case QuickFIX
         // internally modifies the message and adds it if it was missing or changes it.
         // However, in this case, we populate it ourselves.
@@ -125,6 +195,42 @@ void MarketMakerApplication::sendExecutionReportToClient(FIX42::ExecutionReport&
     }
 }
 
+void MarketMakerApplication::sendExecutionReports(ReportBatch& reports) {
+    // Each session is looked up once per run of its reports, and on transports that
+    // can batch (shm) its reports reach the peer as one write when the batch flushes
+    FixTransport::SendBatch batch;
+    size_t sent = 0;
+    size_t i = 0;
+    while (i < reports.size()) {
+        const FIX::SessionID& sessionID = reports[i].second;
+        size_t end = i + 1;
+        while (end < reports.size() && reports[end].second == sessionID) {
+            ++end;
+        }
+
+        FIX::Session* session = FIX::Session::lookupSession(sessionID);
+        if (!session) {
+            std::cerr << "MarketMakerApp Error sending ER batch to client: Session Not Found - " << sessionID << std::endl;
+        } else {
+            batch.add(sessionID);
+        }
+        for (; i < end && session; ++i) {
+            try {
+                if (session->send(reports[i].first)) {
+                    Metrics::increment(Metrics::ExecReportsSent);
+                    ++sent;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "MarketMakerApp Error sending ER to client: " << e.what() << std::endl;
+            }
+        }
+        i = end;
+    }
+    batch.flush();
+    std::cout << "MarketMakerApp: Sent " << sent << " of " << reports.size()
+              << " ExecutionReports (batched) to clients." << std::endl;
+}
+
 FIX::SessionID MarketMakerApplication::getClientSessionID() const {
     return m_clientSessionID;
 }
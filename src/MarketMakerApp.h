@@ -11,9 +11,15 @@
 #include <string>
 #include <iostream>
 #include <map>
+#include <atomic>
+#include <vector>
+#include <utility>
 
-class OrderBook; // Forward declaration
-class StrategyEngine; // Forward declaration for new StrategyEngine
+#include "IdGenerator.h"
+#include "OrderBookFwd.h"      // OrderBook is a typedef of a template; see OrderBook.h
+#include "StrategyEngineFwd.h" // Likewise StrategyEngine
+
+class OrderBatcher;
 
 class MarketMakerApplication : public FIX::Application, public FIX::MessageCracker
 {
@@ -32,19 +38,50 @@ public:
     // MessageCracker overloads for incoming client orders
     void onMessage(const FIX42::NewOrderSingle& message, const FIX::SessionID& sessionID) override;
 
+    // MessageCracker overloads for reports on our own quotes (upstream session only)
+    void onMessage(const FIX42::ExecutionReport& message, const FIX::SessionID& sessionID) override;
+    void onMessage(const FIX42::OrderCancelReject& message, const FIX::SessionID& sessionID) override;
+
     // Public method for StrategyEngine to send Execution Reports to clients
     // FIX: Changed parameter from const FIX42::ExecutionReport& to FIX42::ExecutionReport&
     void sendExecutionReportToClient(FIX42::ExecutionReport& message, const FIX::SessionID& clientSessionID);
 
+    // Reports for a batch of client orders, each with the session it goes back to.
+    // Sent in order; consecutive reports for the same session share one session lookup.
+    typedef std::vector<std::pair<FIX42::ExecutionReport, FIX::SessionID> > ReportBatch;
+    void sendExecutionReports(ReportBatch& reports);
+
+    // Optional: client orders are queued here and matched in batches instead of on
+    // the FIX thread. Set before the acceptor starts.
+    void setOrderBatcher(OrderBatcher* batcher) { m_orderBatcher = batcher; }
+
     // Get the current client session ID (used by StrategyEngine to check if a client is connected)
     FIX::SessionID getClientSessionID() const;
 
+    // Upstream exchange session, where we are the initiator and route our own quotes.
+    // Set before the initiator starts; without it the market maker runs acceptor-only.
+    void setUpstreamSessionID(const FIX::SessionID& sessionID) { m_upstreamSessionID = sessionID; }
+    bool isUpstreamLoggedOn() const { return m_upstreamLoggedOn; }
+
+    // Sends one of our quote requests to the exchange. Returns false if it could not be sent.
+    bool sendToUpstream(FIX::Message& message);
+
 private:
     OrderBook* m_orderBook;
     StrategyEngine* m_strategyEngine; // Pointer to the StrategyEngine
 
     FIX::Mutex m_mutex;
     FIX::SessionID m_clientSessionID; // Stores the session ID of the connected client (MockTradeClient)
+    FIX::SessionID m_upstreamSessionID; // Our initiator session to the exchange (exchange_sim)
+    std::atomic<bool> m_upstreamLoggedOn;
+    OrderBatcher* m_orderBatcher;
+
+    bool isUpstream(const FIX::SessionID& sessionID) const {
+        return !m_upstreamSessionID.getTargetCompID().empty() && sessionID == m_upstreamSessionID;
+    }
+
+    IdGenerator m_rejectOrderIds;
+    IdGenerator m_rejectExecIds;
 };
 
 #endif // MARKET_MAKER_APP_H
@@ -0,0 +1,352 @@
+// src/MemoryRegion.cpp
+#include "MemoryRegion.h"
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#if defined(MAP_HUGETLB) && !defined(MAP_HUGE_SHIFT)
+#define MAP_HUGE_SHIFT 26
+#endif
+#if defined(MAP_HUGETLB) && !defined(MAP_HUGE_2MB)
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#if defined(MAP_HUGETLB) && !defined(MAP_HUGE_1GB)
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+namespace {
+
+const size_t kSmallPage = 4096;
+const size_t kHugePage = 2UL << 20;
+const size_t kGiantPage = 1UL << 30;
+const size_t kMiB = 1UL << 20;
+
+// Block sizes 16 << c; a block is aligned to its size, up to a cache line
+const unsigned kMinClassShift = 4;
+const unsigned kClassCount = 40;
+const size_t kMaxAlign = 64;
+
+struct alignas(64) FreeList {
+    std::atomic_flag lock;
+    void* head;
+};
+
+FreeList s_free[kClassCount];
+std::atomic<size_t> s_offset(0);
+std::atomic<uint64_t> s_fallbacks(0);
+
+long s_lastMinorFaults = 0;
+long s_lastMajorFaults = 0;
+
+unsigned classOf(size_t bytes) {
+    if (bytes <= (size_t(1) << kMinClassShift)) {
+        return 0;
+    }
+    return 64 - __builtin_clzll(bytes - 1) - kMinClassShift;
+}
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+size_t pageBytes(MemoryRegion::PageSize pages) {
+    switch (pages) {
+    case MemoryRegion::Huge1G:
+        return kGiantPage;
+    case MemoryRegion::Huge2M:
+    case MemoryRegion::Transparent:
+        return kHugePage;
+    default:
+        return kSmallPage;
+    }
+}
+
+void lockList(FreeList& list) {
+    while (list.lock.test_and_set(std::memory_order_acquire)) {
+    }
+}
+
+void unlockList(FreeList& list) {
+    list.lock.clear(std::memory_order_release);
+}
+
+// Maps `bytes` (already a multiple of the page size) on pages of the given size;
+// nullptr if the kernel has none to give
+char* mapPages(size_t bytes, MemoryRegion::PageSize pages) {
+    void* p = MAP_FAILED;
+    switch (pages) {
+#if defined(MAP_HUGETLB)
+    case MemoryRegion::Huge1G:
+        p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_1GB, -1, 0);
+        break;
+    case MemoryRegion::Huge2M:
+        p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+        break;
+#endif
+#if defined(MADV_HUGEPAGE)
+    case MemoryRegion::Transparent: {
+        // Over-map so the arena can start on a 2 MiB boundary, then give back the ends
+        char* raw = static_cast<char*>(::mmap(nullptr, bytes + kHugePage, PROT_READ | PROT_WRITE,
+                                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (raw == MAP_FAILED) {
+            break;
+        }
+        char* aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(raw), kHugePage));
+        if (aligned > raw) {
+            ::munmap(raw, aligned - raw);
+        }
+        ::munmap(aligned + bytes, raw + kHugePage - aligned);
+        if (::madvise(aligned, bytes, MADV_HUGEPAGE) != 0) {
+            ::munmap(aligned, bytes);
+            break;
+        }
+        p = aligned;
+        break;
+    }
+#endif
+    case MemoryRegion::Small:
+        p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        break;
+    default:
+        errno = ENOTSUP;
+        break;
+    }
+    return p == MAP_FAILED ? nullptr : static_cast<char*>(p);
+}
+
+// Grows the main malloc heap by `bytes`, faults it in and hands it back to malloc
+// without returning it to the kernel, so later allocations on any thread reuse
+// memory that is already mapped
+void reserveHeap(size_t bytes) {
+#if defined(__GLIBC__)
+    const size_t chunkBytes = 16 * kMiB;
+    mallopt(M_MMAP_THRESHOLD, 32 * kMiB);       // Large blocks from the heap too, not new mappings that fault
+    mallopt(M_TRIM_THRESHOLD, INT_MAX);         // Never shrink the heap
+
+    std::vector<void*> chunks;
+    chunks.reserve(bytes / chunkBytes + 1);
+    for (size_t reserved = 0; reserved < bytes; reserved += chunkBytes) {
+        char* chunk = static_cast<char*>(std::malloc(chunkBytes));
+        if (!chunk) {
+            break;
+        }
+#if defined(MADV_HUGEPAGE)
+        char* from = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(chunk), kHugePage));
+        if (from + kHugePage <= chunk + chunkBytes) {
+            ::madvise(from, (chunk + chunkBytes - from) / kHugePage * kHugePage, MADV_HUGEPAGE);
+        }
+#endif
+        std::memset(chunk, 0, chunkBytes);
+        chunks.push_back(chunk);
+    }
+    for (size_t i = chunks.size(); i > 0; --i) {
+        std::free(chunks[i - 1]);
+    }
+    std::cout << "MemoryRegion: Pre-faulted " << chunks.size() * chunkBytes / kMiB << " MiB of malloc heap" << std::endl;
+#else
+    (void)bytes;
+    std::cerr << "MemoryRegion: Heap reserve needs glibc malloc, skipped" << std::endl;
+#endif
+}
+
+// For blocks the arena cannot serve. Aligned like an arena block of the same size, as
+// operator new only guarantees 16 bytes; freed with std::free.
+void* heapAllocate(size_t bytes) {
+    size_t align = sizeof(void*);
+    while (align < bytes && align < kMaxAlign) {
+        align <<= 1;
+    }
+    void* p = nullptr;
+    if (::posix_memalign(&p, align, bytes ? bytes : 1) != 0) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+} // namespace
+
+char* MemoryRegion::s_base = nullptr;
+char* MemoryRegion::s_end = nullptr;
+MemoryRegion::PageSize MemoryRegion::s_pageSize = MemoryRegion::None;
+
+MemoryRegion::Config::Config() : bytes(64 * kMiB), pages(Huge2M), heapReserveBytes(64 * kMiB), mallocArenas(0), lockMemory(false) {}
+
+bool MemoryRegion::parsePageSize(const std::string& value, PageSize& pages) {
+    if (value == "1g") {
+        pages = Huge1G;
+    } else if (value == "2m") {
+        pages = Huge2M;
+    } else if (value == "thp") {
+        pages = Transparent;
+    } else if (value == "4k") {
+        pages = Small;
+    } else if (value == "off") {
+        pages = None;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* MemoryRegion::pageSizeName(PageSize pages) {
+    switch (pages) {
+    case Huge1G:
+        return "1 GiB huge pages";
+    case Huge2M:
+        return "2 MiB huge pages";
+    case Transparent:
+        return "transparent huge pages";
+    case Small:
+        return "4 KiB pages";
+    default:
+        return "no pages";
+    }
+}
+
+bool MemoryRegion::init(const Config& config) {
+    if (s_base) {
+        return true;
+    }
+    for (unsigned c = 0; c < kClassCount; ++c) {
+        s_free[c].lock.clear();
+        s_free[c].head = nullptr;
+    }
+
+    if (config.pages != None && config.bytes > 0) {
+        for (int pages = config.pages; pages <= Small; ++pages) {
+            size_t bytes = roundUp(config.bytes, pageBytes(static_cast<PageSize>(pages)));
+            char* base = mapPages(bytes, static_cast<PageSize>(pages));
+            if (!base) {
+                std::cerr << "MemoryRegion: Cannot map " << bytes / kMiB << " MiB on "
+                          << pageSizeName(static_cast<PageSize>(pages)) << ": " << std::strerror(errno) << std::endl;
+                continue;
+            }
+
+            // Touch every page now rather than on the first tick that lands on it
+            auto start = std::chrono::steady_clock::now();
+            size_t step = pages == Transparent ? kSmallPage : pageBytes(static_cast<PageSize>(pages));
+            for (size_t offset = 0; offset < bytes; offset += step) {
+                static_cast<volatile char*>(base)[offset] = 0;
+            }
+            long long elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+            s_base = base;
+            s_end = base + bytes;
+            s_pageSize = static_cast<PageSize>(pages);
+            std::cout << "MemoryRegion: " << bytes / kMiB << " MiB arena on " << pageSizeName(s_pageSize)
+                      << ", pre-faulted in " << elapsedMs << " ms" << std::endl;
+            break;
+        }
+    }
+
+    if (config.mallocArenas > 0) {
+#if defined(__GLIBC__)
+        mallopt(M_ARENA_MAX, config.mallocArenas);
+        std::cout << "MemoryRegion: Malloc limited to " << config.mallocArenas << " arena(s)" << std::endl;
+#else
+        std::cerr << "MemoryRegion: MallocArenas needs glibc malloc, ignored" << std::endl;
+#endif
+    }
+    if (config.heapReserveBytes > 0) {
+        reserveHeap(config.heapReserveBytes);
+    }
+
+    if (config.lockMemory) {
+        // MCL_FUTURE also locks (and so faults in) every later mapping: heap growth and thread stacks
+        if (::mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            std::cout << "MemoryRegion: Locked all memory" << std::endl;
+        } else {
+            std::cerr << "MemoryRegion: Cannot lock memory (raise RLIMIT_MEMLOCK or grant CAP_IPC_LOCK): "
+                      << std::strerror(errno) << std::endl;
+        }
+    }
+    return s_base != nullptr;
+}
+
+void* MemoryRegion::allocate(size_t bytes) {
+    unsigned c = classOf(bytes);
+    if (!s_base || c >= kClassCount) {
+        return heapAllocate(bytes);
+    }
+
+    FreeList& list = s_free[c];
+    lockList(list);
+    void* block = list.head;
+    if (block) {
+        list.head = *static_cast<void**>(block);
+    }
+    unlockList(list);
+    if (block) {
+        return block;
+    }
+
+    size_t blockBytes = size_t(1) << (c + kMinClassShift);
+    size_t align = blockBytes < kMaxAlign ? blockBytes : kMaxAlign;
+    size_t capacity = static_cast<size_t>(s_end - s_base);
+    size_t offset = s_offset.load(std::memory_order_relaxed);
+    for (;;) {
+        size_t start = roundUp(offset, align);
+        if (start + blockBytes > capacity) {
+            s_fallbacks.fetch_add(1, std::memory_order_relaxed);
+            return heapAllocate(bytes);
+        }
+        if (s_offset.compare_exchange_weak(offset, start + blockBytes, std::memory_order_relaxed)) {
+            return s_base + start;
+        }
+    }
+}
+
+void MemoryRegion::deallocate(void* p, size_t bytes) {
+    if (!p) {
+        return;
+    }
+    if (!contains(p)) {
+        std::free(p);
+        return;
+    }
+    FreeList& list = s_free[classOf(bytes)];
+    lockList(list);
+    *static_cast<void**>(p) = list.head;
+    list.head = p;
+    unlockList(list);
+}
+
+size_t MemoryRegion::used() {
+    return s_offset.load(std::memory_order_relaxed);
+}
+
+uint64_t MemoryRegion::heapFallbacks() {
+    return s_fallbacks.load(std::memory_order_relaxed);
+}
+
+void MemoryRegion::reportFaults(const char* phase) {
+    rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+        std::cerr << "MemoryRegion: getrusage failed: " << std::strerror(errno) << std::endl;
+        return;
+    }
+    std::cout << "MemoryRegion: Page faults " << phase << ": " << usage.ru_minflt << " minor, " << usage.ru_majflt
+              << " major (+" << usage.ru_minflt - s_lastMinorFaults << " minor, +"
+              << usage.ru_majflt - s_lastMajorFaults << " major)";
+    if (s_base) {
+        std::cout << "; arena " << used() / 1024 << " of " << capacity() / 1024 << " KiB used, "
+                  << heapFallbacks() << " heap fallbacks";
+    }
+    std::cout << std::endl;
+    s_lastMinorFaults = usage.ru_minflt;
+    s_lastMajorFaults = usage.ru_majflt;
+}
@@ -0,0 +1,123 @@
+//
+// MemoryRegion.h
+// HFT
+//
+#ifndef MEMORY_REGION_H
+#define MEMORY_REGION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One pre-faulted arena on huge pages for the hot data structures: the order book,
+// quote and order maps, timer pools and the buffers between threads. init() reserves
+// it once at startup, trying 1 GiB then 2 MiB hugetlbfs pages, then transparent huge
+// pages (madvise), then plain pages, and touches every page so nothing faults later.
+// It also pre-grows and pre-faults the malloc heap (where QuickFIX's messages and
+// everything else live) and, if asked, locks all memory with mlockall so none of it
+// is ever paged out or faulted in again.
+//
+// The pre-faulted heap is glibc's main arena, which threads share only until malloc
+// sees contention and gives a thread an arena of its own (mapped and faulted on first
+// use). mallocArenas=1 keeps every thread on the pre-faulted heap, at the price of
+// one malloc lock for the whole process, QuickFIX and the log writers included; it
+// is off by default and worth it only where heap allocation on the hot threads is
+// rare compared with the cost of a fault.
+//
+// Containers draw from the arena through RegionAllocator. Freed blocks go back to a
+// free list per power-of-two size class and are reused by the next allocation of
+// that class, so a container that churns in steady state stops touching new memory
+// after warm-up. Before init(), once the arena is full, or in tools that never call
+// init(), allocations fall through to the heap (posix_memalign, so blocks keep the
+// arena's alignment).
+class MemoryRegion {
+public:
+    enum PageSize {
+        Huge1G,      // hugetlbfs 1 GiB pages
+        Huge2M,      // hugetlbfs 2 MiB pages
+        Transparent, // madvise(MADV_HUGEPAGE); the kernel may still use 4 KiB pages
+        Small,       // 4 KiB pages
+        None         // No arena
+    };
+
+    struct Config {
+        size_t bytes;            // Arena size, rounded up to the page size
+        PageSize pages;          // Largest page size to try; falls back towards Small
+        size_t heapReserveBytes; // Malloc heap pre-grown and pre-faulted by this much; 0: leave malloc alone
+        int mallocArenas;        // glibc M_ARENA_MAX for the whole process; 0: glibc's default (see below)
+        bool lockMemory;         // mlockall(MCL_CURRENT | MCL_FUTURE); off by default, as mappings then fail past RLIMIT_MEMLOCK
+
+        Config();
+    };
+
+    // "1g", "2m", "thp", "4k" or "off"; returns false for anything else
+    static bool parsePageSize(const std::string& value, PageSize& pages);
+    static const char* pageSizeName(PageSize pages);
+
+    // Call once from main before creating the structures that use the arena and
+    // before starting threads. Returns false if nothing could be reserved; the
+    // process then runs on the ordinary heap.
+    static bool init(const Config& config);
+
+    static void* allocate(size_t bytes);
+    static void deallocate(void* p, size_t bytes);
+    static bool contains(const void* p) {
+        return static_cast<const char*>(p) >= s_base && static_cast<const char*>(p) < s_end;
+    }
+
+    static PageSize pageSize() { return s_pageSize; }
+    static size_t capacity() { return static_cast<size_t>(s_end - s_base); }
+    static size_t used();
+    static uint64_t heapFallbacks(); // Allocations the arena could not serve
+
+    // Prints the process's page-fault counts so far and the change since the last
+    // report, e.g. reportFaults("after warm-up")
+    static void reportFaults(const char* phase);
+
+private:
+    static char* s_base;
+    static char* s_end;
+    static PageSize s_pageSize;
+};
+
+// STL allocator over MemoryRegion
+template <class T>
+class RegionAllocator {
+public:
+    typedef T value_type;
+
+    RegionAllocator() noexcept {}
+    template <class U>
+    RegionAllocator(const RegionAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        static_assert(alignof(T) <= 64, "MemoryRegion blocks are aligned to at most 64 bytes");
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(MemoryRegion::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept { MemoryRegion::deallocate(p, n * sizeof(T)); }
+
+    template <class U>
+    bool operator==(const RegionAllocator<U>&) const noexcept { return true; }
+    template <class U>
+    bool operator!=(const RegionAllocator<U>&) const noexcept { return false; }
+};
+
+template <class T>
+using RegionVector = std::vector<T, RegionAllocator<T> >;
+
+template <class K, class V, class Compare = std::less<K> >
+using RegionMap = std::map<K, V, Compare, RegionAllocator<std::pair<const K, V> > >;
+
+template <class K, class V, class Hash = std::hash<K>, class Equal = std::equal_to<K> >
+using RegionUnorderedMap = std::unordered_map<K, V, Hash, Equal, RegionAllocator<std::pair<const K, V> > >;
+
+#endif // MEMORY_REGION_H
@@ -0,0 +1,407 @@
+// src/Metrics.cpp
+#include "Metrics.h"
+#include "ThreadTopology.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+namespace {
+
+// Zero-initialised static storage: valid before main() and before publish()
+Metrics::Segment s_localSegment;
+
+const char* const kCounterNames[Metrics::CounterCount] = {
+    "ticks_in", "client_orders", "client_fills", "exec_reports_sent", "quote_cycles",
+    "quote_news", "quote_replaces", "quote_cancels", "quote_acks", "quote_fills", "snapshots_taken",
+    "order_batches"
+};
+
+const char* const kRejectNames[Metrics::RejectReasonCount] = {
+    "no_market_data", "not_marketable", "invalid_order", "no_strategy", "quote_rejected_by_exchange",
+    "cancel_unknown_order", "cancel_rejected", "send_failed"
+};
+
+const char* const kGaugeNames[Metrics::GaugeCount] = {
+    "working_quotes", "conflation_depth", "ticks_conflated", "position_symbols", "last_order_batch_size",
+    "memory_region_used_bytes", "memory_region_heap_fallbacks"
+};
+
+const char* const kStageNames[Metrics::StageCount] = {
+    "order_handling", "quote_cycle", "quote_ack", "quote_fill"
+};
+
+std::string s_publishedName;
+
+// Allocation counting: each thread takes a shard on its first allocation so the
+// counters it bumps are almost never on a cache line another thread writes.
+// Trivially initialised thread_local, so reading it never allocates.
+thread_local unsigned t_allocShard = Metrics::kAllocShards;
+std::atomic<unsigned> s_nextAllocShard(0);
+
+Metrics::AllocShard& currentAllocShard(Metrics::Segment* segment) {
+    if (t_allocShard >= Metrics::kAllocShards) {
+        t_allocShard = s_nextAllocShard.fetch_add(1, std::memory_order_relaxed) % Metrics::kAllocShards;
+    }
+    return segment->allocs[t_allocShard];
+}
+
+uint64_t systemNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+Metrics::Segment* Metrics::s_segment = &s_localSegment;
+const char* Metrics::kMagic = "MMSTAT01";
+
+void Metrics::recordAllocation(size_t bytes) {
+    AllocShard& shard = currentAllocShard(s_segment);
+    shard.allocations.fetch_add(1, std::memory_order_relaxed);
+    shard.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Metrics::recordDeallocation() {
+    currentAllocShard(s_segment).deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Metrics::publish(const std::string& name) {
+    // A segment left by a crashed run would otherwise be reused with stale values
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Metrics: Cannot create shared memory " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, sizeof(Segment)) != 0) {
+        std::cerr << "Metrics: Cannot size shared memory " << name << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* mapped = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Metrics: Cannot map shared memory " << name << ": " << std::strerror(errno) << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // Single-threaded at this point, so a plain copy carries the early counts over
+    Segment* segment = static_cast<Segment*>(mapped);
+    std::memcpy(static_cast<void*>(segment), static_cast<const void*>(s_segment), sizeof(Segment));
+    segment->version = kVersion;
+    segment->pid = static_cast<uint32_t>(getpid());
+    segment->startedAtNs = systemNowNs();
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(segment->magic, kMagic, sizeof(segment->magic)); // Readers accept it from here on
+    s_segment = segment;
+    s_publishedName = name;
+    std::cout << "Metrics: Published to shared memory " << name << std::endl;
+    return true;
+}
+
+void Metrics::unpublish() {
+    if (!s_publishedName.empty()) {
+        shm_unlink(s_publishedName.c_str());
+        s_publishedName.clear();
+    }
+}
+
+const Metrics::Segment* Metrics::attach(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Segment)) {
+        close(fd);
+        return nullptr;
+    }
+    void* mapped = mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+    const Segment* segment = static_cast<const Segment*>(mapped);
+    if (std::memcmp(segment->magic, kMagic, sizeof(segment->magic)) != 0 || segment->version != kVersion) {
+        munmap(mapped, sizeof(Segment));
+        return nullptr;
+    }
+    return segment;
+}
+
+const char* Metrics::counterName(unsigned counter) { return counter < CounterCount ? kCounterNames[counter] : "?"; }
+const char* Metrics::rejectName(unsigned reason) { return reason < RejectReasonCount ? kRejectNames[reason] : "?"; }
+const char* Metrics::gaugeName(unsigned gauge) { return gauge < GaugeCount ? kGaugeNames[gauge] : "?"; }
+const char* Metrics::stageName(unsigned stage) { return stage < StageCount ? kStageNames[stage] : "?"; }
+
+uint64_t Metrics::allocations(const Segment& segment) {
+    uint64_t total = 0;
+    for (unsigned i = 0; i < kAllocShards; ++i) {
+        total += segment.allocs[i].allocations.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Metrics::deallocations(const Segment& segment) {
+    uint64_t total = 0;
+    for (unsigned i = 0; i < kAllocShards; ++i) {
+        total += segment.allocs[i].deallocations.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Metrics::allocatedBytes(const Segment& segment) {
+    uint64_t total = 0;
+    for (unsigned i = 0; i < kAllocShards; ++i) {
+        total += segment.allocs[i].bytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Metrics::percentile(const Histogram& histogram, double q) {
+    // Buckets are read one by one while writers keep adding, so total them first
+    uint64_t counts[kBuckets];
+    uint64_t total = 0;
+    for (unsigned i = 0; i < kBuckets; ++i) {
+        counts[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * total + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < kBuckets; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(kBuckets - 1);
+}
+
+std::string Metrics::render(const Segment& segment) {
+    std::ostringstream out;
+    uint64_t now = systemNowNs();
+    out << "mm_uptime_seconds " << (now > segment.startedAtNs && segment.startedAtNs ? (now - segment.startedAtNs) / 1000000000ULL : 0) << "\n";
+    for (unsigned i = 0; i < CounterCount; ++i) {
+        out << "mm_" << kCounterNames[i] << "_total " << segment.counters[i].value.load(std::memory_order_relaxed) << "\n";
+    }
+    for (unsigned i = 0; i < RejectReasonCount; ++i) {
+        out << "mm_rejects_total{reason=\"" << kRejectNames[i] << "\"} "
+            << segment.rejects[i].value.load(std::memory_order_relaxed) << "\n";
+    }
+    for (unsigned i = 0; i < GaugeCount; ++i) {
+        out << "mm_" << kGaugeNames[i] << " " << segment.gauges[i].value.load(std::memory_order_relaxed) << "\n";
+    }
+    static const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+    for (unsigned i = 0; i < StageCount; ++i) {
+        const Histogram& h = segment.stages[i];
+        for (double q : kQuantiles) {
+            out << "mm_latency_ns{stage=\"" << kStageNames[i] << "\",quantile=\"" << q << "\"} "
+                << percentile(h, q) << "\n";
+        }
+        out << "mm_latency_ns_max{stage=\"" << kStageNames[i] << "\"} " << h.maxNs.load(std::memory_order_relaxed) << "\n";
+        out << "mm_latency_ns_sum{stage=\"" << kStageNames[i] << "\"} " << h.sumNs.load(std::memory_order_relaxed) << "\n";
+        out << "mm_latency_ns_count{stage=\"" << kStageNames[i] << "\"} " << h.count.load(std::memory_order_relaxed) << "\n";
+    }
+    out << "mm_allocations_total " << allocations(segment) << "\n";
+    out << "mm_deallocations_total " << deallocations(segment) << "\n";
+    out << "mm_allocated_bytes_total " << allocatedBytes(segment) << "\n";
+    return out.str();
+}
+
+// --- MetricsHttpServer ---
+
+bool MetricsHttpServer::start(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "MetricsHttpServer: socket failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Never exposed off the box
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+        std::cerr << "MetricsHttpServer: Cannot listen on 127.0.0.1:" << port << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    m_port = port;
+    m_listenFd = fd;
+    m_running = true;
+    m_thread = std::thread([this]() {
+        ThreadTopology::apply(ThreadTopology::Background);
+        serve();
+    });
+    std::cout << "MetricsHttpServer: Serving metrics on http://127.0.0.1:" << port << "/metrics" << std::endl;
+    return true;
+}
+
+void MetricsHttpServer::stop() {
+    if (!m_running) {
+        return;
+    }
+    m_running = false;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    close(m_listenFd);
+    m_listenFd = -1;
+}
+
+void MetricsHttpServer::serve() {
+    while (m_running) {
+        pollfd pfd;
+        pfd.fd = m_listenFd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, 200) <= 0) {
+            continue; // Timeout: re-check m_running
+        }
+        int client = accept(m_listenFd, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+
+        // Whatever was asked for, the answer is the full exposition
+        timeval timeout;
+        timeout.tv_sec = 1;
+        timeout.tv_usec = 0;
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        char request[1024];
+        ssize_t ignored = recv(client, request, sizeof(request), 0);
+        (void)ignored;
+
+        std::string body = Metrics::render(Metrics::local());
+        std::ostringstream response;
+        response << "HTTP/1.0 200 OK\r\n"
+                 << "Content-Type: text/plain; version=0.0.4\r\n"
+                 << "Content-Length: " << body.size() << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << body;
+        std::string data = response.str();
+        int flags = 0;
+#ifdef MSG_NOSIGNAL
+        flags = MSG_NOSIGNAL; // A scraper hanging up must not kill the process
+#endif
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(client, data.data() + sent, data.size() - sent, flags);
+            if (n <= 0) {
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        close(client);
+    }
+}
+
+// --- Global allocation counting ---
+// Every allocation in the process goes through here, so keep it to malloc/free
+// plus two relaxed adds on the calling thread's own shard. The array forms are not
+// replaced: their default versions call these. Aligned new (alignas types over
+// 16 bytes, coroutine frames of such types) gets its own overloads below.
+
+void* operator new(std::size_t size) {
+    for (;;) {
+        void* p = std::malloc(size ? size : 1);
+        if (p) {
+            Metrics::recordAllocation(size);
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return ::operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept {
+    if (p) {
+        Metrics::recordDeallocation();
+        std::free(p);
+    }
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    ::operator delete(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    ::operator delete(p);
+}
+
+#if defined(__cpp_aligned_new)
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (align < sizeof(void*)) {
+        align = sizeof(void*); // posix_memalign's minimum
+    }
+    for (;;) {
+        void* p = nullptr;
+        if (posix_memalign(&p, align, size ? size : 1) == 0) {
+            Metrics::recordAllocation(size);
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return ::operator new(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    ::operator delete(p); // posix_memalign memory goes back through free
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    ::operator delete(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    ::operator delete(p);
+}
+#endif
@@ -0,0 +1,224 @@
+//
+// Metrics.h
+// HFT
+//
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "TscClock.h"
+
+// Process-wide counters, gauges and latency histograms for live monitoring.
+//
+// Everything lives in one fixed-layout Segment. publish() moves it into a POSIX
+// shared-memory object so mm_stat (or the HTTP endpoint) can read it from outside
+// the hot threads; until then it is an ordinary process-local block. Writers only
+// do relaxed atomic adds/stores on cache lines they rarely share, so recording a
+// metric never takes a lock or makes a system call.
+class Metrics {
+public:
+    enum Counter {
+        TicksIn,          // Market data ticks into MarketDataProcessor
+        ClientOrders,     // NewOrderSingle from clients
+        ClientFills,
+        ExecReportsSent,  // To clients
+        QuoteCycles,
+        QuoteNews,        // Requests produced by QuoteBook
+        QuoteReplaces,
+        QuoteCancels,
+        QuoteAcks,        // New/replace/cancel acknowledged
+        QuoteFills,       // Fills on our own quotes
+        SnapshotsTaken,
+        OrderBatches,     // Batches handed to the strategy by OrderBatcher
+        CounterCount
+    };
+
+    enum RejectReason {
+        RejectNoMarketData,     // Client order, no usable book
+        RejectNotMarketable,    // Client limit order, not immediately marketable
+        RejectInvalidOrder,     // Client order with a bad quantity, side, type or price
+        RejectNoStrategy,       // Client order, no StrategyEngine hooked up
+        RejectQuoteByExchange,  // Our new quote rejected upstream
+        RejectCancelUnknown,    // Our replace/cancel for an order the exchange no longer has
+        RejectCancelOther,
+        RejectSendFailed,       // Our request never reached the exchange
+        RejectReasonCount
+    };
+
+    enum Gauge {
+        WorkingQuotes,     // Quote sides not Idle
+        ConflationDepth,   // Symbols drained in the last quote cycle
+        TicksConflated,    // Ticks those symbols absorbed
+        PositionSymbols,
+        LastOrderBatchSize,
+        RegionBytesUsed,     // MemoryRegion arena handed out so far; operator new never sees it
+        RegionHeapFallbacks, // Arena allocations that went to operator new instead
+        GaugeCount
+    };
+
+    enum Stage {
+        OrderHandling,  // Client NewOrderSingle in -> ExecutionReport out (including batching delay)
+        QuoteCycle,     // One manageQuotes() pass
+        QuoteAck,       // Quote request sent -> ack
+        QuoteFill,      // Quote request sent -> fill
+        StageCount
+    };
+
+    // Log-linear buckets: 4 per power of two, 0ns .. ~18 minutes
+    static const unsigned kSubBuckets = 4;
+    static const unsigned kBuckets = 160;
+    static const unsigned kAllocShards = 32;
+
+    struct alignas(64) Histogram {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sumNs;
+        std::atomic<uint64_t> maxNs;
+        std::atomic<uint64_t> buckets[kBuckets];
+    };
+
+    struct alignas(64) PaddedCounter {
+        std::atomic<uint64_t> value;
+    };
+
+    struct alignas(64) AllocShard {
+        std::atomic<uint64_t> allocations;
+        std::atomic<uint64_t> deallocations;
+        std::atomic<uint64_t> bytes;
+    };
+
+    struct Segment {
+        char magic[8];
+        uint32_t version;
+        uint32_t pid;
+        uint64_t startedAtNs; // System clock, for uptime
+
+        PaddedCounter counters[CounterCount];
+        PaddedCounter rejects[RejectReasonCount];
+        PaddedCounter gauges[GaugeCount];
+        Histogram stages[StageCount];
+        AllocShard allocs[kAllocShards]; // Summed by readers; see Metrics.cpp
+    };
+
+    static const char* kMagic;   // "MMSTAT01"
+    static const uint32_t kVersion = 2;
+
+    // --- Writers (any thread) ---
+
+    static void increment(Counter counter, uint64_t by = 1) {
+        s_segment->counters[counter].value.fetch_add(by, std::memory_order_relaxed);
+    }
+
+    static void reject(RejectReason reason) {
+        s_segment->rejects[reason].value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void setGauge(Gauge gauge, uint64_t value) {
+        s_segment->gauges[gauge].value.store(value, std::memory_order_relaxed);
+    }
+
+    static void recordLatency(Stage stage, uint64_t ns) {
+        Histogram& h = s_segment->stages[stage];
+        h.count.fetch_add(1, std::memory_order_relaxed);
+        h.sumNs.fetch_add(ns, std::memory_order_relaxed);
+        h.buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t max = h.maxNs.load(std::memory_order_relaxed);
+        while (ns > max && !h.maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Called by the global operator new/delete replacements in Metrics.cpp
+    static void recordAllocation(size_t bytes);
+    static void recordDeallocation();
+
+    // rdtsc once TscClock::calibrate() has run (see TscClock.h)
+    static uint64_t nowNs() { return TscClock::nowNs(); }
+
+    // Records the lifetime of a scope as one sample of a stage
+    class ScopedLatency {
+    public:
+        explicit ScopedLatency(Stage stage) : m_stage(stage), m_startNs(nowNs()) {}
+        ~ScopedLatency() { recordLatency(m_stage, nowNs() - m_startNs); }
+
+    private:
+        Stage m_stage;
+        uint64_t m_startNs;
+    };
+
+    // --- Lifecycle ---
+
+    // Moves the metrics into the shared-memory object `name` (e.g. "/mm_metrics"),
+    // replacing any left behind by a previous run. Call before starting other threads;
+    // values recorded so far are carried over. Returns false (and keeps the
+    // process-local block) if the segment cannot be created.
+    static bool publish(const std::string& name);
+    // Unlinks the shared-memory object; the mapping stays valid until exit
+    static void unpublish();
+
+    // --- Readers ---
+
+    // Maps a published segment read-only; nullptr if absent or incompatible
+    static const Segment* attach(const std::string& name);
+    static const Segment& local() { return *s_segment; }
+
+    static const char* counterName(unsigned counter);
+    static const char* rejectName(unsigned reason);
+    static const char* gaugeName(unsigned gauge);
+    static const char* stageName(unsigned stage);
+
+    static uint64_t allocations(const Segment& segment);
+    static uint64_t deallocations(const Segment& segment);
+    static uint64_t allocatedBytes(const Segment& segment);
+    // Upper bound of the bucket holding the q-th quantile (0 < q <= 1)
+    static uint64_t percentile(const Histogram& histogram, double q);
+
+    // Prometheus-style plain text exposition of every metric
+    static std::string render(const Segment& segment);
+
+    static unsigned bucketOf(uint64_t ns) {
+        if (ns < kSubBuckets) {
+            return static_cast<unsigned>(ns);
+        }
+        unsigned msb = 63 - __builtin_clzll(ns);
+        unsigned sub = static_cast<unsigned>(ns >> (msb - 2)) & (kSubBuckets - 1);
+        unsigned index = (msb - 1) * kSubBuckets + sub;
+        return index < kBuckets ? index : kBuckets - 1;
+    }
+
+    static uint64_t bucketUpperBound(unsigned index) {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        unsigned msb = index / kSubBuckets + 1;
+        uint64_t sub = index % kSubBuckets;
+        return ((kSubBuckets + sub + 1) << (msb - 2)) - 1;
+    }
+
+private:
+    static Segment* s_segment;
+};
+
+// Serves Metrics::render() over plain HTTP on 127.0.0.1 for scrapers.
+// Runs on its own thread and only reads the segment.
+class MetricsHttpServer {
+public:
+    MetricsHttpServer() : m_port(0), m_listenFd(-1), m_running(false) {}
+    ~MetricsHttpServer() { stop(); }
+
+    bool start(int port);
+    void stop();
+
+private:
+    void serve();
+
+    int m_port;
+    int m_listenFd;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+};
+
+#endif // METRICS_H
@@ -1,7 +1,8 @@
 #ifndef MOCK_MARKET_DATA_SOURCE_H
 #define MOCK_MARKET_DATA_SOURCE_H
 
-#include "OrderBook.h"
+#include "MarketDataProcessor.h"
+#include "ThreadTopology.h"
 #include <string>
 #include <vector>   // To store multiple symbols
 #include <thread>
@@ -12,9 +13,10 @@
 
 class MockMarketDataSource {
 public:
-    MockMarketDataSource(OrderBook* orderBook)
-        : m_orderBook(orderBook), m_running(false),
-          m_randGen(std::chrono::system_clock::now().time_since_epoch().count()) {
+    MockMarketDataSource(MarketDataProcessor* processor)
+        : m_processor(processor), m_running(false),
+          m_randGen(std::chrono::system_clock::now().time_since_epoch().count()),
+          m_lotsDist(1, 50) {
 
         // Define 10 stock symbols and their initial base prices for varied distribution
         m_symbols = {
@@ -33,6 +35,7 @@ public:
     void startGeneratingData() {
         m_running = true;
         m_dataThread = std::thread([this]() {
+            ThreadTopology::apply(ThreadTopology::Feed);
             while (m_running) {
                 for (const auto& entry : m_symbols) {
                     const std::string& symbol = entry.first;
@@ -48,8 +51,12 @@ public:
                         ask = bid + 0.01; // Minimum spread
                     }
 
-                    if (m_orderBook) {
-                        m_orderBook->updateMarketData(symbol, bid, ask);
+                    // Displayed size on each side, in round lots
+                    double bidSize = 100.0 * m_lotsDist(m_randGen);
+                    double askSize = 100.0 * m_lotsDist(m_randGen);
+
+                    if (m_processor) {
+                        m_processor->onQuote(symbol, bid, ask, bidSize, askSize);
                     }
                 }
                 std::this_thread::sleep_for(std::chrono::milliseconds(1000)); // Update all symbols every 1 second
@@ -57,6 +64,15 @@ public:
         });
     }
 
+    // Symbol universe of this feed, in a stable order (used to size per-symbol buffers)
+    std::vector<std::string> getSymbols() const {
+        std::vector<std::string> symbols;
+        for (const auto& entry : m_symbols) {
+            symbols.push_back(entry.first);
+        }
+        return symbols;
+    }
+
     void stopGeneratingData() {
         m_running = false;
         if (m_dataThread.joinable()) {
@@ -65,7 +81,7 @@ public:
     }
 
 private:
-    OrderBook* m_orderBook;
+    MarketDataProcessor* m_processor;
     std::atomic<bool> m_running;
     std::thread m_dataThread;
     std::mt19937 m_randGen;
@@ -74,6 +90,7 @@ private:
     std::vector<std::pair<std::string, double>> m_symbols;
     // Map to store a unique price distribution for each symbol
     std::map<std::string, std::uniform_real_distribution<>> m_priceDists;
+    std::uniform_int_distribution<> m_lotsDist;
 };
 
 #endif // MOCK_MARKET_DATA_SOURCE_H
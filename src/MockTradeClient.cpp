@@ -1,4 +1,5 @@
 #include "MockTradeClient.h"
+#include "FixValidator.h"
 #include <quickfix/Session.h>
 #include <quickfix/FieldConvertors.h> // For FIX::UtcTimeStamp
 #include <quickfix/FixFields.h>       // Needed for FIX::LastQty, FIX::LastPx etc.
@@ -8,7 +9,7 @@
 // Constructor now takes an OrderBook pointer
 MockTradeClient::MockTradeClient(OrderBook* orderBook)
     : m_orderBook(orderBook), // Initialize the OrderBook pointer
-      m_clOrdID(0), m_running(false),
+      m_clOrdIds("CLIENT-ORDER"), m_running(false),
       m_randGen(std::chrono::system_clock::now().time_since_epoch().count()),
       m_priceFluctuationDist(-0.5, 0.5), // Orders will be +/- 0.5 from mid-price
       m_qtyDist(10, 100),               // Quantity range
@@ -56,6 +57,7 @@ void MockTradeClient::fromAdmin(const FIX::Message& message, const FIX::SessionI
 }
 
 void MockTradeClient::fromApp(const FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::UnsupportedMessageType) {
+    FixValidator::validate(message);
     crack(message, sessionID); // Dispatches to onMessage handler
 }
 
@@ -131,7 +133,7 @@ void MockTradeClient::onMessage(const FIX42::OrderCancelReject& message, const F
 }
 
 std::string MockTradeClient::generateClOrdID() {
-    return "CLIENT-ORDER-" + std::to_string(++m_clOrdID);
+    return m_clOrdIds.next().str();
 }
 
 void MockTradeClient::sendNewOrderSingle() {
@@ -6,6 +6,7 @@
 #include <quickfix/Message.h> // Corrected from 'Messages.h' in a previous step
 #include <quickfix/Mutex.h>
 #include "OrderBook.h" // Your custom OrderBook header
+#include "IdGenerator.h"
 
 // IMPORTANT: Include specific FIX 4.2 message headers from the 'fix42' subdirectory
 #include <quickfix/fix42/NewOrderSingle.h>
@@ -51,7 +52,7 @@ private:
 
     OrderBook* m_orderBook;
     FIX::SessionID m_sessionID;
-    long m_clOrdID;
+    IdGenerator m_clOrdIds; // Lock-free and unique across client restarts
     std::atomic<bool> m_running;
     std::thread m_orderSendingThread;
     FIX::Mutex m_mutex;
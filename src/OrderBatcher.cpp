@@ -0,0 +1,91 @@
+// src/OrderBatcher.cpp
+#include "OrderBatcher.h"
+#include "Metrics.h"
+#include "ThreadTopology.h"
+
+#include <chrono>
+
+OrderBatcher::OrderBatcher(const Handler& handler, int maxDelayUs, size_t maxBatchSize)
+    : m_handler(handler),
+      m_maxDelayUs(maxDelayUs > 0 ? maxDelayUs : 0),
+      m_maxBatchSize(maxBatchSize > 0 ? maxBatchSize : 1),
+      m_running(false)
+{}
+
+OrderBatcher::~OrderBatcher() {
+    stop();
+}
+
+void OrderBatcher::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_thread = std::thread([this]() { run(); });
+}
+
+void OrderBatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void OrderBatcher::submit(const FIX42::NewOrderSingle& message, const FIX::SessionID& sessionID) {
+    Order order = { message, sessionID, Metrics::nowNs() };
+    size_t queued;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            // Stopped (shutdown drains first, while sessions are still up): match it here
+            lock.unlock();
+            std::vector<Order> single(1, order);
+            m_handler(single);
+            return;
+        }
+        m_pending.push_back(order);
+        queued = m_pending.size();
+    }
+    // Only the first order of a batch needs to wake the batch thread; when a delay is
+    // configured, a full batch wakes it early
+    if (queued == 1 || (m_maxDelayUs > 0 && queued == m_maxBatchSize)) {
+        m_wake.notify_one();
+    }
+}
+
+void OrderBatcher::run() {
+    ThreadTopology::apply(ThreadTopology::Orders);
+    std::vector<Order> batch;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this]() { return !m_pending.empty() || !m_running; });
+        if (m_pending.empty()) {
+            break; // Stopped and drained
+        }
+        if (m_maxDelayUs > 0 && m_running) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(m_maxDelayUs);
+            m_wake.wait_until(lock, deadline, [this]() {
+                return m_pending.size() >= m_maxBatchSize || !m_running;
+            });
+        }
+
+        // One swap takes the whole batch; the FIX thread keeps queuing into the other vector
+        batch.swap(m_pending);
+        lock.unlock();
+
+        Metrics::increment(Metrics::OrderBatches);
+        Metrics::setGauge(Metrics::LastOrderBatchSize, batch.size());
+        m_handler(batch);
+        batch.clear();
+
+        lock.lock();
+    }
+}
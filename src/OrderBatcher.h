@@ -0,0 +1,61 @@
+//
+// OrderBatcher.h
+// HFT
+//
+#ifndef ORDER_BATCHER_H
+#define ORDER_BATCHER_H
+
+#include <quickfix/SessionID.h>
+#include <quickfix/fix42/NewOrderSingle.h>
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <cstdint>
+
+// Batched order entry. The FIX thread only queues client orders; a dedicated
+// thread takes everything that has accumulated in one swap and hands it to the
+// handler as a group. Orders that arrive in the same socket read land in the
+// same batch, since the FIX thread queues them back to back while the batch
+// thread is still busy with the previous one.
+//
+// With maxDelayUs > 0 the batch thread waits that long after the first order
+// for more to arrive (up to maxBatchSize), trading a bounded delay for larger
+// batches in bursts. With 0 it never waits: batches are whatever was queued.
+class OrderBatcher {
+public:
+    struct Order {
+        FIX42::NewOrderSingle message;
+        FIX::SessionID sessionID;
+        uint64_t receivedNs; // Metrics::nowNs() when queued
+    };
+
+    typedef std::function<void(std::vector<Order>& batch)> Handler;
+
+    OrderBatcher(const Handler& handler, int maxDelayUs, size_t maxBatchSize);
+    ~OrderBatcher();
+
+    void start();
+    void stop(); // Processes whatever is still queued first
+
+    // FIX thread: queue one order (copies the message). Once stopped, the order is
+    // handled on the calling thread as a batch of one, so none is left unanswered.
+    void submit(const FIX42::NewOrderSingle& message, const FIX::SessionID& sessionID);
+
+private:
+    void run();
+
+    Handler m_handler;
+    int m_maxDelayUs;
+    size_t m_maxBatchSize;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<Order> m_pending; // Guarded by m_mutex
+    bool m_running;
+    std::thread m_thread;
+};
+
+#endif // ORDER_BATCHER_H
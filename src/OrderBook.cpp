@@ -1,3 +1,8 @@
 // src/OrderBook.cpp
-// No implementation needed as all methods are defined inline in OrderBook.h
-//develop complex order book next
+// Everything is defined inline in OrderBook.h; the standard builds from
+// OrderBookFwd.h are instantiated here so each policy combination is compiled
+#include "OrderBook.h"
+
+template class BasicOrderBook<SparseStorage, MutexLock, ConsoleLog>;
+template class BasicOrderBook<DenseStorage, NoLock, NullLog>;
+template class BasicOrderBook<DenseStorage, SeqLock, NullLog>;
@@ -7,57 +7,269 @@
 #ifndef ORDER_BOOK_H
 #define ORDER_BOOK_H
 
+#include "OrderBookFwd.h"
+#include "MemoryRegion.h"
+
 #include <string>
 #include <map>      // Now actively used for multiple symbols
+#include <vector>
+#include <unordered_map>
 #include <mutex>    // Crucial for thread safety
+#include <atomic>
 #include <iostream>
 #include <cmath>    // For std::round (if needed for rounding prices)
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+
+// Top of book for a single symbol
+struct TopOfBook {
+    double bid;
+    double ask;
+    double mid;
+
+    // Constructor to initialize
+    TopOfBook() : bid(0.0), ask(0.0), mid(0.0) {}
+};
+
+// --- Storage policies: where the per-symbol entries live ---
 
-class OrderBook {
+// Any symbol, created on its first update
+class SparseStorage {
 public:
-    // Structure to hold market data for a single symbol
-    struct MarketData {
-        double bid;
-        double ask;
-        double mid;
-
-        // Constructor to initialize
-        MarketData() : bid(0.0), ask(0.0), mid(0.0) {}
-    };
+    // Inserting rebalances the tree, so readers may not walk it during a write
+    static const bool kStable = false;
 
-    OrderBook() {} // Constructor no longer initializes member variables directly, map is empty
+    TopOfBook* find(const std::string& symbol) {
+        auto it = m_data.find(symbol);
+        return it != m_data.end() ? &it->second : nullptr;
+    }
 
-    void updateMarketData(const std::string& symbol, double bid, double ask) {
+    TopOfBook* findOrInsert(const std::string& symbol) {
+        return &m_data[symbol]; // Default-constructed (all zeros) if symbol doesn't exist
+    }
+
+    template <class Fn>
+    void forEach(Fn&& fn) const {
+        for (const auto& entry : m_data) {
+            fn(entry.first, entry.second);
+        }
+    }
+
+private:
+    RegionMap<std::string, TopOfBook> m_data; // Nodes on the huge-page arena
+};
+
+// Fixed symbol universe, entries contiguous and never moved. Updates for symbols
+// outside the universe are dropped.
+class DenseStorage {
+public:
+    static const bool kStable = true;
+
+    explicit DenseStorage(const std::vector<std::string>& symbols)
+        : m_symbols(symbols), m_data(symbols.size())
+    {
+        for (size_t i = 0; i < m_symbols.size(); ++i) {
+            m_index[m_symbols[i]] = i;
+        }
+    }
+
+    TopOfBook* find(const std::string& symbol) {
+        auto it = m_index.find(symbol);
+        return it != m_index.end() ? &m_data[it->second] : nullptr;
+    }
+
+    TopOfBook* findOrInsert(const std::string& symbol) { return find(symbol); }
+
+    template <class Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t i = 0; i < m_symbols.size(); ++i) {
+            fn(m_symbols[i], m_data[i]);
+        }
+    }
+
+private:
+    std::vector<std::string> m_symbols;
+    std::unordered_map<std::string, size_t> m_index;
+    RegionVector<TopOfBook> m_data;
+};
+
+// --- Lock policies: how readers and the writer are kept apart ---
+// write(fn) / read(fn) run fn under the policy; load/store move a TopOfBook in or
+// out of storage in a way that is safe under that policy.
+
+// Single-threaded use only: no synchronisation at all
+struct NoLock {
+    static const bool kRequiresStableStorage = false;
+
+    // Also a BasicLockable, so std::lock_guard<NoLock> compiles to nothing (StrategyEngine)
+    void lock() {}
+    void unlock() {}
+
+    template <class Fn>
+    auto write(Fn&& fn) -> decltype(fn()) { return fn(); }
+    template <class Fn>
+    auto read(Fn&& fn) -> decltype(fn()) { return fn(); }
+
+    static TopOfBook load(const TopOfBook& from) { return from; }
+    static void store(TopOfBook& to, const TopOfBook& value) { to = value; }
+};
+
+// Any number of readers and writers
+class MutexLock {
+public:
+    static const bool kRequiresStableStorage = false;
+
+    // Also a BasicLockable, for callers that scope a critical section with std::lock_guard
+    void lock() { m_mutex.lock(); }
+    void unlock() { m_mutex.unlock(); }
+
+    template <class Fn>
+    auto write(Fn&& fn) -> decltype(fn()) {
         std::lock_guard<std::mutex> lock(m_mutex); // Lock for thread safety
+        return fn();
+    }
+    template <class Fn>
+    auto read(Fn&& fn) -> decltype(fn()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return fn();
+    }
+
+    static TopOfBook load(const TopOfBook& from) { return from; }
+    static void store(TopOfBook& to, const TopOfBook& value) { to = value; }
+
+private:
+    std::mutex m_mutex;
+};
 
-        // Get or create the MarketData entry for this symbol
-        MarketData& data = m_symbolData[symbol]; // This will create a default-constructed MarketData if symbol doesn't exist
+// One writer thread, lock-free readers that retry if a write overlapped them.
+// Entries are copied word by word with relaxed atomics, so a torn read is
+// detected by the sequence check rather than being a data race.
+class SeqLock {
+public:
+    // Readers run concurrently with the writer and must never see storage move
+    static const bool kRequiresStableStorage = true;
+
+    SeqLock() : m_sequence(0) {}
+
+    template <class Fn>
+    auto write(Fn&& fn) -> decltype(fn()) {
+        uint32_t seq = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(seq + 1, std::memory_order_relaxed); // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        WriteEnd end(m_sequence, seq + 2);
+        return fn();
+    }
+
+    template <class Fn>
+    auto read(Fn&& fn) -> decltype(fn()) {
+        for (;;) {
+            uint32_t before = m_sequence.load(std::memory_order_acquire);
+            if ((before & 1) != 0) {
+                continue;
+            }
+            auto result = fn();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == before) {
+                return result;
+            }
+        }
+    }
+
+    static TopOfBook load(const TopOfBook& from) {
+        uint64_t words[kWords];
+        const uint64_t* source = reinterpret_cast<const uint64_t*>(&from);
+        for (size_t i = 0; i < kWords; ++i) {
+            words[i] = __atomic_load_n(source + i, __ATOMIC_RELAXED);
+        }
+        TopOfBook value;
+        std::memcpy(&value, words, sizeof(value));
+        return value;
+    }
+
+    static void store(TopOfBook& to, const TopOfBook& value) {
+        uint64_t words[kWords];
+        std::memcpy(words, &value, sizeof(value));
+        uint64_t* target = reinterpret_cast<uint64_t*>(&to);
+        for (size_t i = 0; i < kWords; ++i) {
+            __atomic_store_n(target + i, words[i], __ATOMIC_RELAXED);
+        }
+    }
+
+private:
+    static const size_t kWords = sizeof(TopOfBook) / sizeof(uint64_t);
+    static_assert(sizeof(TopOfBook) % sizeof(uint64_t) == 0, "TopOfBook must be a whole number of words");
+
+    // Closes the write section even when fn() returns a value
+    struct WriteEnd {
+        std::atomic<uint32_t>& sequence;
+        uint32_t value;
+        WriteEnd(std::atomic<uint32_t>& s, uint32_t v) : sequence(s), value(v) {}
+        ~WriteEnd() { sequence.store(value, std::memory_order_release); }
+    };
+
+    std::atomic<uint32_t> m_sequence;
+};
+
+// --- Log policies: what happens after each update ---
 
+struct ConsoleLog {
+    static void onUpdate(const std::string& symbol, const TopOfBook& data) {
+        std::cout << "OrderBook Updated: " << symbol
+                  << " Bid=" << data.bid
+                  << ", Ask=" << data.ask
+                  << ", Mid=" << data.mid << std::endl;
+    }
+};
+
+struct NullLog {
+    static void onUpdate(const std::string&, const TopOfBook&) {}
+};
+
+// Top-of-book store, specialised at compile time. Every policy call is a static
+// or inline call on a concrete type; nothing on the update or lookup path is
+// virtual. See OrderBookFwd.h for the standard builds.
+template <class Storage, class Lock, class Log>
+class BasicOrderBook {
+    static_assert(Storage::kStable || !Lock::kRequiresStableStorage,
+                  "This lock policy lets readers run during writes; it needs storage that never moves");
+
+public:
+    typedef TopOfBook MarketData;
+
+    // Arguments go to the storage policy (DenseStorage takes its symbol universe)
+    template <class... StorageArgs>
+    explicit BasicOrderBook(StorageArgs&&... args) : m_storage(std::forward<StorageArgs>(args)...) {}
+
+    void updateMarketData(const std::string& symbol, double bid, double ask) {
+        MarketData data;
         data.bid = bid;
         data.ask = ask;
-
         if (bid > 0 && ask > 0) {
             data.mid = (bid + ask) / 2.0;
         } else {
             data.mid = 0.0;
         }
 
-        std::cout << "OrderBook Updated: " << symbol
-                  << " Bid=" << data.bid
-                  << ", Ask=" << data.ask
-                  << ", Mid=" << data.mid << std::endl;
+        bool stored = m_lock.write([&]() {
+            MarketData* entry = m_storage.findOrInsert(symbol);
+            if (entry) {
+                Lock::store(*entry, data);
+            }
+            return entry != nullptr;
+        });
+        if (stored) {
+            Log::onUpdate(symbol, data); // Outside the lock
+        }
     }
 
-    // Helper to get MarketData for a symbol, returns a copy (thread-safe for read)
-    // Or consider returning optional/pointer if symbol might not exist.
-    // For simplicity, returns default MarketData if symbol not found.
+    // Returns a copy; default MarketData (all zeros) if the symbol is not in the book
     MarketData getMarketData(const std::string& symbol) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        auto it = m_symbolData.find(symbol);
-        if (it != m_symbolData.end()) {
-            return it->second; // Return the actual data
-        }
-        return MarketData(); // Return default (all zeros) if symbol not found
+        return m_lock.read([&]() {
+            MarketData* entry = m_storage.find(symbol);
+            return entry ? Lock::load(*entry) : MarketData();
+        });
     }
 
     double getBestBid(const std::string& symbol) {
@@ -72,10 +284,32 @@ public:
         return getMarketData(symbol).mid;
     }
 
+    // Copies the whole book under the lock so a snapshot writer can serialise it
+    // on its own thread. The lock is held only for the copy, never for disk I/O.
+    std::map<std::string, MarketData> snapshot() {
+        return m_lock.read([&]() {
+            std::map<std::string, MarketData> copy;
+            m_storage.forEach([&](const std::string& symbol, const MarketData& data) {
+                copy[symbol] = Lock::load(data);
+            });
+            return copy;
+        });
+    }
+
+    // Seeds a symbol from a warm-restart snapshot without logging every entry.
+    void restore(const std::string& symbol, const MarketData& data) {
+        m_lock.write([&]() {
+            MarketData* entry = m_storage.findOrInsert(symbol);
+            if (entry) {
+                Lock::store(*entry, data);
+            }
+            return entry != nullptr;
+        });
+    }
+
 private:
-    std::mutex m_mutex;
-    // Map to store MarketData for each symbol
-    std::map<std::string, MarketData> m_symbolData;
+    Lock m_lock;
+    Storage m_storage;
 };
 
 #endif // ORDER_BOOK_H
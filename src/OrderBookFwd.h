@@ -0,0 +1,32 @@
+//
+// OrderBookFwd.h
+// HFT
+//
+#ifndef ORDER_BOOK_FWD_H
+#define ORDER_BOOK_FWD_H
+
+// Forward declarations of the book template and the policies of the standard
+// builds, for headers that only pass books around by pointer (see OrderBook.h)
+class SparseStorage;
+class DenseStorage;
+struct NoLock;
+class MutexLock;
+class SeqLock;
+struct ConsoleLog;
+struct NullLog;
+
+template <class Storage, class Lock, class Log>
+class BasicOrderBook;
+
+// The market maker's book: any symbol, shared by the feed, FIX and strategy threads
+typedef BasicOrderBook<SparseStorage, MutexLock, ConsoleLog> OrderBook;
+
+// One single-threaded shard over a fixed symbol set (backtests, shard-per-core
+// builds): every lock and log call compiles away
+typedef BasicOrderBook<DenseStorage, NoLock, NullLog> ShardOrderBook;
+
+// A fixed symbol set written by one feed thread and read from any thread without
+// taking a lock (readers retry across a concurrent write)
+typedef BasicOrderBook<DenseStorage, SeqLock, NullLog> SharedShardOrderBook;
+
+#endif // ORDER_BOOK_FWD_H
@@ -0,0 +1,195 @@
+// src/QuoteBook.cpp
+#include "QuoteBook.h"
+
+#include <cmath>
+
+bool QuoteBook::samePrice(double a, double b) const {
+    return std::llround(a / m_tickSize) == std::llround(b / m_tickSize);
+}
+
+void QuoteBook::reconcile(const std::string& symbol, Side side, double price, long long size,
+                          IdGenerator& clOrdIds, std::vector<Action>& actions) {
+    Quote& quote = m_quotes[symbol].sides[side];
+    bool wanted = size > 0 && price > 0.0;
+
+    Action action;
+    action.symbol = symbol;
+    action.side = side;
+    action.price = price;
+    action.size = size;
+    action.cumQty = 0;
+
+    switch (quote.state) {
+    case PendingNew:
+    case PendingReplace:
+    case PendingCancel:
+        ++m_stats.awaitingAck;
+        return;
+
+    case Idle:
+        if (!wanted) {
+            return;
+        }
+        action.type = Action::New;
+        action.clOrdID = clOrdIds.next().str();
+        quote.state = PendingNew;
+        quote.clOrdID = action.clOrdID;
+        quote.price = price;
+        quote.orderQty = size;
+        quote.cumQty = 0;
+        m_byClOrdID[action.clOrdID] = Key{symbol, side};
+        ++m_stats.news;
+        break;
+
+    case Live:
+        if (wanted && samePrice(quote.price, price) && quote.leavesQty() == size) {
+            ++m_stats.unchanged;
+            return;
+        }
+        action.type = wanted ? Action::Replace : Action::Cancel;
+        action.clOrdID = clOrdIds.next().str();
+        action.origClOrdID = quote.clOrdID;
+        action.orderID = quote.orderID;
+        action.price = wanted ? price : quote.price;
+        action.size = wanted ? quote.cumQty + size : quote.orderQty;
+        action.cumQty = quote.cumQty;
+        quote.state = wanted ? PendingReplace : PendingCancel;
+        quote.pendingClOrdID = action.clOrdID;
+        quote.pendingPrice = price;
+        quote.pendingOrderQty = action.size;
+        m_byClOrdID[action.clOrdID] = Key{symbol, side};
+        if (wanted) {
+            ++m_stats.replaces;
+        } else {
+            ++m_stats.cancels;
+        }
+        break;
+    }
+    actions.push_back(action);
+}
+
+QuoteBook::Quote* QuoteBook::lookup(const std::string& clOrdID) {
+    auto it = m_byClOrdID.find(clOrdID);
+    if (it == m_byClOrdID.end()) {
+        return nullptr;
+    }
+    return &m_quotes[it->second.symbol].sides[it->second.side];
+}
+
+void QuoteBook::reset(Quote& quote) {
+    m_byClOrdID.erase(quote.clOrdID);
+    if (!quote.pendingClOrdID.empty()) {
+        m_byClOrdID.erase(quote.pendingClOrdID);
+    }
+    quote = Quote();
+}
+
+bool QuoteBook::onNewAck(const std::string& clOrdID, const std::string& orderID) {
+    Quote* quote = lookup(clOrdID);
+    if (!quote) {
+        return false;
+    }
+    if (quote->state == PendingNew && quote->clOrdID == clOrdID) {
+        quote->state = Live;
+        quote->orderID = orderID;
+    }
+    return true;
+}
+
+bool QuoteBook::onReplaceAck(const std::string& clOrdID, const std::string& orderID, long long leavesQty) {
+    Quote* quote = lookup(clOrdID);
+    if (!quote) {
+        return false;
+    }
+    if (quote->state == PendingReplace && quote->pendingClOrdID == clOrdID) {
+        // The venue counts every fill so far against the new quantity
+        if (leavesQty >= 0) {
+            quote->cumQty = quote->pendingOrderQty - leavesQty;
+        }
+        if (quote->pendingOrderQty <= quote->cumQty) {
+            reset(*quote); // Filled up to the new quantity already
+            return true;
+        }
+        m_byClOrdID.erase(quote->clOrdID);
+        quote->clOrdID = clOrdID;
+        quote->orderID = orderID.empty() ? quote->orderID : orderID;
+        quote->price = quote->pendingPrice;
+        quote->orderQty = quote->pendingOrderQty;
+        quote->pendingClOrdID.clear();
+        quote->state = Live;
+    }
+    return true;
+}
+
+bool QuoteBook::onCanceled(const std::string& clOrdID) {
+    Quote* quote = lookup(clOrdID);
+    if (!quote) {
+        return false;
+    }
+    reset(*quote);
+    return true;
+}
+
+bool QuoteBook::onFill(const std::string& clOrdID, long long leavesQty) {
+    Quote* quote = lookup(clOrdID);
+    if (!quote) {
+        return false;
+    }
+    if (leavesQty <= 0) {
+        reset(*quote); // Fully filled: the side is free to quote again
+    } else {
+        // Reported against whichever order it hit: the working one, or a replace not yet acked
+        long long orderQty = clOrdID == quote->pendingClOrdID ? quote->pendingOrderQty : quote->orderQty;
+        if (orderQty - leavesQty > quote->cumQty) {
+            quote->cumQty = orderQty - leavesQty;
+        }
+    }
+    return true;
+}
+
+bool QuoteBook::onRejected(const std::string& clOrdID) {
+    Quote* quote = lookup(clOrdID);
+    if (!quote) {
+        return false;
+    }
+    if (quote->state == PendingNew) {
+        reset(*quote);
+    } else if (quote->pendingClOrdID == clOrdID) {
+        return onCancelRejected(clOrdID);
+    }
+    return true;
+}
+
+bool QuoteBook::onCancelRejected(const std::string& clOrdID) {
+    Quote* quote = lookup(clOrdID);
+    if (!quote) {
+        return false;
+    }
+    if (quote->pendingClOrdID == clOrdID) {
+        // The original order is still working at its old price and size
+        m_byClOrdID.erase(clOrdID);
+        quote->pendingClOrdID.clear();
+        quote->state = Live;
+    }
+    return true;
+}
+
+const QuoteBook::Quote* QuoteBook::find(const std::string& symbol, Side side) const {
+    auto it = m_quotes.find(symbol);
+    if (it == m_quotes.end() || it->second.sides[side].state == Idle) {
+        return nullptr;
+    }
+    return &it->second.sides[side];
+}
+
+size_t QuoteBook::workingCount() const {
+    size_t count = 0;
+    for (const auto& entry : m_quotes) {
+        for (int side = 0; side < 2; ++side) {
+            if (entry.second.sides[side].state != Idle) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
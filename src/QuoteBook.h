@@ -0,0 +1,127 @@
+//
+// QuoteBook.h
+// HFT
+//
+#ifndef QUOTE_BOOK_H
+#define QUOTE_BOOK_H
+
+#include "IdGenerator.h"
+#include "MemoryRegion.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Tracks our own live quotes per symbol and side, and turns "desired quote" into the
+// minimal set of new / replace / cancel requests. A side whose desired price and size
+// match the live quote produces no message at all; a side with a request in flight
+// is left alone until the ack arrives, so we never stack replaces on top of each other.
+//
+// Sizes in reconcile() are what should be left working. A quote keeps the venue's
+// OrderQty and CumQty apart: a replace's OrderQty includes what the order has already
+// filled (FIX 4.2), so it is sent as cumQty + the desired size, and a partially
+// filled quote matches again once its leaves equal the desired size.
+//
+// Not thread-safe; StrategyEngine serialises access.
+class QuoteBook {
+public:
+    enum Side { Bid = 0, Ask = 1 };
+
+    enum State {
+        Idle,           // Nothing working on this side
+        PendingNew,
+        Live,
+        PendingReplace,
+        PendingCancel
+    };
+
+    struct Quote {
+        State state;
+        std::string clOrdID;        // ClOrdID of the working order
+        std::string orderID;        // Exchange OrderID once acked
+        double price;
+        long long orderQty;         // OrderQty of the working order, fills included
+        long long cumQty;           // Filled so far, across replaces
+        std::string pendingClOrdID; // ClOrdID of the in-flight replace/cancel
+        double pendingPrice;
+        long long pendingOrderQty;
+
+        Quote() : state(Idle), price(0.0), orderQty(0), cumQty(0), pendingPrice(0.0), pendingOrderQty(0) {}
+
+        long long leavesQty() const { return orderQty - cumQty; }
+    };
+
+    struct Action {
+        enum Type { New, Replace, Cancel };
+
+        Type type;
+        std::string symbol;
+        Side side;
+        std::string clOrdID;
+        std::string origClOrdID; // Replace / Cancel only
+        std::string orderID;     // Replace / Cancel only, if already acked
+        double price;
+        long long size;   // OrderQty to send
+        long long cumQty; // Replace only: already filled, included in size
+    };
+
+    struct Stats {
+        uint64_t news;
+        uint64_t replaces;
+        uint64_t cancels;
+        uint64_t unchanged;
+        uint64_t awaitingAck;
+
+        Stats() : news(0), replaces(0), cancels(0), unchanged(0), awaitingAck(0) {}
+    };
+
+    explicit QuoteBook(double tickSize = 0.01) : m_tickSize(tickSize) {}
+
+    // Appends whatever requests are needed to move this side to price x size.
+    // size <= 0 means we want no quote on this side.
+    void reconcile(const std::string& symbol, Side side, double price, long long size,
+                   IdGenerator& clOrdIds, std::vector<Action>& actions);
+
+    // Ack handling. Each returns false when clOrdID is not one of our quotes.
+    bool onNewAck(const std::string& clOrdID, const std::string& orderID);
+    // leavesQty is the ack's LeavesQty (the venue's newQty - cumQty), or -1 if it had
+    // none, in which case it is worked out from the fills seen so far
+    bool onReplaceAck(const std::string& clOrdID, const std::string& orderID, long long leavesQty = -1);
+    bool onCanceled(const std::string& clOrdID);
+    bool onFill(const std::string& clOrdID, long long leavesQty);
+    bool onRejected(const std::string& clOrdID);       // Rejected new order
+    bool onCancelRejected(const std::string& clOrdID); // Rejected replace or cancel
+
+    const Quote* find(const std::string& symbol, Side side) const;
+    bool isOurs(const std::string& clOrdID) const { return m_byClOrdID.count(clOrdID) != 0; }
+    // Forgets every quote (e.g. the venue session dropped); stats are kept
+    void clear() {
+        m_quotes.clear();
+        m_byClOrdID.clear();
+    }
+    size_t workingCount() const;
+
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct Key {
+        std::string symbol;
+        Side side;
+    };
+
+    struct SymbolQuotes {
+        Quote sides[2];
+    };
+
+    Quote* lookup(const std::string& clOrdID);
+    void reset(Quote& quote);
+    bool samePrice(double a, double b) const;
+
+    double m_tickSize;
+    RegionUnorderedMap<std::string, SymbolQuotes> m_quotes;
+    RegionUnorderedMap<std::string, Key> m_byClOrdID; // Working and pending ClOrdIDs -> side
+    Stats m_stats;
+};
+
+#endif // QUOTE_BOOK_H
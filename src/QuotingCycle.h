@@ -0,0 +1,231 @@
+//
+// QuotingCycle.h
+// HFT
+//
+#ifndef QUOTING_CYCLE_H
+#define QUOTING_CYCLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "IdGenerator.h"
+#include "QuoteBook.h"
+#include "SignalKernel.h"
+#include "TimerWheel.h"
+
+// What one quoting pass decides, given market state, positions and the quotes already
+// working: the StrategyEngine's quoting thread and the backtester both run it, so a
+// backtest measures the strategy that ships. A pass is
+//   onMarket() for each symbol with a new top of book, setPosition() for each position,
+//   compute(), then decide(), which turns the model's prices into QuoteBook requests.
+// Between passes advance() fires the timers: deferred requotes (minQuoteLifeNs) join the
+// next pass and stale symbols (staleNs) are pulled on the spot.
+//
+// Time is whatever monotonic ns clock the caller passes in: TscClock live, the simulated
+// clock in a backtest. Not thread-safe; the caller serialises it, and holds whatever
+// guards `quotes` around advance() and decide().
+template <class QuotingModel>
+class BasicQuotingCycle {
+public:
+    struct Params {
+        typename QuotingModel::Params signal;
+        long long quoteSize;
+        long long maxPosition;      // A side stops quoting once |position| reaches this; 0 = no limit
+        uint64_t minQuoteLifeNs;    // Quotes are not changed until this old; the change waits. 0 = off
+        uint64_t staleNs;           // Quotes are pulled once their market is this quiet. 0 = off
+        bool quoteAroundMicroprice; // Centre on the microprice given to onMarket(), when there is one
+
+        Params() : quoteSize(200), maxPosition(0), minQuoteLifeNs(0), staleNs(0), quoteAroundMicroprice(false) {}
+    };
+
+    typedef std::pair<size_t, uint64_t> Change; // (index, ticks conflated into it); 0 ticks for a requote
+
+    BasicQuotingCycle(const std::vector<std::string>& symbols, uint64_t timerTickNs, uint64_t startNs)
+        : m_signals(symbols.size()), m_timers(timerTickNs, startNs) {
+        setSymbols(symbols);
+    }
+
+    // Resizes every per-symbol column; pending timers and changes are dropped
+    void setSymbols(const std::vector<std::string>& symbols) {
+        for (TimerId id : m_requoteTimers) {
+            m_timers.cancel(id);
+        }
+        for (TimerId id : m_staleTimers) {
+            m_timers.cancel(id);
+        }
+        m_symbols = symbols;
+        m_signals.resize(symbols.size());
+        m_positions.assign(symbols.size(), 0);
+        m_quotedAtNs.assign(symbols.size(), 0);
+        m_requoteTimers.assign(symbols.size(), 0);
+        m_staleTimers.assign(symbols.size(), 0);
+        m_changed.assign(symbols.size(), 0);
+        m_changes.clear();
+        m_timers.reserve(2 * symbols.size()); // At most a requote and a stale timer per symbol
+    }
+
+    Params& params() { return m_params; }
+    const Params& params() const { return m_params; }
+    QuotingModel& model() { return m_signals; }
+    const QuotingModel& model() const { return m_signals; }
+    size_t size() const { return m_symbols.size(); }
+    const std::string& symbolAt(size_t index) const { return m_symbols[index]; }
+
+    // New top of book for one symbol; ignored until both sides are there. Fair value is
+    // the mid, or with quoteAroundMicroprice the microprice when it is above 0. Restarts
+    // the symbol's stale clock and queues it for the next decide().
+    void onMarket(size_t index, double bid, double ask, double microprice, uint64_t ticksConflated, uint64_t nowNs) {
+        if (bid <= 0.0 || ask <= 0.0) {
+            return;
+        }
+        double fair = m_params.quoteAroundMicroprice && microprice > 0.0 ? microprice : (bid + ask) / 2.0;
+        m_signals.setMarket(index, fair, ask - bid);
+        if (m_params.staleNs > 0) {
+            m_timers.cancel(m_staleTimers[index]);
+            m_staleTimers[index] = m_timers.schedule(nowNs + m_params.staleNs, Timer(Timer::Stale, index));
+        }
+        addChange(index, ticksConflated);
+    }
+
+    // Net positions feed the skew term and the position limit
+    void clearPositions() {
+        m_signals.clearInventories();
+        m_positions.assign(m_positions.size(), 0);
+    }
+    void setPosition(size_t index, long long qty) {
+        m_positions[index] = qty;
+        m_signals.setInventory(index, static_cast<double>(qty));
+    }
+
+    // Fires the timers due by nowNs. A deferred requote joins the pending changes. A stale
+    // symbol has its quotes cancelled into `actions`, unless pending(index) says a market
+    // update is waiting that has not reached onMarket() yet, which restarts its clock.
+    // Symbols pulled by this call are listed in pulled().
+    template <class Pending>
+    void advance(uint64_t nowNs, Pending&& pending, QuoteBook& quotes, IdGenerator& ids,
+                 std::vector<QuoteBook::Action>& actions) {
+        m_pulled.clear();
+        m_timers.advance(nowNs, [&](const Timer& timer) {
+            size_t index = timer.index;
+            if (timer.kind == Timer::Requote) {
+                m_requoteTimers[index] = 0;
+                addChange(index, 0);
+                return;
+            }
+            m_staleTimers[index] = 0;
+            if (pending(index)) {
+                m_staleTimers[index] = m_timers.schedule(nowNs + m_params.staleNs, Timer(Timer::Stale, index));
+                return;
+            }
+            // Nothing to requote until the market moves again
+            m_timers.cancel(m_requoteTimers[index]);
+            m_requoteTimers[index] = 0;
+            removeChange(index);
+            size_t before = actions.size();
+            quotes.reconcile(m_symbols[index], QuoteBook::Bid, 0.0, 0, ids, actions);
+            quotes.reconcile(m_symbols[index], QuoteBook::Ask, 0.0, 0, ids, actions);
+            if (actions.size() != before) {
+                m_quotedAtNs[index] = nowNs;
+                m_pulled.push_back(index);
+            }
+        });
+    }
+
+    // When advance() next has work; max if no timer is pending
+    uint64_t nextTimerNs() const { return m_timers.nextExpiryNs(); }
+
+    const std::vector<Change>& changes() const { return m_changes; }
+    const std::vector<size_t>& pulled() const { return m_pulled; }
+
+    // Fair value, volatility, skew and target prices for every symbol at once
+    void compute() { m_signals.compute(m_params.signal); }
+
+    // Diffs each changed symbol's prices at quoteSize against `quotes`, appending the
+    // requests to `actions`; a side at maxPosition is quoted at 0, which pulls it. A
+    // symbol whose quotes changed less than minQuoteLifeNs ago is held back until they
+    // are old enough. Clears the changes.
+    void decide(uint64_t nowNs, QuoteBook& quotes, IdGenerator& ids, std::vector<QuoteBook::Action>& actions) {
+        for (const Change& change : m_changes) {
+            size_t index = change.first;
+            m_changed[index] = 0;
+            if (m_params.minQuoteLifeNs > 0 && m_quotedAtNs[index] != 0 &&
+                nowNs - m_quotedAtNs[index] < m_params.minQuoteLifeNs) {
+                if (m_requoteTimers[index] == 0) {
+                    m_requoteTimers[index] = m_timers.schedule(m_quotedAtNs[index] + m_params.minQuoteLifeNs,
+                                                               Timer(Timer::Requote, index));
+                }
+                continue;
+            }
+            long long position = m_positions[index];
+            bool bidAllowed = m_params.maxPosition <= 0 || position < m_params.maxPosition;
+            bool askAllowed = m_params.maxPosition <= 0 || position > -m_params.maxPosition;
+            size_t before = actions.size();
+            quotes.reconcile(m_symbols[index], QuoteBook::Bid, m_signals.bid(index),
+                             bidAllowed ? m_params.quoteSize : 0, ids, actions);
+            quotes.reconcile(m_symbols[index], QuoteBook::Ask, m_signals.ask(index),
+                             askAllowed ? m_params.quoteSize : 0, ids, actions);
+            if (actions.size() != before) {
+                m_quotedAtNs[index] = nowNs;
+            }
+        }
+        m_changes.clear();
+    }
+
+private:
+    struct Timer {
+        enum Kind { Requote, Stale };
+        Kind kind;
+        size_t index;
+
+        Timer() : kind(Requote), index(0) {}
+        Timer(Kind kind, size_t index) : kind(kind), index(index) {}
+    };
+    typedef TimerWheel<Timer> Timers;
+    typedef typename Timers::TimerId TimerId;
+
+    void addChange(size_t index, uint64_t ticksConflated) {
+        if (!m_changed[index]) {
+            m_changed[index] = 1;
+            m_changes.push_back(Change(index, ticksConflated));
+            return;
+        }
+        for (Change& change : m_changes) {
+            if (change.first == index) {
+                change.second += ticksConflated;
+                return;
+            }
+        }
+    }
+
+    void removeChange(size_t index) {
+        if (!m_changed[index]) {
+            return;
+        }
+        m_changed[index] = 0;
+        for (size_t i = 0; i < m_changes.size(); ++i) {
+            if (m_changes[i].first == index) {
+                m_changes.erase(m_changes.begin() + i);
+                return;
+            }
+        }
+    }
+
+    std::vector<std::string> m_symbols;
+    QuotingModel m_signals;
+    Params m_params;
+    Timers m_timers;
+    std::vector<long long> m_positions;
+    std::vector<uint64_t> m_quotedAtNs;   // When each symbol's quotes last changed
+    std::vector<TimerId> m_requoteTimers; // Deferred change, 0 if none
+    std::vector<TimerId> m_staleTimers;   // Stale pull, 0 if none
+    std::vector<char> m_changed;          // Listed in m_changes
+    std::vector<Change> m_changes;
+    std::vector<size_t> m_pulled;
+};
+
+typedef BasicQuotingCycle<SignalKernel> QuotingCycle;
+
+#endif // QUOTING_CYCLE_H
@@ -0,0 +1,457 @@
+// src/ShmTransport.cpp
+#include "ShmTransport.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <new>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <climits>
+#endif
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+              "Ring positions are shared between processes and must be lock-free");
+
+namespace ShmTransport {
+
+namespace {
+
+const char kMagic[8] = {'F', 'I', 'X', 'S', 'H', 'M', '0', '1'};
+const uint32_t kVersion = 1;
+
+enum State : uint32_t { Free = 0, Claimed = 1, Connected = 2 };
+const uint32_t kAcceptorClosed = 1;
+const uint32_t kInitiatorClosed = 2;
+
+typedef std::chrono::steady_clock Clock;
+
+} // namespace
+
+struct RingControl {
+    alignas(64) std::atomic<uint64_t> head; // Bytes ever written (producer)
+    alignas(64) std::atomic<uint64_t> tail; // Bytes ever consumed (consumer)
+    alignas(64) std::atomic<uint32_t> signal; // Futex word: bumped after a write while the consumer sleeps
+    std::atomic<uint32_t> sleeping;
+};
+
+struct Segment {
+    char magic[8];
+    uint32_t version;
+    uint32_t ringBytes;
+    std::atomic<uint32_t> state;
+    std::atomic<uint32_t> closed; // kAcceptorClosed | kInitiatorClosed
+    std::atomic<int32_t> acceptorPid;
+    std::atomic<int32_t> initiatorPid;
+    RingControl rings[2]; // 0: initiator -> acceptor, 1: acceptor -> initiator
+    // Ring data follows: ringBytes for ring 0, then ringBytes for ring 1
+};
+
+namespace {
+
+size_t segmentBytes(size_t ringBytes) {
+    return sizeof(Segment) + 2 * ringBytes;
+}
+
+// Frames are a 4-byte length and the message, padded so lengths stay aligned
+uint64_t frameBytes(size_t size) {
+    return (4 + size + 7) & ~uint64_t(7);
+}
+
+bool processAlive(int32_t pid) {
+    return pid <= 0 || ::kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+void wake(std::atomic<uint32_t>& word) {
+#ifdef __linux__
+    // Not FUTEX_PRIVATE: the word lives in memory shared with the other process
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+void sleepOn(std::atomic<uint32_t>& word, uint32_t expected, int timeoutMs) {
+#ifdef __linux__
+    struct timespec timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#else
+    // No cross-process futex: short sleeps bound the added latency
+    (void)expected;
+    (void)timeoutMs;
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+#endif
+}
+
+// Ring positions grow forever; the offset into the data wraps
+void copyIn(char* ring, size_t ringBytes, uint64_t position, const void* data, size_t size) {
+    size_t offset = static_cast<size_t>(position % ringBytes);
+    size_t first = std::min(size, ringBytes - offset);
+    std::memcpy(ring + offset, data, first);
+    std::memcpy(ring, static_cast<const char*>(data) + first, size - first);
+}
+
+void copyOut(const char* ring, size_t ringBytes, uint64_t position, void* data, size_t size) {
+    size_t offset = static_cast<size_t>(position % ringBytes);
+    size_t first = std::min(size, ringBytes - offset);
+    std::memcpy(data, ring + offset, first);
+    std::memcpy(static_cast<char*>(data) + first, ring, size - first);
+}
+
+} // namespace
+
+Channel::Channel() : m_segment(nullptr), m_mappedBytes(0), m_ringBytes(0), m_acceptor(false) {}
+
+Channel::~Channel() {
+    close();
+}
+
+bool Channel::create(const std::string& name, size_t ringBytes, std::string& error) {
+    close();
+    ringBytes = (ringBytes + 63) & ~size_t(63);
+    if (ringBytes < 4096 || ringBytes > 0xFFFFFFFFu) {
+        error = "Ring size out of range for " + name;
+        return false;
+    }
+    // A segment left by a crashed run would otherwise be claimed by initiators forever
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        error = "Cannot create shared memory " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    size_t bytes = segmentBytes(ringBytes);
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        error = "Cannot size shared memory " + name + ": " + std::strerror(errno);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        error = "Cannot map shared memory " + name + ": " + std::strerror(errno);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    Segment* segment = new (mapped) Segment();
+    segment->version = kVersion;
+    segment->ringBytes = static_cast<uint32_t>(ringBytes);
+    segment->state.store(Free);
+    segment->closed.store(0);
+    segment->acceptorPid.store(static_cast<int32_t>(getpid()));
+    segment->initiatorPid.store(0);
+    for (RingControl& ring : segment->rings) {
+        ring.head.store(0);
+        ring.tail.store(0);
+        ring.signal.store(0);
+        ring.sleeping.store(0);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(segment->magic, kMagic, sizeof(segment->magic)); // Initiators accept it from here on
+
+    m_segment = segment;
+    m_mappedBytes = bytes;
+    m_ringBytes = ringBytes;
+    m_acceptor = true;
+    m_name = name;
+    return true;
+}
+
+bool Channel::claim(const std::string& name, int timeoutMs, std::string& error) {
+    close();
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        error = "No acceptor at " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Segment)) {
+        error = "Shared memory " + name + " is not a FIX transport segment";
+        ::close(fd);
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        error = "Cannot map shared memory " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    Segment* segment = static_cast<Segment*>(mapped);
+    m_segment = segment;
+    m_mappedBytes = bytes;
+    m_acceptor = false;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (std::memcmp(segment->magic, kMagic, sizeof(segment->magic)) != 0 || segment->version != kVersion ||
+        segmentBytes(segment->ringBytes) != bytes) {
+        error = "Shared memory " + name + " is not a FIX transport segment";
+        close();
+        return false;
+    }
+    m_ringBytes = segment->ringBytes;
+    if (!processAlive(segment->acceptorPid.load())) {
+        error = "Acceptor for " + name + " is gone";
+        close();
+        return false;
+    }
+    uint32_t expected = Free;
+    if (!segment->state.compare_exchange_strong(expected, Claimed)) {
+        error = "Shared memory " + name + " is already connected";
+        close();
+        return false;
+    }
+    segment->initiatorPid.store(static_cast<int32_t>(getpid()));
+
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+        uint32_t state = segment->state.load(std::memory_order_acquire);
+        if (state == Connected) {
+            return true;
+        }
+        if (state == Free) {
+            error = "Acceptor at " + name + " turned the connection away";
+            break;
+        }
+        if (Clock::now() >= deadline) {
+            error = "Acceptor at " + name + " did not answer";
+            expected = Claimed;
+            segment->state.compare_exchange_strong(expected, Free);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    close();
+    return false;
+}
+
+void Channel::close() {
+    if (!m_segment) {
+        return;
+    }
+    munmap(static_cast<void*>(m_segment), m_mappedBytes);
+    if (m_acceptor) {
+        shm_unlink(m_name.c_str());
+    }
+    m_segment = nullptr;
+    m_mappedBytes = 0;
+}
+
+char* Channel::ringData(unsigned ring) const {
+    return reinterpret_cast<char*>(m_segment) + sizeof(Segment) + ring * m_ringBytes;
+}
+
+int32_t Channel::peerPid() const {
+    return m_acceptor ? m_segment->initiatorPid.load() : m_segment->acceptorPid.load();
+}
+
+bool Channel::claimed() {
+    if (m_segment->state.load(std::memory_order_acquire) != Claimed) {
+        return false;
+    }
+    int32_t pid = m_segment->initiatorPid.load();
+    if (pid == 0) {
+        return false; // Claimed an instant ago; its pid follows
+    }
+    if (!processAlive(pid)) {
+        release(); // Died waiting for us
+        return false;
+    }
+    return true;
+}
+
+void Channel::accept() {
+    for (RingControl& ring : m_segment->rings) {
+        ring.head.store(0, std::memory_order_relaxed);
+        ring.tail.store(0, std::memory_order_relaxed);
+        ring.sleeping.store(0, std::memory_order_relaxed);
+    }
+    m_segment->closed.store(0, std::memory_order_relaxed);
+    m_segment->state.store(Connected, std::memory_order_release);
+}
+
+void Channel::reject() {
+    release();
+}
+
+void Channel::release() {
+    m_segment->initiatorPid.store(0);
+    m_segment->closed.store(0);
+    m_segment->state.store(Free, std::memory_order_release);
+}
+
+void Channel::markClosed() {
+    if (!m_segment) {
+        return;
+    }
+    m_segment->closed.fetch_or(m_acceptor ? kAcceptorClosed : kInitiatorClosed);
+    for (RingControl& ring : m_segment->rings) {
+        ring.signal.fetch_add(1);
+        wake(ring.signal);
+    }
+}
+
+bool Channel::closed() const {
+    return !m_segment || (m_segment->closed.load() & (m_acceptor ? kAcceptorClosed : kInitiatorClosed)) != 0;
+}
+
+bool Channel::peerClosed() const {
+    return !m_segment || (m_segment->closed.load() & (m_acceptor ? kInitiatorClosed : kAcceptorClosed)) != 0 ||
+           !processAlive(peerPid());
+}
+
+bool Channel::send(const char* data, size_t size, int timeoutMs) {
+    uint64_t frame = frameBytes(size);
+    if (!m_segment || frame > m_ringBytes || closed()) {
+        return false;
+    }
+    uint64_t head = m_segment->rings[outRing()].head.load(std::memory_order_relaxed);
+    if (!waitForRoom(head, frame, timeoutMs)) {
+        return false;
+    }
+    writeFrame(head, data, size);
+    publish(head + frame);
+    return true;
+}
+
+bool Channel::send(const std::string* messages, size_t count, int timeoutMs) {
+    if (!m_segment || closed()) {
+        return false;
+    }
+    uint64_t published = m_segment->rings[outRing()].head.load(std::memory_order_relaxed);
+    uint64_t head = published;
+    bool sent = true;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t frame = frameBytes(messages[i].size());
+        if (frame > m_ringBytes) {
+            sent = false;
+            break;
+        }
+        if (!hasRoom(head, frame) && head != published) {
+            publish(head); // The peer can only drain what it has been shown
+            published = head;
+        }
+        if (!waitForRoom(head, frame, timeoutMs)) {
+            sent = false;
+            break;
+        }
+        writeFrame(head, messages[i].data(), messages[i].size());
+        head += frame;
+    }
+    if (head != published) {
+        publish(head);
+    }
+    return sent;
+}
+
+bool Channel::hasRoom(uint64_t head, uint64_t frame) const {
+    const RingControl& ring = m_segment->rings[outRing()];
+    return m_ringBytes - (head - ring.tail.load(std::memory_order_acquire)) >= frame;
+}
+
+bool Channel::waitForRoom(uint64_t head, uint64_t frame, int timeoutMs) const {
+    if (hasRoom(head, frame)) {
+        return true;
+    }
+    // Full: the peer is behind (or gone); wait for it to drain
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!hasRoom(head, frame)) {
+        if (peerClosed() || Clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+void Channel::writeFrame(uint64_t head, const char* data, size_t size) {
+    uint32_t length = static_cast<uint32_t>(size);
+    char* buffer = ringData(outRing());
+    copyIn(buffer, m_ringBytes, head, &length, sizeof(length));
+    copyIn(buffer, m_ringBytes, head + sizeof(length), data, size);
+}
+
+void Channel::publish(uint64_t head) {
+    RingControl& ring = m_segment->rings[outRing()];
+    // seq_cst pairs with the reader's store to sleeping, so one of us sees the other
+    ring.head.store(head);
+    if (ring.sleeping.load()) {
+        ring.signal.fetch_add(1);
+        wake(ring.signal);
+    }
+}
+
+bool Channel::receive(std::string& message) {
+    if (!m_segment) {
+        return false;
+    }
+    RingControl& ring = m_segment->rings[inRing()];
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    const char* buffer = ringData(inRing());
+    uint32_t length = 0;
+    copyOut(buffer, m_ringBytes, tail, &length, sizeof(length));
+    if (frameBytes(length) > head - tail) {
+        markClosed(); // Corrupt ring: nothing after this can be trusted
+        return false;
+    }
+    message.resize(length);
+    copyOut(buffer, m_ringBytes, tail + sizeof(length), &message[0], length);
+    ring.tail.store(tail + frameBytes(length), std::memory_order_release);
+    return true;
+}
+
+void Channel::waitReadable(WaitMode mode, int spinUs, int timeoutMs) {
+    if (!m_segment) {
+        return;
+    }
+    RingControl& ring = m_segment->rings[inRing()];
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    Clock::time_point start = Clock::now();
+    Clock::time_point spinUntil = start + (mode == Spin ? std::chrono::microseconds(timeoutMs * 1000LL)
+                                                        : std::chrono::microseconds(spinUs));
+    for (unsigned i = 0;; ++i) {
+        if (ring.head.load(std::memory_order_acquire) != tail) {
+            return;
+        }
+        if ((i & 255) == 0 && Clock::now() >= spinUntil) {
+            break;
+        }
+        cpuRelax();
+    }
+    if (mode == Spin) {
+        return;
+    }
+
+    uint32_t signal = ring.signal.load();
+    ring.sleeping.store(1);
+    if (ring.head.load() == tail && !closed() && !peerClosed()) {
+        sleepOn(ring.signal, signal, timeoutMs);
+    }
+    ring.sleeping.store(0);
+}
+
+} // namespace ShmTransport
@@ -0,0 +1,82 @@
+//
+// ShmTransport.h
+// HFT
+//
+#ifndef SHM_TRANSPORT_H
+#define SHM_TRANSPORT_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// Same-host byte transport for one FIX session: a POSIX shared-memory segment with
+// two single-producer/single-consumer rings, initiator->acceptor and acceptor->initiator.
+// Messages are length-prefixed frames; a ring is written only by one side's session
+// (QuickFIX serialises a session's sends) and read only by the other side's reader.
+//
+// The acceptor creates the segment; one initiator at a time claims it. The acceptor
+// resets the rings and marks it connected; from then on either side may close it.
+// The segment is free for the next initiator once both sides have closed (or the
+// initiator's process is gone).
+//
+// A reader that finds its ring empty either keeps polling (Spin) or, after spinning
+// for a while, sleeps on a futex in the ring that the writer bumps (Futex).
+namespace ShmTransport {
+
+enum WaitMode { Futex, Spin };
+
+struct Segment; // ShmTransport.cpp
+
+class Channel {
+public:
+    Channel();
+    ~Channel();
+
+    // Acceptor: creates name (replacing a stale segment) with ringBytes per direction
+    bool create(const std::string& name, size_t ringBytes, std::string& error);
+    // Initiator: maps name and claims it, waiting up to timeoutMs for the acceptor to
+    // accept; false when there is no acceptor, it is busy or it did not answer
+    bool claim(const std::string& name, int timeoutMs, std::string& error);
+    void close(); // Unmaps; the acceptor also removes the name
+
+    // Acceptor side, from its reader thread
+    bool claimed();  // An initiator is waiting to be accepted
+    void accept();   // Resets both rings and marks the segment connected
+    void reject();   // Turns a claim away
+    void release();  // Both sides have closed: free for the next initiator
+
+    void markClosed(); // This side stops using the rings; wakes both readers
+    bool closed() const;
+    bool peerClosed() const; // The peer closed, or its process is gone
+
+    // Any one thread at a time; false when closed or the peer did not drain
+    // the ring within timeoutMs
+    bool send(const char* data, size_t size, int timeoutMs);
+    // count messages in one go: the peer is shown them together and woken once. If the
+    // ring fills part way, what is written so far is published before waiting.
+    bool send(const std::string* messages, size_t count, int timeoutMs);
+    // Reader thread; false when nothing is waiting
+    bool receive(std::string& message);
+    // Reader thread: returns when a message may be waiting, after timeoutMs at most
+    void waitReadable(WaitMode mode, int spinUs, int timeoutMs);
+
+private:
+    unsigned outRing() const { return m_acceptor ? 1 : 0; }
+    unsigned inRing() const { return m_acceptor ? 0 : 1; }
+    char* ringData(unsigned ring) const;
+    bool hasRoom(uint64_t head, uint64_t frame) const;                  // In the out ring
+    bool waitForRoom(uint64_t head, uint64_t frame, int timeoutMs) const;
+    void writeFrame(uint64_t head, const char* data, size_t size);     // Not yet visible to the peer
+    void publish(uint64_t head);                                        // Shows the peer up to head
+    int32_t peerPid() const;
+
+    Segment* m_segment;
+    size_t m_mappedBytes;
+    size_t m_ringBytes;
+    bool m_acceptor;
+    std::string m_name;
+};
+
+} // namespace ShmTransport
+
+#endif // SHM_TRANSPORT_H
@@ -0,0 +1,181 @@
+// src/SignalKernel.cpp
+#include "SignalKernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIGNAL_KERNEL_X86 1
+#endif
+
+namespace {
+
+// Nudges values that land a hair below/above a tick boundary onto it (169.98 / 0.01 = 16997.999...)
+const double kTickEpsilon = 1e-9;
+
+void computeScalar(const SignalKernel::Columns& c, const SignalKernel::Params& p) {
+    const double invTick = 1.0 / p.tickSize;
+    for (size_t i = 0; i < c.paddedCount; ++i) {
+        double prev = c.prevMid[i];
+        double updated = c.updated[i];
+        // Only fold in a return when there was a previous mid to measure it from
+        double weight = prev > 0.0 ? updated : 0.0;
+        double move = c.mid[i] - prev;
+        double variance = c.variance[i] + weight * p.ewmaAlpha * (move * move - c.variance[i]);
+        c.variance[i] = variance;
+        c.prevMid[i] = prev + updated * (c.mid[i] - prev);
+        c.updated[i] = 0.0;
+
+        double halfWidth = std::max(p.baseHalfSpread, 0.5 * c.marketSpread[i]) + p.volMultiplier * std::sqrt(variance);
+        double fair = c.mid[i] - p.skewPerUnit * c.inventory[i];
+        c.bid[i] = std::floor((fair - halfWidth) * invTick + kTickEpsilon) * p.tickSize;
+        c.ask[i] = std::ceil((fair + halfWidth) * invTick - kTickEpsilon) * p.tickSize;
+    }
+}
+
+#ifdef SIGNAL_KERNEL_X86
+
+__attribute__((target("avx2,fma")))
+void computeAvx2(const SignalKernel::Columns& c, const SignalKernel::Params& p) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d alpha = _mm256_set1_pd(p.ewmaAlpha);
+    const __m256d baseHalfSpread = _mm256_set1_pd(p.baseHalfSpread);
+    const __m256d volMultiplier = _mm256_set1_pd(p.volMultiplier);
+    const __m256d skew = _mm256_set1_pd(p.skewPerUnit);
+    const __m256d tick = _mm256_set1_pd(p.tickSize);
+    const __m256d invTick = _mm256_set1_pd(1.0 / p.tickSize);
+    const __m256d epsilon = _mm256_set1_pd(kTickEpsilon);
+
+    for (size_t i = 0; i < c.paddedCount; i += 4) {
+        __m256d mid = _mm256_loadu_pd(c.mid + i);
+        __m256d prev = _mm256_loadu_pd(c.prevMid + i);
+        __m256d updated = _mm256_loadu_pd(c.updated + i);
+        __m256d variance = _mm256_loadu_pd(c.variance + i);
+
+        __m256d weight = _mm256_and_pd(updated, _mm256_cmp_pd(prev, zero, _CMP_GT_OQ));
+        __m256d move = _mm256_sub_pd(mid, prev);
+        __m256d innovation = _mm256_fmsub_pd(move, move, variance);
+        variance = _mm256_fmadd_pd(_mm256_mul_pd(weight, alpha), innovation, variance);
+        _mm256_storeu_pd(c.variance + i, variance);
+        _mm256_storeu_pd(c.prevMid + i, _mm256_fmadd_pd(updated, move, prev));
+        _mm256_storeu_pd(c.updated + i, zero);
+
+        __m256d marketHalf = _mm256_mul_pd(half, _mm256_loadu_pd(c.marketSpread + i));
+        __m256d halfWidth = _mm256_fmadd_pd(volMultiplier, _mm256_sqrt_pd(variance),
+                                            _mm256_max_pd(baseHalfSpread, marketHalf));
+        __m256d fair = _mm256_fnmadd_pd(skew, _mm256_loadu_pd(c.inventory + i), mid);
+
+        __m256d bidTicks = _mm256_fmadd_pd(_mm256_sub_pd(fair, halfWidth), invTick, epsilon);
+        __m256d askTicks = _mm256_fmsub_pd(_mm256_add_pd(fair, halfWidth), invTick, epsilon);
+        _mm256_storeu_pd(c.bid + i, _mm256_mul_pd(_mm256_floor_pd(bidTicks), tick));
+        _mm256_storeu_pd(c.ask + i, _mm256_mul_pd(_mm256_ceil_pd(askTicks), tick));
+    }
+}
+
+__attribute__((target("avx512f")))
+void computeAvx512(const SignalKernel::Columns& c, const SignalKernel::Params& p) {
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d half = _mm512_set1_pd(0.5);
+    const __m512d alpha = _mm512_set1_pd(p.ewmaAlpha);
+    const __m512d baseHalfSpread = _mm512_set1_pd(p.baseHalfSpread);
+    const __m512d volMultiplier = _mm512_set1_pd(p.volMultiplier);
+    const __m512d skew = _mm512_set1_pd(p.skewPerUnit);
+    const __m512d tick = _mm512_set1_pd(p.tickSize);
+    const __m512d invTick = _mm512_set1_pd(1.0 / p.tickSize);
+    const __m512d epsilon = _mm512_set1_pd(kTickEpsilon);
+
+    for (size_t i = 0; i < c.paddedCount; i += 8) {
+        __m512d mid = _mm512_loadu_pd(c.mid + i);
+        __m512d prev = _mm512_loadu_pd(c.prevMid + i);
+        __m512d updated = _mm512_loadu_pd(c.updated + i);
+        __m512d variance = _mm512_loadu_pd(c.variance + i);
+
+        __mmask8 hasPrev = _mm512_cmp_pd_mask(prev, zero, _CMP_GT_OQ);
+        __m512d weight = _mm512_maskz_mov_pd(hasPrev, updated);
+        __m512d move = _mm512_sub_pd(mid, prev);
+        __m512d innovation = _mm512_fmsub_pd(move, move, variance);
+        variance = _mm512_fmadd_pd(_mm512_mul_pd(weight, alpha), innovation, variance);
+        _mm512_storeu_pd(c.variance + i, variance);
+        _mm512_storeu_pd(c.prevMid + i, _mm512_fmadd_pd(updated, move, prev));
+        _mm512_storeu_pd(c.updated + i, zero);
+
+        __m512d marketHalf = _mm512_mul_pd(half, _mm512_loadu_pd(c.marketSpread + i));
+        __m512d halfWidth = _mm512_fmadd_pd(volMultiplier, _mm512_sqrt_pd(variance),
+                                            _mm512_max_pd(baseHalfSpread, marketHalf));
+        __m512d fair = _mm512_fnmadd_pd(skew, _mm512_loadu_pd(c.inventory + i), mid);
+
+        __m512d bidTicks = _mm512_fmadd_pd(_mm512_sub_pd(fair, halfWidth), invTick, epsilon);
+        __m512d askTicks = _mm512_fmsub_pd(_mm512_add_pd(fair, halfWidth), invTick, epsilon);
+        _mm512_storeu_pd(c.bid + i, _mm512_mul_pd(_mm512_roundscale_pd(bidTicks, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC), tick));
+        _mm512_storeu_pd(c.ask + i, _mm512_mul_pd(_mm512_roundscale_pd(askTicks, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC), tick));
+    }
+}
+
+#endif // SIGNAL_KERNEL_X86
+
+} // namespace
+
+SignalKernel::SignalKernel(size_t instrumentCount)
+    : m_count(0), m_kernel(computeScalar), m_implementationName("scalar")
+{
+#ifdef SIGNAL_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        m_kernel = computeAvx512;
+        m_implementationName = "avx512";
+    } else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        m_kernel = computeAvx2;
+        m_implementationName = "avx2";
+    }
+#endif
+    resize(instrumentCount);
+}
+
+void SignalKernel::resize(size_t instrumentCount) {
+    m_count = instrumentCount;
+    size_t padded = (instrumentCount + 7) & ~static_cast<size_t>(7);
+    m_mid.assign(padded, 0.0);
+    m_prevMid.assign(padded, 0.0);
+    m_marketSpread.assign(padded, 0.0);
+    m_variance.assign(padded, 0.0);
+    m_inventory.assign(padded, 0.0);
+    m_updated.assign(padded, 0.0);
+    m_bid.assign(padded, 0.0);
+    m_ask.assign(padded, 0.0);
+}
+
+void SignalKernel::relocate() {
+    std::vector<double>* columns[] = { &m_mid, &m_prevMid, &m_marketSpread, &m_variance,
+                                       &m_inventory, &m_updated, &m_bid, &m_ask };
+    for (std::vector<double>* column : columns) {
+        std::vector<double> fresh(column->begin(), column->end());
+        column->swap(fresh);
+    }
+}
+
+void SignalKernel::clearInventories() {
+    std::fill(m_inventory.begin(), m_inventory.end(), 0.0);
+}
+
+double SignalKernel::volatility(size_t index) const {
+    return std::sqrt(m_variance[index]);
+}
+
+void SignalKernel::compute(const Params& params) {
+    if (m_mid.empty()) {
+        return;
+    }
+    Columns columns;
+    columns.mid = m_mid.data();
+    columns.prevMid = m_prevMid.data();
+    columns.marketSpread = m_marketSpread.data();
+    columns.variance = m_variance.data();
+    columns.inventory = m_inventory.data();
+    columns.updated = m_updated.data();
+    columns.bid = m_bid.data();
+    columns.ask = m_ask.data();
+    columns.paddedCount = m_mid.size();
+    m_kernel(columns, params);
+}
@@ -0,0 +1,93 @@
+//
+// SignalKernel.h
+// HFT
+//
+#ifndef SIGNAL_KERNEL_H
+#define SIGNAL_KERNEL_H
+
+#include <vector>
+#include <cstddef>
+
+// Vectorised quote computation over structure-of-arrays state for every instrument.
+//
+// Per instrument, one compute() pass does:
+//   variance  = EWMA of squared mid-to-mid moves (only where a new mid arrived)
+//   halfWidth = max(baseHalfSpread, marketSpread / 2) + volMultiplier * sqrt(variance)
+//   fair      = mid - skewPerUnit * inventory
+//   bid / ask = fair -/+ halfWidth, floored / ceiled to the tick grid
+//
+// The best implementation for the CPU (AVX-512, AVX2 or scalar) is picked once at
+// construction. Columns are padded to a multiple of 8 so the vector loops have no tail.
+class SignalKernel {
+public:
+    struct Params {
+        double baseHalfSpread;
+        double skewPerUnit;   // Price shift per unit of inventory (long inventory lowers quotes)
+        double volMultiplier;
+        double ewmaAlpha;
+        double tickSize;
+
+        Params() : baseHalfSpread(0.02), skewPerUnit(0.0001), volMultiplier(1.0),
+                   ewmaAlpha(0.05), tickSize(0.01) {}
+    };
+
+    explicit SignalKernel(size_t instrumentCount = 0);
+
+    void resize(size_t instrumentCount);
+    size_t size() const { return m_count; }
+    // Copies the columns into fresh memory first touched by the calling thread, so
+    // they land on that thread's NUMA node (large columns only: small ones come
+    // from recycled malloc memory). State is preserved.
+    void relocate();
+
+    // Scalar setters used while draining market data / positions
+    void setMarket(size_t index, double mid, double marketSpread) {
+        m_mid[index] = mid;
+        m_marketSpread[index] = marketSpread;
+        m_updated[index] = 1.0;
+    }
+    void setInventory(size_t index, double inventory) { m_inventory[index] = inventory; }
+    void clearInventories();
+
+    // One pass over every instrument
+    void compute(const Params& params);
+
+    double bid(size_t index) const { return m_bid[index]; }
+    double ask(size_t index) const { return m_ask[index]; }
+    double mid(size_t index) const { return m_mid[index]; }
+    double volatility(size_t index) const;
+
+    // "avx512", "avx2" or "scalar"
+    const char* implementation() const { return m_implementationName; }
+
+    // Column view handed to the ISA-specific loops
+    struct Columns {
+        double* mid;
+        double* prevMid;
+        double* marketSpread;
+        double* variance;
+        double* inventory;
+        double* updated;
+        double* bid;
+        double* ask;
+        size_t paddedCount;
+    };
+
+    typedef void (*KernelFn)(const Columns& columns, const Params& params);
+
+private:
+    size_t m_count;
+    std::vector<double> m_mid;
+    std::vector<double> m_prevMid;
+    std::vector<double> m_marketSpread;
+    std::vector<double> m_variance;
+    std::vector<double> m_inventory;
+    std::vector<double> m_updated; // 1.0 where a new mid arrived since the last pass
+    std::vector<double> m_bid;
+    std::vector<double> m_ask;
+
+    KernelFn m_kernel;
+    const char* m_implementationName;
+};
+
+#endif // SIGNAL_KERNEL_H
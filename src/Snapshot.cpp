@@ -0,0 +1,388 @@
+// src/Snapshot.cpp
+#include "Snapshot.h"
+#include "Metrics.h"
+#include "ThreadTopology.h"
+
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+int64_t wallClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void copySymbol(char (&dest)[16], const std::string& symbol) {
+    std::memset(dest, 0, sizeof(dest));
+    std::strncpy(dest, symbol.c_str(), sizeof(dest) - 1);
+}
+
+bool writeAll(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, p, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// A rename is only durable once the directory holding it is synced
+bool syncDirectoryOf(const std::string& path) {
+    std::string::size_type slash = path.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+} // namespace
+
+// --- FillJournal ---
+
+FillJournal::FillJournal(const std::string& path)
+    : m_path(path), m_fd(-1), m_sequence(0)
+{
+    // The journal normally sits next to the snapshots; make sure the directory exists
+    std::string::size_type slash = path.rfind('/');
+    if (slash != std::string::npos) {
+        ::mkdir(path.substr(0, slash).c_str(), 0755);
+    }
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (m_fd < 0) {
+        std::cerr << "FillJournal: Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+
+    // Continue numbering after the last complete record
+    struct stat st;
+    if (::fstat(m_fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(Record))) {
+        off_t lastOffset = (st.st_size / sizeof(Record) - 1) * sizeof(Record);
+        Record last;
+        if (::pread(m_fd, &last, sizeof(last), lastOffset) == static_cast<ssize_t>(sizeof(last))) {
+            m_sequence = last.sequence;
+        }
+    }
+}
+
+FillJournal::~FillJournal() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+void FillJournal::append(const std::string& symbol, long long qtyDelta, double price) {
+    if (m_fd < 0) {
+        return;
+    }
+    Record record;
+    record.sequence = m_sequence.load() + 1;
+    copySymbol(record.symbol, symbol);
+    record.qtyDelta = qtyDelta;
+    record.price = price;
+    record.timestampNs = wallClockNs();
+
+    // A single small O_APPEND write lands in the page cache atomically; no fsync on the fill path
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    if (writeAll(m_fd, &record, sizeof(record))) {
+        m_sequence = record.sequence;
+    } else {
+        std::cerr << "FillJournal: Write failed: " << std::strerror(errno) << std::endl;
+    }
+}
+
+size_t FillJournal::replay(unsigned long long afterSequence, StrategyEngine& engine) {
+    if (m_fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Record))) {
+        return 0;
+    }
+
+    size_t count = st.st_size / sizeof(Record); // A torn trailing record is ignored
+    void* mapped = ::mmap(nullptr, count * sizeof(Record), PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "FillJournal: mmap failed: " << std::strerror(errno) << std::endl;
+        return 0;
+    }
+
+    const Record* records = static_cast<const Record*>(mapped);
+    size_t replayed = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (records[i].sequence > afterSequence) {
+            engine.applyFill(SnapshotFormat::readSymbol(records[i].symbol), records[i].qtyDelta, records[i].price);
+            continueAfter(records[i].sequence);
+            ++replayed;
+        }
+    }
+    ::munmap(mapped, count * sizeof(Record));
+    return replayed;
+}
+
+void FillJournal::continueAfter(unsigned long long sequence) {
+    unsigned long long current = m_sequence.load();
+    while (current < sequence && !m_sequence.compare_exchange_weak(current, sequence)) {
+    }
+}
+
+void FillJournal::truncateThrough(unsigned long long sequence) {
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    if (m_fd < 0) {
+        return;
+    }
+    // Usually no fill landed since the snapshot copied its positions out
+    if (m_sequence.load() <= sequence) {
+        if (::ftruncate(m_fd, 0) != 0) {
+            std::cerr << "FillJournal: Truncate failed: " << std::strerror(errno) << std::endl;
+        }
+        return;
+    }
+
+    // Otherwise rewrite the newer records into a fresh file and swap it in
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0) {
+        std::cerr << "FillJournal: fstat failed: " << std::strerror(errno) << std::endl;
+        return;
+    }
+    std::vector<Record> records(st.st_size / sizeof(Record)); // A torn trailing record is dropped
+    size_t bytes = records.size() * sizeof(Record);
+    if (!records.empty() && ::pread(m_fd, records.data(), bytes, 0) != static_cast<ssize_t>(bytes)) {
+        std::cerr << "FillJournal: Read failed: " << std::strerror(errno) << std::endl;
+        return;
+    }
+
+    std::string tmpPath = m_path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0) {
+        std::cerr << "FillJournal: Cannot open " << tmpPath << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    bool ok = true;
+    for (const Record& record : records) {
+        if (record.sequence > sequence) {
+            ok = ok && writeAll(fd, &record, sizeof(record));
+        }
+    }
+    // The kept records must be on disk before the rename makes them the journal
+    ok = ok && ::fsync(fd) == 0;
+    if (!ok || ::rename(tmpPath.c_str(), m_path.c_str()) != 0) {
+        std::cerr << "FillJournal: Cannot rotate " << m_path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        ::unlink(tmpPath.c_str());
+        return;
+    }
+    if (!syncDirectoryOf(m_path)) {
+        std::cerr << "FillJournal: Cannot sync the directory of " << m_path << ": " << std::strerror(errno) << std::endl;
+    }
+    ::close(m_fd);
+    m_fd = fd;
+}
+
+// --- SnapshotManager ---
+
+SnapshotManager::SnapshotManager(OrderBook* orderBook, StrategyEngine* strategyEngine, FillJournal* journal,
+                                 const std::string& directory, int intervalMs, int maxBookAgeSec)
+    : m_orderBook(orderBook), m_strategyEngine(strategyEngine), m_journal(journal),
+      m_directory(directory), m_intervalMs(intervalMs), m_maxBookAgeSec(maxBookAgeSec),
+      m_running(false)
+{
+    ::mkdir(m_directory.c_str(), 0755); // EEXIST is fine
+}
+
+SnapshotManager::~SnapshotManager() {
+    stop();
+}
+
+bool SnapshotManager::restore() {
+    auto started = std::chrono::steady_clock::now();
+
+    int fd = ::open(latestPath().c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cout << "SnapshotManager: No snapshot at " << latestPath() << ", cold start." << std::endl;
+        if (m_journal && m_strategyEngine) {
+            size_t replayed = m_journal->replay(0, *m_strategyEngine);
+            std::cout << "SnapshotManager: Replayed " << replayed << " journal records." << std::endl;
+        }
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+        std::cerr << "SnapshotManager: Snapshot too small, ignoring." << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "SnapshotManager: mmap failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    const char* base = static_cast<const char*>(mapped);
+    const Header* header = reinterpret_cast<const Header*>(base);
+    size_t expected = sizeof(Header) + header->symbolCount * sizeof(SymbolRecord)
+                    + header->positionCount * sizeof(PositionRecord);
+    if (std::memcmp(header->magic, SnapshotFormat::kMagic, sizeof(SnapshotFormat::kMagic)) != 0 ||
+        header->version != SnapshotFormat::kVersion || expected != size) {
+        std::cerr << "SnapshotManager: Snapshot header invalid, ignoring." << std::endl;
+        ::munmap(mapped, size);
+        return false;
+    }
+
+    const SymbolRecord* symbols = reinterpret_cast<const SymbolRecord*>(base + sizeof(Header));
+    const PositionRecord* positions = reinterpret_cast<const PositionRecord*>(symbols + header->symbolCount);
+
+    // A stale book is worse than none: quoting off hour-old prices would be filled instantly
+    double ageSec = (wallClockNs() - header->takenAtNs) / 1e9;
+    if (m_orderBook && (m_maxBookAgeSec <= 0 || ageSec <= m_maxBookAgeSec)) {
+        for (uint32_t i = 0; i < header->symbolCount; ++i) {
+            OrderBook::MarketData data;
+            data.bid = symbols[i].bid;
+            data.ask = symbols[i].ask;
+            data.mid = symbols[i].mid;
+            m_orderBook->restore(SnapshotFormat::readSymbol(symbols[i].symbol), data);
+        }
+    } else if (m_orderBook) {
+        std::cout << "SnapshotManager: Book snapshot is " << ageSec << "s old, waiting for the feed instead." << std::endl;
+    }
+
+    size_t replayed = 0;
+    if (m_strategyEngine) {
+        StrategyEngine::StateSnapshot state;
+        for (uint32_t i = 0; i < header->positionCount; ++i) {
+            StrategyEngine::Position& position = state.positions[SnapshotFormat::readSymbol(positions[i].symbol)];
+            position.qty = positions[i].qty;
+            position.cashFlow = positions[i].cashFlow;
+        }
+        state.idEpoch = header->idEpoch;
+        m_strategyEngine->restoreState(state);
+
+        if (m_journal) {
+            replayed = m_journal->replay(header->journalSequence, *m_strategyEngine);
+            // The journal may hold none of the records the snapshot covers; never reuse their numbers
+            m_journal->continueAfter(header->journalSequence);
+        }
+    }
+
+    uint32_t symbolCount = header->symbolCount;
+    uint32_t positionCount = header->positionCount;
+    ::munmap(mapped, size);
+
+    auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    std::cout << "SnapshotManager: Restored " << symbolCount << " symbols, " << positionCount
+              << " positions and " << replayed << " journal records in " << elapsedUs << "us." << std::endl;
+    return true;
+}
+
+bool SnapshotManager::takeSnapshot() {
+    // Copy-out phase: the only part that touches locks shared with hot threads
+    std::map<std::string, OrderBook::MarketData> book;
+    if (m_orderBook) {
+        book = m_orderBook->snapshot();
+    }
+    StrategyEngine::StateSnapshot state;
+    if (m_strategyEngine) {
+        state = m_strategyEngine->snapshotState();
+    }
+
+    Header header;
+    std::memcpy(header.magic, SnapshotFormat::kMagic, sizeof(SnapshotFormat::kMagic));
+    header.version = SnapshotFormat::kVersion;
+    header.symbolCount = static_cast<uint32_t>(book.size());
+    header.positionCount = static_cast<uint32_t>(state.positions.size());
+    header.reserved = 0;
+    header.takenAtNs = wallClockNs();
+    header.journalSequence = state.journalSequence;
+    header.idEpoch = state.idEpoch;
+
+    std::string tmpPath = latestPath() + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "SnapshotManager: Cannot open " << tmpPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    bool ok = writeAll(fd, &header, sizeof(header));
+    for (const auto& entry : book) {
+        SymbolRecord record;
+        copySymbol(record.symbol, entry.first);
+        record.bid = entry.second.bid;
+        record.ask = entry.second.ask;
+        record.mid = entry.second.mid;
+        ok = ok && writeAll(fd, &record, sizeof(record));
+    }
+    for (const auto& entry : state.positions) {
+        PositionRecord record;
+        copySymbol(record.symbol, entry.first);
+        record.qty = entry.second.qty;
+        record.cashFlow = entry.second.cashFlow;
+        ok = ok && writeAll(fd, &record, sizeof(record));
+    }
+    ok = ok && ::fsync(fd) == 0;
+    ::close(fd);
+
+    if (!ok || ::rename(tmpPath.c_str(), latestPath().c_str()) != 0) {
+        std::cerr << "SnapshotManager: Failed to write snapshot: " << std::strerror(errno) << std::endl;
+        ::unlink(tmpPath.c_str());
+        return false; // The journal keeps everything since the last snapshot that was written
+    }
+    if (!syncDirectoryOf(latestPath())) {
+        // A crash could still bring back the previous snapshot, which needs the journal
+        std::cerr << "SnapshotManager: Cannot sync the snapshot directory: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    Metrics::increment(Metrics::SnapshotsTaken);
+    if (m_journal) {
+        m_journal->truncateThrough(header.journalSequence);
+    }
+    return true;
+}
+
+void SnapshotManager::start() {
+    if (m_running.exchange(true)) {
+        return;
+    }
+    m_snapshotThread = std::thread([this]() {
+        ThreadTopology::apply(ThreadTopology::Background);
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        while (m_running) {
+            m_wakeCond.wait_for(lock, std::chrono::milliseconds(m_intervalMs));
+            if (!m_running) break;
+            lock.unlock();
+            takeSnapshot();
+            lock.lock();
+        }
+    });
+}
+
+void SnapshotManager::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    m_wakeCond.notify_all();
+    if (m_snapshotThread.joinable()) {
+        m_snapshotThread.join();
+    }
+    takeSnapshot(); // Final snapshot so a clean restart needs no journal replay
+}
@@ -0,0 +1,98 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "OrderBook.h"
+#include "StrategyEngine.h"
+#include "SnapshotFormat.h"
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+// Append-only journal of fills. Positions between two snapshots are rebuilt
+// from the journal tail, so a crash loses nothing that was already filled.
+// Each snapshot drops the records it covers, so the file only holds the fills
+// since the last one.
+class FillJournal {
+public:
+    // Fixed-size on-disk record; the file is a plain array of these
+    struct Record {
+        uint64_t sequence;
+        char symbol[16];
+        int64_t qtyDelta;
+        double price;
+        int64_t timestampNs;
+    };
+
+    explicit FillJournal(const std::string& path);
+    ~FillJournal();
+
+    bool isOpen() const { return m_fd >= 0; }
+
+    // Caller serialises appends (StrategyEngine holds its position lock)
+    void append(const std::string& symbol, long long qtyDelta, double price);
+    unsigned long long lastSequence() const { return m_sequence.load(); }
+
+    // Applies every record newer than afterSequence to the engine, returns the count
+    size_t replay(unsigned long long afterSequence, StrategyEngine& engine);
+
+    // Numbers the next record after `sequence` at the earliest. A restored snapshot
+    // may cover more records than the journal still holds.
+    void continueAfter(unsigned long long sequence);
+
+    // Drops the records a snapshot covers (sequence and below) and keeps any newer
+    // ones, which may be appended concurrently; sequence numbers keep counting
+    void truncateThrough(unsigned long long sequence);
+
+private:
+    std::string m_path;
+    int m_fd;
+    std::atomic<unsigned long long> m_sequence;
+    std::mutex m_fileMutex; // Appends against truncateThrough swapping the file
+};
+
+// Periodically persists book, positions and the ID epoch, and restores them on startup.
+// State is copied out under the owners' locks (a few hundred bytes per symbol) and
+// serialised on the snapshot thread, so feed, FIX and quoting threads never wait on disk.
+class SnapshotManager {
+public:
+    SnapshotManager(OrderBook* orderBook, StrategyEngine* strategyEngine, FillJournal* journal,
+                    const std::string& directory, int intervalMs, int maxBookAgeSec);
+    ~SnapshotManager();
+
+    // Maps the latest snapshot, seeds OrderBook and StrategyEngine, then replays the
+    // journal tail. Returns false if there was nothing usable to restore.
+    bool restore();
+
+    // Writes one snapshot (temp file + rename, so readers never see a torn file) and
+    // syncs it and its directory; only then drops the journal records it covers
+    bool takeSnapshot();
+
+    void start();
+    void stop();
+
+private:
+    // File layout, see SnapshotFormat.h
+    typedef SnapshotFormat::Header Header;
+    typedef SnapshotFormat::SymbolRecord SymbolRecord;
+    typedef SnapshotFormat::PositionRecord PositionRecord;
+
+    std::string latestPath() const { return m_directory + "/latest.snap"; }
+
+    OrderBook* m_orderBook;
+    StrategyEngine* m_strategyEngine;
+    FillJournal* m_journal;
+    std::string m_directory;
+    int m_intervalMs;
+    int m_maxBookAgeSec;
+
+    std::atomic<bool> m_running;
+    std::thread m_snapshotThread;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCond;
+};
+
+#endif // SNAPSHOT_H
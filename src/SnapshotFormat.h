@@ -0,0 +1,72 @@
+//
+// SnapshotFormat.h
+// HFT
+//
+#ifndef SNAPSHOT_FORMAT_H
+#define SNAPSHOT_FORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// On-disk layout of SnapshotManager's latest.snap: a Header, then symbolCount
+// SymbolRecords, then positionCount PositionRecords. Shared with tools that read
+// snapshots from outside the market maker (soak_client).
+namespace SnapshotFormat {
+
+const char kMagic[8] = {'M', 'M', 'S', 'N', 'A', 'P', '0', '2'};
+const uint32_t kVersion = 2;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t symbolCount;
+    uint32_t positionCount;
+    uint32_t reserved;
+    int64_t takenAtNs;       // System clock
+    uint64_t journalSequence;
+    uint64_t idEpoch;
+};
+
+struct SymbolRecord {
+    char symbol[16];
+    double bid;
+    double ask;
+    double mid;
+};
+
+struct PositionRecord {
+    char symbol[16];
+    int64_t qty;
+    double cashFlow;
+};
+
+inline std::string readSymbol(const char (&src)[16]) {
+    return std::string(src, strnlen(src, sizeof(src)));
+}
+
+// Whole-file read for tools; SnapshotManager::restore() maps the file instead
+struct Contents {
+    Header header;
+    std::vector<SymbolRecord> symbols;
+    std::vector<PositionRecord> positions;
+};
+
+inline bool read(const std::string& path, Contents& contents) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in.read(reinterpret_cast<char*>(&contents.header), sizeof(Header)) ||
+        std::memcmp(contents.header.magic, kMagic, sizeof(kMagic)) != 0 || contents.header.version != kVersion) {
+        return false;
+    }
+    contents.symbols.resize(contents.header.symbolCount);
+    contents.positions.resize(contents.header.positionCount);
+    in.read(reinterpret_cast<char*>(contents.symbols.data()), contents.symbols.size() * sizeof(SymbolRecord));
+    in.read(reinterpret_cast<char*>(contents.positions.data()), contents.positions.size() * sizeof(PositionRecord));
+    return static_cast<bool>(in);
+}
+
+} // namespace SnapshotFormat
+
+#endif // SNAPSHOT_FORMAT_H
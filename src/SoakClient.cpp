@@ -0,0 +1,586 @@
+#include "SoakClient.h"
+#include "StrategyEngine.h" // kMaxClientOrderQty
+
+#include <quickfix/Session.h>
+#include <quickfix/FixFields.h>
+#include <quickfix/fix42/ResendRequest.h>
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+const char* const kSymbols[] = {
+    "AAPL", "MSFT", "GOOG", "AMZN", "NVDA", "TSLA", "META", "NFLX", "ADBE", "CRM"
+};
+const size_t kSymbolCount = sizeof(kSymbols) / sizeof(kSymbols[0]);
+const size_t kRecentIDs = 64;
+const size_t kMaxPrintedViolations = 50;
+
+uint64_t monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t wallNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+SoakClient::Options::Options() : window(64), rate(0), timeoutMs(5000), seed(1) {
+    weights[Valid] = 70;
+    weights[Invalid] = 12;
+    weights[Duplicate] = 5;
+    weights[Extreme] = 5;
+    weights[Stale] = 6;
+    weights[Resend] = 2;
+}
+
+void SoakClient::Latencies::clear() {
+    count = 0;
+    maxNs = 0;
+    std::fill(buckets, buckets + Metrics::kBuckets, 0);
+}
+
+uint64_t SoakClient::Latencies::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * count));
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < Metrics::kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= rank && buckets[i] != 0) {
+            return std::min(Metrics::bucketUpperBound(i), maxNs);
+        }
+    }
+    return maxNs;
+}
+
+SoakClient::SoakClient(const Options& options)
+    : m_options(options), m_loggedOn(false), m_running(false), m_clOrdIds("SOAK"),
+      m_random(options.seed), m_recentNext(0), m_lastAnswerWallNs(0) {
+    m_stats = Stats();
+    m_recent.reserve(kRecentIDs);
+}
+
+SoakClient::~SoakClient() {
+    stop();
+}
+
+void SoakClient::onCreate(const FIX::SessionID& sessionID) {
+    m_sessionID = sessionID;
+}
+
+void SoakClient::onLogon(const FIX::SessionID& sessionID) {
+    std::cout << "SoakClient: Logged on " << sessionID << std::endl;
+    m_sessionID = sessionID;
+    m_loggedOn = true;
+}
+
+void SoakClient::onLogout(const FIX::SessionID& sessionID) {
+    // Orders in flight are left to time out and show up as violations
+    std::cout << "SoakClient: Logged out " << sessionID << std::endl;
+    m_loggedOn = false;
+}
+
+void SoakClient::toAdmin(FIX::Message& message, const FIX::SessionID& sessionID) {
+}
+
+void SoakClient::toApp(FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::DoNotSend) {
+}
+
+void SoakClient::fromAdmin(const FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::RejectLogon) {
+    FIX::MsgType msgType;
+    message.getHeader().getField(msgType);
+    if (msgType == FIX::MsgType_Reject && message.isSetField(FIX::FIELD::RefSeqNum)) {
+        FIX::RefSeqNum refSeqNum;
+        FIX::Text text;
+        message.getField(refSeqNum);
+        if (message.isSetField(FIX::FIELD::Text)) {
+            message.getField(text);
+        }
+        onSessionReject(refSeqNum.getValue(), text.getValue());
+    }
+}
+
+void SoakClient::fromApp(const FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::UnsupportedMessageType) {
+    FIX::MsgType msgType;
+    message.getHeader().getField(msgType);
+    if (msgType == FIX::MsgType_BusinessMessageReject) {
+        FIX::RefSeqNum refSeqNum(0);
+        FIX::Text text;
+        if (message.isSetField(FIX::FIELD::RefSeqNum)) {
+            message.getField(refSeqNum);
+        }
+        if (message.isSetField(FIX::FIELD::Text)) {
+            message.getField(text);
+        }
+        onSessionReject(refSeqNum.getValue(), text.getValue());
+        return;
+    }
+    crack(message, sessionID);
+}
+
+void SoakClient::onMessage(const FIX42::ExecutionReport& message, const FIX::SessionID& sessionID) {
+    FIX::PossDupFlag possDup(false);
+    if (message.getHeader().isSetField(FIX::FIELD::PossDupFlag)) {
+        message.getHeader().getField(possDup);
+    }
+    if (possDup.getValue()) {
+        // Answered already the first time round; resent because of our ResendRequest
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.possDups;
+        return;
+    }
+
+    FIX::ClOrdID clOrdID;
+    FIX::ExecID execID;
+    FIX::OrdStatus ordStatus;
+    FIX::Symbol symbol;
+    FIX::Side side;
+    FIX::LeavesQty leavesQty;
+    FIX::CumQty cumQty;
+    FIX::LastQty lastQty(0);
+    FIX::LastPx lastPx(0);
+    FIX::Text text;
+    try {
+        message.get(clOrdID);
+        message.get(execID);
+        message.get(ordStatus);
+        message.get(symbol);
+        message.get(side);
+        message.get(leavesQty);
+        message.get(cumQty);
+        if (message.isSetField(FIX::FIELD::LastQty)) {
+            message.getField(lastQty);
+        }
+        if (message.isSetField(FIX::FIELD::LastPx)) {
+            message.getField(lastPx);
+        }
+        if (message.isSetField(FIX::FIELD::Text)) {
+            message.getField(text);
+        }
+    } catch (const FIX::FieldNotFound& e) {
+        violation("ExecutionReport missing field " + std::to_string(e.field));
+        return;
+    }
+
+    std::string problem;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        checkExecID(execID.getValue());
+        auto it = m_pending.find(clOrdID.getValue());
+        if (it == m_pending.end()) {
+            problem = "ExecutionReport for unknown or already answered ClOrdID " + clOrdID.getValue();
+        } else {
+            const Pending& pending = it->second;
+            if (ordStatus == FIX::OrdStatus_FILLED) {
+                double px = lastPx.getValue();
+                long long qty = static_cast<long long>(lastQty.getValue());
+                if (pending.kind == Invalid) {
+                    problem = "invalid order " + clOrdID.getValue() + " was filled";
+                } else if (qty != pending.qty || static_cast<long long>(cumQty.getValue()) != pending.qty ||
+                           leavesQty.getValue() != 0) {
+                    problem = "fill of " + clOrdID.getValue() + " does not add up: LastQty " + std::to_string(qty) +
+                              " CumQty " + std::to_string(cumQty.getValue()) + " LeavesQty " +
+                              std::to_string(leavesQty.getValue()) + " for OrderQty " + std::to_string(pending.qty);
+                } else if (!std::isfinite(px) || px <= 0.0 || px >= 1e7) {
+                    problem = "fill of " + clOrdID.getValue() + " at nonsensical price " + std::to_string(px);
+                } else if (pending.ordType == FIX::OrdType_LIMIT &&
+                           ((pending.side == FIX::Side_BUY && px > pending.price + 1e-9) ||
+                            (pending.side == FIX::Side_SELL && px < pending.price - 1e-9))) {
+                    problem = "fill of " + clOrdID.getValue() + " at " + std::to_string(px) +
+                              " through its limit " + std::to_string(pending.price);
+                } else if (symbol.getValue() != pending.symbol || side.getValue() != pending.side) {
+                    problem = "fill of " + clOrdID.getValue() + " on the wrong symbol or side";
+                } else {
+                    m_positions[pending.symbol] += pending.side == FIX::Side_BUY ? qty : -qty;
+                    std::pair<double, double>& prices = m_prices[pending.symbol];
+                    if (prices.first == 0.0) {
+                        prices.first = prices.second = px; // Nothing better until the first snapshot
+                    }
+                }
+                ++m_stats.fills;
+            } else if (ordStatus == FIX::OrdStatus_REJECTED) {
+                if (text.getValue().empty()) {
+                    problem = "reject of " + clOrdID.getValue() + " carries no Text";
+                }
+                ++m_stats.rejects;
+            } else {
+                problem = "unexpected OrdStatus " + std::string(1, ordStatus.getValue()) + " for " + clOrdID.getValue();
+            }
+            answered(it);
+        }
+    }
+    if (!problem.empty()) {
+        violation(problem);
+    }
+}
+
+void SoakClient::onMessage(const FIX42::OrderCancelReject& message, const FIX::SessionID& sessionID) {
+    violation("OrderCancelReject received, but no cancels were sent");
+}
+
+void SoakClient::start() {
+    if (m_running.exchange(true)) {
+        return;
+    }
+    m_senderThread = std::thread(&SoakClient::run, this);
+}
+
+void SoakClient::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    m_answeredCond.notify_all();
+    if (m_senderThread.joinable()) {
+        m_senderThread.join();
+    }
+}
+
+void SoakClient::setReferencePrices(const std::map<std::string, std::pair<double, double> >& prices) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& entry : prices) {
+        m_prices[entry.first] = entry.second;
+    }
+}
+
+void SoakClient::expireOverdue() {
+    uint64_t cutoff = monotonicNs() - static_cast<uint64_t>(m_options.timeoutMs) * 1000000ULL;
+    std::vector<std::string> expired;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_pending.begin(); it != m_pending.end();) {
+            if (it->second.sentNs < cutoff) {
+                expired.push_back(it->first);
+                m_stats.outstanding -= it->second.copies;
+                it = m_pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (!expired.empty()) {
+        m_answeredCond.notify_all();
+    }
+    for (const std::string& clOrdID : expired) {
+        violation("no answer to " + clOrdID + " within " + std::to_string(m_options.timeoutMs) + "ms");
+    }
+}
+
+bool SoakClient::drain(unsigned timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_answeredCond.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                   [this] { return m_stats.outstanding == 0; });
+}
+
+SoakClient::Stats SoakClient::stats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void SoakClient::takeLatencies(Latencies& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out = m_latencies;
+    m_latencies.clear();
+}
+
+std::map<std::string, long long> SoakClient::positions() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_positions;
+}
+
+void SoakClient::run() {
+    uint64_t intervalNs = m_options.rate > 0 ? 1000000000ULL / m_options.rate : 0;
+    auto nextSend = std::chrono::steady_clock::now();
+    while (m_running) {
+        if (!m_loggedOn) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            nextSend = std::chrono::steady_clock::now();
+            continue;
+        }
+        if (m_options.window > 0) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_answeredCond.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                    return m_stats.outstanding < m_options.window || !m_running; })) {
+                continue;
+            }
+        }
+        if (intervalNs > 0) {
+            nextSend += std::chrono::nanoseconds(intervalNs);
+            std::this_thread::sleep_until(nextSend);
+        }
+        if (m_running) {
+            sendOne();
+        }
+    }
+}
+
+void SoakClient::sendOne() {
+    unsigned total = 0;
+    for (unsigned weight : m_options.weights) {
+        total += weight;
+    }
+    if (total == 0) {
+        return;
+    }
+    unsigned pick = static_cast<unsigned>(m_random() % total);
+    Kind kind = Valid;
+    for (int k = 0; k < KindCount; ++k) {
+        if (pick < m_options.weights[k]) {
+            kind = static_cast<Kind>(k);
+            break;
+        }
+        pick -= m_options.weights[k];
+    }
+
+    if (kind == Resend) {
+        sendResendRequest();
+        return;
+    }
+
+    std::string clOrdID;
+    Pending pending;
+    FIX42::NewOrderSingle order = makeOrder(kind, clOrdID, pending);
+    pending.sentNs = monotonicNs();
+    {
+        // Registered before sending: the answer can arrive before sendToTarget returns
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto inserted = m_pending.insert(std::make_pair(clOrdID, pending));
+        if (!inserted.second) {
+            ++inserted.first->second.copies;
+        }
+        ++m_stats.outstanding;
+        ++m_stats.sent[kind];
+        if (m_recent.size() < kRecentIDs) {
+            m_recent.push_back(std::make_pair(clOrdID, pending));
+        } else {
+            m_recent[m_recentNext] = std::make_pair(clOrdID, pending);
+            m_recentNext = (m_recentNext + 1) % kRecentIDs;
+        }
+    }
+
+    bool sent = false;
+    try {
+        sent = FIX::Session::sendToTarget(order, m_sessionID);
+    } catch (const FIX::SessionNotFound& e) {
+        std::cerr << "SoakClient: Session not found - " << e.what() << std::endl;
+    }
+    if (!sent) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_pending.find(clOrdID);
+        if (it != m_pending.end() && --it->second.copies == 0) {
+            m_pending.erase(it);
+        }
+        --m_stats.outstanding;
+        --m_stats.sent[kind];
+        return;
+    }
+
+    // Session-level rejects only name our MsgSeqNum, which the session filled in on send
+    FIX::MsgSeqNum seqNum;
+    order.getHeader().getField(seqNum);
+    std::string earlyReject;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Answers arrive roughly in order, so entries for answered orders collect at the front
+        while (!m_pendingBySeqNum.empty() && !m_pending.count(m_pendingBySeqNum.begin()->second)) {
+            m_pendingBySeqNum.erase(m_pendingBySeqNum.begin());
+        }
+        m_pendingBySeqNum[seqNum.getValue()] = clOrdID;
+        auto early = m_earlyRejects.find(seqNum.getValue());
+        if (early == m_earlyRejects.end()) {
+            return;
+        }
+        earlyReject = early->second;
+        m_earlyRejects.erase(early);
+    }
+    onSessionReject(seqNum.getValue(), earlyReject);
+}
+
+void SoakClient::sendResendRequest() {
+    FIX::Session* session = FIX::Session::lookupSession(m_sessionID);
+    if (!session) {
+        return;
+    }
+    // Replays the last few reports with PossDupFlag=Y in between live traffic
+    int expected = session->getExpectedTargetNum();
+    FIX42::ResendRequest request(FIX::BeginSeqNo(std::max(1, expected - 20)), FIX::EndSeqNo(0));
+    try {
+        if (FIX::Session::sendToTarget(request, m_sessionID)) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.sent[Resend];
+        }
+    } catch (const FIX::SessionNotFound& e) {
+        std::cerr << "SoakClient: Session not found - " << e.what() << std::endl;
+    }
+}
+
+FIX42::NewOrderSingle SoakClient::makeOrder(Kind kind, std::string& clOrdID, Pending& pending) {
+    pending.kind = kind;
+    pending.symbol = kSymbols[m_random() % kSymbolCount];
+    pending.side = m_random() % 2 ? FIX::Side_BUY : FIX::Side_SELL;
+    pending.ordType = m_random() % 2 ? FIX::OrdType_LIMIT : FIX::OrdType_MARKET;
+    pending.qty = 1 + static_cast<long long>(m_random() % 1000);
+    pending.price = 0.0;
+    pending.defect = DefectCount;
+    pending.copies = 1;
+    clOrdID = m_clOrdIds.next().str();
+
+    bool resubmitted = false;
+    if (kind == Duplicate) {
+        // The same order again under the same ClOrdID, as a client retrying after a timeout would
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_recent.empty()) {
+            const std::pair<std::string, Pending>& recent = m_recent[m_random() % m_recent.size()];
+            clOrdID = recent.first;
+            pending = recent.second;
+            pending.copies = 1;
+            resubmitted = true;
+        }
+    }
+
+    if (!resubmitted && pending.ordType == FIX::OrdType_LIMIT) {
+        std::pair<double, double> prices(0.0, 0.0);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_prices.find(pending.symbol);
+            if (it != m_prices.end()) {
+                prices = it->second;
+            }
+        }
+        if (prices.first > 0.0) {
+            // Within ten cents of the touch: some cross, some don't
+            double offset = (static_cast<int>(m_random() % 21) - 10) * 0.01;
+            double reference = pending.side == FIX::Side_BUY ? prices.second : prices.first;
+            pending.price = std::round((reference + offset) * 100.0) / 100.0;
+        } else {
+            pending.ordType = FIX::OrdType_MARKET;
+        }
+    }
+
+    if (kind == Invalid) {
+        pending.defect = static_cast<Defect>(m_random() % DefectCount);
+        switch (pending.defect) {
+        case ZeroQty: pending.qty = 0; break;
+        case NegativeQty: pending.qty = -pending.qty; break;
+        case HugeQty: pending.qty = 1000000000000LL; break;
+        case BadSide: pending.side = 'Z'; break;
+        case StopOrder: pending.ordType = FIX::OrdType_STOP; pending.price = 100.0; break;
+        case LimitWithoutPrice: pending.ordType = FIX::OrdType_LIMIT; pending.price = 0.0; break;
+        case NegativePrice: pending.ordType = FIX::OrdType_LIMIT; pending.price = -5.0; break;
+        case MissingSymbol: pending.symbol.clear(); break;
+        case UnknownSymbol: pending.symbol = "ZZZZ"; break;
+        default: break;
+        }
+    } else if (kind == Extreme) {
+        pending.ordType = FIX::OrdType_LIMIT;
+        switch (m_random() % 3) {
+        case 0: pending.price = 1e9; break;
+        case 1: pending.price = 1e-6; break;
+        default: pending.price = 1e9; pending.qty = StrategyEngine::kMaxClientOrderQty; break; // Largest accepted
+        }
+    }
+
+    // Stale orders carry a TransactTime a day away from now, either side
+    FIX::UtcTimeStamp transactTime = FIX::UtcTimeStamp::now();
+    if (kind == Stale) {
+        transactTime += m_random() % 2 ? 86400 : -86400; // Seconds
+    }
+
+    FIX42::NewOrderSingle order(
+        FIX::ClOrdID(clOrdID),
+        FIX::HandlInst('1'),
+        FIX::Symbol(pending.symbol),
+        FIX::Side(pending.side),
+        FIX::TransactTime(transactTime),
+        FIX::OrdType(pending.ordType));
+    if (pending.defect == MissingSymbol) {
+        order.removeField(FIX::FIELD::Symbol);
+    }
+    order.set(FIX::OrderQty(static_cast<double>(pending.qty)));
+    if (pending.ordType != FIX::OrdType_MARKET && pending.defect != LimitWithoutPrice) {
+        order.set(FIX::Price(pending.price));
+    }
+    return order;
+}
+
+void SoakClient::answered(std::unordered_map<std::string, Pending>::iterator it) {
+    uint64_t now = monotonicNs();
+    uint64_t latency = now > it->second.sentNs ? now - it->second.sentNs : 0;
+    ++m_latencies.buckets[Metrics::bucketOf(latency)];
+    ++m_latencies.count;
+    m_latencies.maxNs = std::max(m_latencies.maxNs, latency);
+
+    ++m_stats.answered;
+    --m_stats.outstanding;
+    if (--it->second.copies == 0) {
+        m_pending.erase(it);
+    }
+    m_lastAnswerWallNs = wallNs();
+    m_answeredCond.notify_all();
+}
+
+void SoakClient::onSessionReject(int refSeqNum, const std::string& text) {
+    std::string problem;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto bySeqNum = m_pendingBySeqNum.find(refSeqNum);
+        if (bySeqNum == m_pendingBySeqNum.end()) {
+            // Either the sender has not recorded the seqnum yet, or it rejects an admin message
+            m_earlyRejects[refSeqNum] = text;
+            if (m_earlyRejects.size() > 1024) {
+                m_earlyRejects.erase(m_earlyRejects.begin());
+            }
+            return;
+        }
+        std::string clOrdID = bySeqNum->second;
+        m_pendingBySeqNum.erase(bySeqNum);
+        auto it = m_pending.find(clOrdID);
+        if (it == m_pending.end()) {
+            problem = "session reject for already answered order " + clOrdID;
+        } else {
+            if (it->second.kind == Valid || it->second.kind == Stale) {
+                problem = "well-formed order " + clOrdID + " rejected by the session: " + text;
+            }
+            ++m_stats.sessionRejects;
+            answered(it);
+        }
+    }
+    if (!problem.empty()) {
+        violation(problem);
+    }
+}
+
+void SoakClient::violation(const std::string& what) {
+    uint64_t count;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        count = ++m_stats.violations;
+    }
+    if (count <= kMaxPrintedViolations) {
+        std::cerr << "SoakClient: VIOLATION " << what << std::endl;
+    } else if (count == kMaxPrintedViolations + 1) {
+        std::cerr << "SoakClient: Further violations are counted but not printed" << std::endl;
+    }
+}
+
+void SoakClient::checkExecID(const std::string& execID) {
+    // PREFIX-EPOCH-SHARD-SEQ: SEQ must grow within each PREFIX-EPOCH-SHARD
+    size_t dash = execID.rfind('-');
+    if (dash == std::string::npos || dash + 1 == execID.size()) {
+        return; // Not one of ours; nothing to check
+    }
+    uint64_t sequence = std::strtoull(execID.c_str() + dash + 1, nullptr, 10);
+    uint64_t& last = m_lastExecSeq[execID.substr(0, dash)];
+    if (sequence <= last) {
+        ++m_stats.violations;
+        std::cerr << "SoakClient: VIOLATION ExecID " << execID << " repeats or goes backwards" << std::endl;
+    }
+    last = std::max(last, sequence);
+}
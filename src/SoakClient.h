@@ -0,0 +1,159 @@
+//
+// SoakClient.h
+// HFT
+//
+#ifndef SOAK_CLIENT_H
+#define SOAK_CLIENT_H
+
+#include <quickfix/Application.h>
+#include <quickfix/MessageCracker.h>
+#include <quickfix/Message.h>
+#include <quickfix/fix42/NewOrderSingle.h>
+#include <quickfix/fix42/ExecutionReport.h>
+#include <quickfix/fix42/OrderCancelReject.h>
+
+#include "IdGenerator.h"
+#include "Metrics.h" // Bucket layout for the round-trip histogram
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <cstdint>
+
+// Order-entry fuzzer for soak runs against market_maker. A sender thread mixes
+// well-formed orders with invalid, duplicate-ID, extreme-price, stale-timestamp
+// orders and resend requests, and every answer is checked as it arrives:
+//  - each order gets exactly one ExecutionReport or session-level Reject, within the timeout
+//  - reports only name ClOrdIDs we sent; ExecIDs never repeat
+//  - fills are complete, priced sanely and within the limit; invalid orders are never filled
+//  - rejects carry a Text
+// Anything else is a violation. Resent reports (PossDupFlag=Y) are counted, not checked.
+class SoakClient : public FIX::Application, public FIX::MessageCracker {
+public:
+    enum Kind { Valid, Invalid, Duplicate, Extreme, Stale, Resend, KindCount };
+
+    struct Options {
+        unsigned weights[KindCount]; // Relative share of each kind
+        unsigned window;             // Orders awaiting an answer before the sender waits; 0 = no limit
+        unsigned rate;               // Orders per second; 0 = as fast as the window allows
+        unsigned timeoutMs;          // An order unanswered for this long is a violation
+        uint64_t seed;
+
+        Options();
+    };
+
+    // Cumulative since start
+    struct Stats {
+        uint64_t sent[KindCount];
+        uint64_t answered;
+        uint64_t fills;
+        uint64_t rejects;        // ExecutionReports with OrdStatus REJECTED
+        uint64_t sessionRejects; // Reject / BusinessMessageReject answering one of our orders
+        uint64_t possDups;       // Resent reports, ignored
+        uint64_t violations;
+        uint64_t outstanding;
+    };
+
+    // Round-trip latencies (send -> answer) since the last takeLatencies()
+    struct Latencies {
+        uint64_t count;
+        uint64_t maxNs;
+        uint64_t buckets[Metrics::kBuckets];
+
+        Latencies() { clear(); }
+        void clear();
+        uint64_t percentile(double q) const;
+    };
+
+    explicit SoakClient(const Options& options);
+    ~SoakClient();
+
+    // QuickFIX Callbacks
+    void onCreate(const FIX::SessionID& sessionID) override;
+    void onLogon(const FIX::SessionID& sessionID) override;
+    void onLogout(const FIX::SessionID& sessionID) override;
+    void toAdmin(FIX::Message& message, const FIX::SessionID& sessionID) override;
+    void toApp(FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::DoNotSend) override;
+    void fromAdmin(const FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::RejectLogon) override;
+    void fromApp(const FIX::Message& message, const FIX::SessionID& sessionID) throw(FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::UnsupportedMessageType) override;
+
+    void onMessage(const FIX42::ExecutionReport& message, const FIX::SessionID& sessionID) override;
+    void onMessage(const FIX42::OrderCancelReject& message, const FIX::SessionID& sessionID) override;
+
+    bool isLoggedOn() const { return m_loggedOn; }
+
+    void start();
+    void stop();
+
+    // Latest top of book per symbol (from the market maker's snapshot); limit prices
+    // are drawn around it. Without it the client learns prices from its own fills.
+    void setReferencePrices(const std::map<std::string, std::pair<double, double> >& prices);
+
+    // Reports orders past the timeout as violations and stops waiting for them
+    void expireOverdue();
+    // Waits until nothing is outstanding or the timeout passes; false on timeout
+    bool drain(unsigned timeoutMs);
+
+    Stats stats();
+    void takeLatencies(Latencies& out);
+    // Net quantity we bought (+) or sold (-) per symbol through fills
+    std::map<std::string, long long> positions();
+    // Wall-clock time of the last answer, to know when a snapshot covers every fill
+    int64_t lastAnswerWallNs() const { return m_lastAnswerWallNs; }
+
+private:
+    // Invalid kinds; the market maker must refuse each one
+    enum Defect { ZeroQty, NegativeQty, HugeQty, BadSide, StopOrder, LimitWithoutPrice,
+                  NegativePrice, MissingSymbol, UnknownSymbol, DefectCount };
+
+    struct Pending {
+        uint64_t sentNs;
+        Kind kind;
+        std::string symbol;
+        char side;
+        char ordType;
+        double price;
+        long long qty;
+        Defect defect; // DefectCount unless kind is Invalid
+        int copies;    // Duplicate ClOrdIDs still awaiting an answer
+    };
+
+    void run();
+    void sendOne();
+    void sendResendRequest();
+    FIX42::NewOrderSingle makeOrder(Kind kind, std::string& clOrdID, Pending& pending);
+    void answered(std::unordered_map<std::string, Pending>::iterator it); // Caller holds m_mutex
+    void onSessionReject(int refSeqNum, const std::string& text);
+    void violation(const std::string& what);
+    void checkExecID(const std::string& execID); // Caller holds m_mutex
+
+    Options m_options;
+    FIX::SessionID m_sessionID;
+    std::atomic<bool> m_loggedOn;
+    std::atomic<bool> m_running;
+    std::thread m_senderThread;
+    IdGenerator m_clOrdIds;
+    std::mt19937_64 m_random; // Sender thread only
+
+    std::mutex m_mutex; // Guards everything below
+    std::condition_variable m_answeredCond;
+    std::unordered_map<std::string, Pending> m_pending;      // ClOrdID -> order awaiting an answer
+    std::map<int, std::string> m_pendingBySeqNum;            // Our MsgSeqNum -> ClOrdID, pruned from the front
+    std::map<int, std::string> m_earlyRejects;               // Rejects that beat the seqnum bookkeeping
+    std::vector<std::pair<std::string, Pending> > m_recent;  // Ring of recent orders to resubmit
+    size_t m_recentNext;
+    std::map<std::string, std::pair<double, double> > m_prices;
+    std::map<std::string, long long> m_positions;
+    std::unordered_map<std::string, uint64_t> m_lastExecSeq; // ExecID prefix-epoch-shard -> last sequence
+    Stats m_stats;
+    Latencies m_latencies;
+    std::atomic<int64_t> m_lastAnswerWallNs;
+};
+
+#endif // SOAK_CLIENT_H
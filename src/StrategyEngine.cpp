@@ -2,78 +2,613 @@
 #include "StrategyEngine.h"
 #include "OrderBook.h"
 #include "MarketMakerApp.h" // Include to access MarketMakerApplication's methods
+#include "Snapshot.h" // For FillJournal
+#include "ConflationBuffer.h"
+#include "MarketAnalytics.h"
+#include "TickStore.h"
+#include "StrategyRuntime.h"
+#include "Metrics.h"
+#include "ThreadTopology.h"
+#include "TscClock.h"
 #include <quickfix/Session.h>
 #include <quickfix/FieldConvertors.h> // For FIX::UtcTimeStamp
 #include <quickfix/FixFields.h> // Ensure this is included for various FIX fields like LastQty, LastPx
+#include <quickfix/fix42/OrderCancelRequest.h>
+#include <quickfix/fix42/OrderCancelReplaceRequest.h>
 #include <iomanip> // For std::fixed, std::setprecision
+#include <cmath>
+#include <algorithm>
 
-StrategyEngine::StrategyEngine(OrderBook* orderBook, MarketMakerApplication* mmApp)
-    : m_orderBook(orderBook), m_mmApp(mmApp), m_quotingRunning(false),
-      m_randGen(std::chrono::system_clock::now().time_since_epoch().count()),
-      m_qtyDist(100, 500)
-{}
+namespace {
 
-StrategyEngine::~StrategyEngine() {
+const uint64_t kQuoteTimerTickNs = 1000000;  // 1 ms
+const uint64_t kQuoteMaxSleepNs = 100000000; // Longest sleep between timer checks
+
+} // namespace
+
+template <class Book, class QuotingModel, class Lock>
+BasicStrategyEngine<Book, QuotingModel, Lock>::BasicStrategyEngine(Book* orderBook, MarketMakerApplication* mmApp)
+    : m_orderBook(orderBook), m_mmApp(mmApp), m_quotingRunning(false), m_quotingActive(false),
+      m_fillJournal(nullptr),
+      m_quoteIds("MM-QUOTE"), m_orderIds("MM-ORD"), m_execIds("MM-EXEC"),
+      m_quoteUpdates(nullptr),
+      // Without a conflated feed we only quote AAPL off the OrderBook
+      m_quoting(std::vector<std::string>(1, "AAPL"), kQuoteTimerTickNs, TscClock::nowNs()),
+      m_quoteRefreshNs(3000 * 1000000ULL), m_nextRefreshNs(0),
+      m_analytics(nullptr), m_tickStore(nullptr), m_strategyRuntime(nullptr),
+      m_ourOpenQuotes(0.01)
+{
+    m_quoteIndex["AAPL"] = 0;
+    std::cout << "StrategyEngine: Signal kernel using " << m_quoting.model().implementation() << " implementation." << std::endl;
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::setQuoteUpdates(ConflationBuffer* updates) {
+    m_quoteUpdates = updates;
+    if (!updates) {
+        return;
+    }
+    std::vector<std::string> symbols;
+    m_quoteIndex.clear();
+    for (size_t i = 0; i < updates->size(); ++i) {
+        symbols.push_back(updates->symbolAt(i));
+        m_quoteIndex[updates->symbolAt(i)] = i;
+    }
+    m_quoting.setSymbols(symbols);
+    setAnalytics(m_analytics, m_quoting.params().quoteAroundMicroprice); // Re-map to the new symbol universe
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::setQuoteTimers(int refreshMs, int minLifeMs, int staleMs) {
+    m_quoteRefreshNs = static_cast<uint64_t>(std::max(refreshMs, 1)) * 1000000ULL;
+    m_quoting.params().minQuoteLifeNs = static_cast<uint64_t>(std::max(minLifeMs, 0)) * 1000000ULL;
+    m_quoting.params().staleNs = static_cast<uint64_t>(std::max(staleMs, 0)) * 1000000ULL;
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::setAnalytics(MarketAnalytics* analytics, bool quoteAroundMicroprice) {
+    m_analytics = analytics;
+    m_quoting.params().quoteAroundMicroprice = analytics && quoteAroundMicroprice;
+    m_analyticsIndex.assign(m_quoting.size(), -1);
+    if (analytics) {
+        for (size_t i = 0; i < m_quoting.size(); ++i) {
+            m_analyticsIndex[i] = analytics->indexOf(m_quoting.symbolAt(i));
+        }
+    }
+}
+
+template <class Book, class QuotingModel, class Lock>
+BasicStrategyEngine<Book, QuotingModel, Lock>::~BasicStrategyEngine() {
     stopQuoting();
 }
 
-std::string StrategyEngine::generateNewClOrdID() {
-    static long long i = 0;
-    return "MM-QUOTE-" + std::to_string(++i);
+template <class Book, class QuotingModel, class Lock>
+std::string BasicStrategyEngine<Book, QuotingModel, Lock>::generateNewClOrdID() {
+    return m_quoteIds.next().str();
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::applyFill(const std::string& symbol, long long qtyDelta, double price) {
+    std::lock_guard<Lock> locker(m_positionMutex);
+    Position& position = m_positions[symbol];
+    position.qty += qtyDelta;
+    position.cashFlow -= qtyDelta * price;
 }
 
-void StrategyEngine::startQuoting() {
+template <class Book, class QuotingModel, class Lock>
+long long BasicStrategyEngine<Book, QuotingModel, Lock>::positionQty(const std::string& symbol) {
+    std::lock_guard<Lock> locker(m_positionMutex);
+    auto it = m_positions.find(symbol);
+    return it != m_positions.end() ? it->second.qty : 0;
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::recordFill(const std::string& symbol, long long qtyDelta, double price) {
+    // Journal append and position update happen under one lock so a snapshot
+    // never sees a position without the matching journal sequence (or vice versa)
+    {
+        std::lock_guard<Lock> locker(m_positionMutex);
+        bookFill(symbol, qtyDelta, price);
+    }
+    publishTrade(symbol, qtyDelta, price);
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::bookFill(const std::string& symbol, long long qtyDelta, double price) {
+    if (m_fillJournal) {
+        m_fillJournal->append(symbol, qtyDelta, price);
+    }
+    Position& position = m_positions[symbol];
+    position.qty += qtyDelta;
+    position.cashFlow -= qtyDelta * price;
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::publishTrade(const std::string& symbol, long long qtyDelta, double price) {
+    if (!m_analytics && !m_tickStore && !m_strategyRuntime) {
+        return;
+    }
+    uint64_t now = MarketAnalytics::wallClockNs();
+    long index = m_analytics ? m_analytics->indexOf(symbol) : -1;
+    if (index >= 0) {
+        m_analytics->onTrade(static_cast<size_t>(index), price, static_cast<double>(qtyDelta < 0 ? -qtyDelta : qtyDelta), now);
+    }
+    if (m_tickStore) {
+        m_tickStore->recordFill(symbol, qtyDelta, price, static_cast<int64_t>(now));
+    }
+    if (m_strategyRuntime) {
+        m_strategyRuntime->postFill(symbol, qtyDelta, price);
+    }
+}
+
+template <class Book, class QuotingModel, class Lock>
+typename BasicStrategyEngine<Book, QuotingModel, Lock>::StateSnapshot BasicStrategyEngine<Book, QuotingModel, Lock>::snapshotState() {
+    StateSnapshot state;
+    {
+        std::lock_guard<Lock> locker(m_positionMutex);
+        state.positions = m_positions;
+        state.journalSequence = m_fillJournal ? m_fillJournal->lastSequence() : 0;
+    }
+    state.idEpoch = m_quoteIds.epoch();
+    return state;
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::restoreState(const StateSnapshot& state) {
+    std::lock_guard<Lock> locker(m_positionMutex);
+    m_positions = state.positions;
+    // Guards against a wall clock that went backwards across the restart
+    m_quoteIds.ensureEpochAfter(state.idEpoch);
+    m_orderIds.ensureEpochAfter(state.idEpoch);
+    m_execIds.ensureEpochAfter(state.idEpoch);
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::startQuoting() {
     FIX::Locker locker(m_mutex);
-    if (!m_quotingRunning) {
-        m_quotingRunning = true;
-        m_quotingThread = std::thread([this]() {
-            while (m_quotingRunning) {
-                // Check if the MarketMakerApp has an active client session
-                if (m_mmApp && FIX::Session::doesSessionExist(m_mmApp->getClientSessionID()) &&
-                    FIX::Session::lookupSession(m_mmApp->getClientSessionID())->isLoggedOn()) {
-                    m_clientSessionID = m_mmApp->getClientSessionID(); // Cache client session ID
-                    manageQuotes(); // Execute the quoting logic
-                } else {
-                    // std::cout << "StrategyEngine: Waiting for MarketMakerApp to have a client session..." << std::endl;
-                }
-                std::this_thread::sleep_for(std::chrono::milliseconds(3000)); // Quote every 3 seconds
+    {
+        std::lock_guard<std::mutex> lock(m_quoteWakeMutex);
+        m_quotingActive = true;
+    }
+    m_quoteWake.notify_one();
+    if (m_quotingRunning) {
+        return; // Paused or already quoting; the thread picks the flag up
+    }
+    m_quotingRunning = true;
+    m_quotingThread = std::thread([this]() {
+        ThreadTopology::apply(ThreadTopology::Strategy);
+        m_quoting.model().relocate(); // Kernel columns onto the strategy thread's NUMA node
+        bool active = false;
+        while (m_quotingRunning) {
+            if (!m_quotingActive) {
+                active = false;
+                std::unique_lock<std::mutex> lock(m_quoteWakeMutex);
+                m_quoteWake.wait(lock, [this]() { return m_quotingActive || !m_quotingRunning; });
+                continue;
+            }
+            // A pass every m_quoteRefreshNs, plus whenever a deferred requote falls due;
+            // (re)starting runs one straight away
+            bool refresh = !active || TscClock::nowNs() >= m_nextRefreshNs;
+            active = true;
+            if (refresh) {
+                m_nextRefreshNs = TscClock::nowNs() + m_quoteRefreshNs;
+            }
+            if (runQuoteTimers(refresh) && m_quotingActive && canQuote()) {
+                manageQuotes(); // Execute the quoting logic
             }
+            uint64_t now = TscClock::nowNs();
+            uint64_t wake = std::min(std::min(m_quoting.nextTimerNs(), m_nextRefreshNs), now + kQuoteMaxSleepNs);
+            if (wake > now) {
+                std::unique_lock<std::mutex> lock(m_quoteWakeMutex);
+                m_quoteWake.wait_for(lock, std::chrono::nanoseconds(wake - now),
+                                     [this]() { return !m_quotingActive || !m_quotingRunning; });
+            }
+        }
+    });
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::pauseQuoting() {
+    {
+        std::lock_guard<std::mutex> lock(m_quoteWakeMutex);
+        m_quotingActive = false;
+    }
+    m_quoteWake.notify_one();
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::stopQuoting() {
+    std::thread quotingThread;
+    {
+        FIX::Locker locker(m_mutex);
+        if (!m_quotingRunning) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_quoteWakeMutex);
+            m_quotingActive = false;
+            m_quotingRunning = false;
+        }
+        quotingThread.swap(m_quotingThread);
+    }
+    m_quoteWake.notify_one();
+    // Joined outside m_mutex: a logon callback may be waiting on it while holding the
+    // session mutex the quoting thread needs to finish its last send
+    if (quotingThread.joinable()) {
+        quotingThread.join();
+    }
+}
+
+template <class Book, class QuotingModel, class Lock>
+bool BasicStrategyEngine<Book, QuotingModel, Lock>::canQuote() {
+    // Check if the MarketMakerApp has an active client session
+    if (m_mmApp && FIX::Session::doesSessionExist(m_mmApp->getClientSessionID()) &&
+        FIX::Session::lookupSession(m_mmApp->getClientSessionID())->isLoggedOn()) {
+        m_clientSessionID = m_mmApp->getClientSessionID(); // Cache client session ID
+        return true;
+    }
+    // No client, but we can still make markets on the exchange
+    return m_mmApp && m_mmApp->isUpstreamLoggedOn();
+}
+
+template <class Book, class QuotingModel, class Lock>
+bool BasicStrategyEngine<Book, QuotingModel, Lock>::runQuoteTimers(bool refresh) {
+    m_quoteActions.clear();
+    {
+        std::lock_guard<Lock> locker(m_quoteMutex);
+        // The feed may have updated a symbol after the last drain, which only a pass does
+        m_quoting.advance(TscClock::nowNs(),
+                          [this](size_t index) { return m_quoteUpdates && m_quoteUpdates->pending(index); },
+                          m_ourOpenQuotes, m_quoteIds, m_quoteActions);
+    }
+    for (size_t index : m_quoting.pulled()) {
+        std::cout << "StrategyEngine: No market update for " << m_quoting.symbolAt(index) << " in "
+                  << m_quoting.params().staleNs / 1000000 << " ms, pulling its quotes." << std::endl;
+    }
+    if (!m_quoteActions.empty()) {
+        for (const QuoteBook::Action& action : m_quoteActions) {
+            routeQuoteAction(action);
+        }
+        Metrics::increment(Metrics::QuoteCancels, m_quoteActions.size()); // Cancels are all a pull produces
+    }
+    return refresh || !m_quoting.changes().empty();
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::manageQuotes() {
+    Metrics::ScopedLatency latency(Metrics::QuoteCycle);
+    Metrics::increment(Metrics::QuoteCycles);
+
+    // 1. New market state into the kernel's columns
+    uint64_t now = TscClock::nowNs();
+    if (m_quoteUpdates) {
+        // Latency here is bounded by the number of symbols, not by the tick backlog
+        m_quoteUpdates->drain([this, now](const ConflationBuffer::Update& update) {
+            double microprice = 0.0;
+            if (m_analyticsIndex[update.index] >= 0) {
+                // Published before this update reached the buffer (see MarketDataProcessor.h)
+                microprice = m_analytics->microprice(static_cast<size_t>(m_analyticsIndex[update.index]));
+            }
+            m_quoting.onMarket(update.index, update.bid, update.ask, microprice, update.ticksConflated, now);
         });
+    } else {
+        typename Book::MarketData data = m_orderBook->getMarketData("AAPL");
+        m_quoting.onMarket(0, data.bid, data.ask, 0.0, 1, now);
+    }
+    // Requotes the minimum quote life deferred join these once runQuoteTimers() finds them due
+    const std::vector<typename BasicQuotingCycle<QuotingModel>::Change>& changes = m_quoting.changes();
+    uint64_t ticksConflated = 0;
+    for (const auto& changed : changes) {
+        ticksConflated += changed.second;
+    }
+    Metrics::setGauge(Metrics::ConflationDepth, changes.size());
+    Metrics::setGauge(Metrics::TicksConflated, ticksConflated);
+    if (changes.empty()) {
+        return;
+    }
+
+    // 2. Inventories feed the skew term and the position limit
+    m_quoting.clearPositions();
+    {
+        std::lock_guard<Lock> locker(m_positionMutex);
+        for (const auto& entry : m_positions) {
+            auto it = m_quoteIndex.find(entry.first);
+            if (it != m_quoteIndex.end()) {
+                m_quoting.setPosition(it->second, entry.second.qty);
+            }
+        }
+        Metrics::setGauge(Metrics::PositionSymbols, m_positions.size());
+    }
+    Metrics::setGauge(Metrics::RegionBytesUsed, MemoryRegion::used());
+    Metrics::setGauge(Metrics::RegionHeapFallbacks, MemoryRegion::heapFallbacks());
+
+    // 3. Fair value, volatility, skew and target prices for every symbol at once
+    m_quoting.compute();
+    const QuotingModel& model = m_quoting.model();
+    for (const auto& changed : changes) {
+        std::cout << "StrategyEngine: My current desired quotes for " << m_quoting.symbolAt(changed.first) << ": BID "
+                  << std::fixed << std::setprecision(2) << model.bid(changed.first)
+                  << " x " << m_quoting.params().quoteSize << " | ASK "
+                  << std::fixed << std::setprecision(2) << model.ask(changed.first)
+                  << " x " << m_quoting.params().quoteSize
+                  << " (" << changed.second << " ticks)" << std::endl;
+    }
+
+    // 4. Diff against what is already working; unchanged quotes produce no requests
+    QuoteBook::Stats before;
+    m_quoteActions.clear();
+    {
+        std::lock_guard<Lock> locker(m_quoteMutex);
+        before = m_ourOpenQuotes.stats();
+        m_quoting.decide(now, m_ourOpenQuotes, m_quoteIds, m_quoteActions);
+    }
+
+    // Routed outside the lock: acks may come straight back into onOurOwnExecutionReport
+    for (const QuoteBook::Action& action : m_quoteActions) {
+        routeQuoteAction(action);
+    }
+
+    QuoteBook::Stats after;
+    {
+        std::lock_guard<Lock> locker(m_quoteMutex);
+        after = m_ourOpenQuotes.stats();
+        Metrics::setGauge(Metrics::WorkingQuotes, m_ourOpenQuotes.workingCount());
     }
+    Metrics::increment(Metrics::QuoteNews, after.news - before.news);
+    Metrics::increment(Metrics::QuoteReplaces, after.replaces - before.replaces);
+    Metrics::increment(Metrics::QuoteCancels, after.cancels - before.cancels);
+    std::cout << "StrategyEngine: Quote cycle: " << (after.news - before.news) << " new, "
+              << (after.replaces - before.replaces) << " replace, "
+              << (after.cancels - before.cancels) << " cancel, "
+              << (after.unchanged - before.unchanged) << " unchanged, "
+              << (after.awaitingAck - before.awaitingAck) << " awaiting ack." << std::endl;
 }
 
-void StrategyEngine::stopQuoting() {
-    FIX::Locker locker(m_mutex);
-    if (m_quotingRunning) {
-        m_quotingRunning = false;
-        if (m_quotingThread.joinable()) {
-            m_quotingThread.join();
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::routeQuoteAction(const QuoteBook::Action& action) {
+    if (m_mmApp && m_mmApp->isUpstreamLoggedOn()) {
+        // Once paused nothing more goes into a session: the pause may come from a callback
+        // that holds the session mutex sendUpstream would wait on
+        bool active = m_quotingActive;
+        if (!active || !sendUpstream(action)) {
+            // Never reached the exchange: unwind the pending state so the next cycle retries
+            if (active) {
+                Metrics::reject(Metrics::RejectSendFailed);
+            }
+            std::lock_guard<Lock> locker(m_quoteMutex);
+            m_quoteSentAt.erase(action.clOrdID);
+            if (action.type == QuoteBook::Action::New) {
+                m_ourOpenQuotes.onRejected(action.clOrdID);
+            } else {
+                m_ourOpenQuotes.onCancelRejected(action.clOrdID);
+            }
         }
+        return;
+    }
+    // No upstream venue connected, so our quotes rest internally and are acked here
+    acknowledgeLocally(action);
+}
+
+template <class Book, class QuotingModel, class Lock>
+bool BasicStrategyEngine<Book, QuotingModel, Lock>::sendUpstream(const QuoteBook::Action& action) {
+    FIX::Side side(action.side == QuoteBook::Bid ? FIX::Side_BUY : FIX::Side_SELL);
+    {
+        std::lock_guard<Lock> locker(m_quoteMutex);
+        m_quoteSentAt[action.clOrdID] = std::chrono::steady_clock::now();
+    }
+
+    if (action.type == QuoteBook::Action::New) {
+        FIX42::NewOrderSingle order(
+            FIX::ClOrdID(action.clOrdID),
+            FIX::HandlInst(FIX::HandlInst_AUTOMATED_EXECUTION_NO_INTERVENTION),
+            FIX::Symbol(action.symbol),
+            side,
+            FIX::TransactTime(FIX::UtcTimeStamp::now()),
+            FIX::OrdType(FIX::OrdType_LIMIT)
+        );
+        order.set(FIX::OrderQty(static_cast<int>(action.size)));
+        order.set(FIX::Price(action.price));
+        order.set(FIX::TimeInForce(FIX::TimeInForce_DAY));
+        return m_mmApp->sendToUpstream(order);
+    }
+
+    if (action.type == QuoteBook::Action::Replace) {
+        FIX42::OrderCancelReplaceRequest replace(
+            FIX::OrigClOrdID(action.origClOrdID),
+            FIX::ClOrdID(action.clOrdID),
+            FIX::HandlInst(FIX::HandlInst_AUTOMATED_EXECUTION_NO_INTERVENTION),
+            FIX::Symbol(action.symbol),
+            side,
+            FIX::TransactTime(FIX::UtcTimeStamp::now()),
+            FIX::OrdType(FIX::OrdType_LIMIT)
+        );
+        if (!action.orderID.empty()) {
+            replace.set(FIX::OrderID(action.orderID));
+        }
+        replace.set(FIX::OrderQty(static_cast<int>(action.size)));
+        replace.set(FIX::Price(action.price));
+        return m_mmApp->sendToUpstream(replace);
+    }
+
+    FIX42::OrderCancelRequest cancel(
+        FIX::OrigClOrdID(action.origClOrdID),
+        FIX::ClOrdID(action.clOrdID),
+        FIX::Symbol(action.symbol),
+        side,
+        FIX::TransactTime(FIX::UtcTimeStamp::now())
+    );
+    if (!action.orderID.empty()) {
+        cancel.set(FIX::OrderID(action.orderID));
     }
+    cancel.set(FIX::OrderQty(static_cast<int>(action.size)));
+    return m_mmApp->sendToUpstream(cancel);
 }
 
-void StrategyEngine::manageQuotes() {
-    double midPrice = m_orderBook->getMidPrice("AAPL");
-    if (midPrice == 0.0) {
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::recordQuoteLatency(const std::string& clOrdID, bool isFill) {
+    auto it = m_quoteSentAt.find(clOrdID);
+    if (it == m_quoteSentAt.end()) {
         return;
     }
+    long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - it->second).count();
+    Metrics::recordLatency(isFill ? Metrics::QuoteFill : Metrics::QuoteAck, static_cast<uint64_t>(ns));
+    long long us = ns / 1000;
+    LatencyStats& stats = isFill ? m_fillLatency : m_ackLatency;
+    ++stats.count;
+    stats.totalUs += us;
+    if (us > stats.maxUs) {
+        stats.maxUs = us;
+    }
+    if (!isFill) {
+        m_quoteSentAt.erase(it); // Fills after the ack are market-driven, not a round trip
+    }
+    std::cout << "StrategyEngine: Quote " << clOrdID << (isFill ? " filled" : " acked") << " after " << us
+              << "us (avg " << stats.totalUs / static_cast<long long>(stats.count) << "us, max "
+              << stats.maxUs << "us over " << stats.count << ")" << std::endl;
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::onUpstreamSessionChanged(bool loggedOn) {
+    std::lock_guard<Lock> locker(m_quoteMutex);
+    // Day orders on the exchange die with the session, and anything acked locally
+    // was never there; start both sides of every symbol from scratch
+    m_ourOpenQuotes.clear();
+    m_clOrdIDtoOrderID.clear();
+    m_quoteSentAt.clear();
+    std::cout << "StrategyEngine: Upstream exchange " << (loggedOn ? "logged on" : "logged out")
+              << ", quote state reset." << std::endl;
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::onOurOwnCancelReject(const FIX42::OrderCancelReject& message) {
+    FIX::ClOrdID clOrdID;
+    try {
+        message.get(clOrdID);
+        std::lock_guard<Lock> locker(m_quoteMutex);
+        m_quoteSentAt.erase(clOrdID.getValue());
+        if (message.isSetField(FIX::FIELD::CxlRejReason)) {
+            FIX::CxlRejReason reason;
+            message.get(reason);
+            if (reason == FIX::CxlRejReason_UNKNOWN_ORDER) {
+                // The exchange no longer has the order (filled or expired): the side is free
+                Metrics::reject(Metrics::RejectCancelUnknown);
+                m_ourOpenQuotes.onCanceled(clOrdID.getValue());
+                return;
+            }
+        }
+        Metrics::reject(Metrics::RejectCancelOther);
+        m_ourOpenQuotes.onCancelRejected(clOrdID.getValue());
+    } catch (const FIX::FieldNotFound& e) {
+        std::cerr << "StrategyEngine: Field not found in our own cancel reject: " << e.what() << std::endl;
+    }
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::acknowledgeLocally(const QuoteBook::Action& action) {
+    FIX::ExecType execType = FIX::ExecType_NEW;
+    FIX::OrdStatus ordStatus = FIX::OrdStatus_NEW;
+    if (action.type == QuoteBook::Action::Replace) {
+        execType = FIX::ExecType_REPLACE;
+        ordStatus = FIX::OrdStatus_REPLACED;
+    } else if (action.type == QuoteBook::Action::Cancel) {
+        execType = FIX::ExecType_CANCELED;
+        ordStatus = FIX::OrdStatus_CANCELED;
+    }
+
+    FIX42::ExecutionReport ack(
+        FIX::OrderID(action.orderID.empty() ? m_orderIds.next().str() : action.orderID),
+        FIX::ExecID(m_execIds.next().str()),
+        FIX::ExecTransType_NEW,
+        execType,
+        ordStatus,
+        FIX::Symbol(action.symbol),
+        FIX::Side(action.side == QuoteBook::Bid ? FIX::Side_BUY : FIX::Side_SELL),
+        FIX::LeavesQty(action.type == QuoteBook::Action::Cancel ? 0 : static_cast<int>(action.size - action.cumQty)),
+        FIX::CumQty(static_cast<int>(action.cumQty)),
+        FIX::AvgPx(0)
+    );
+    ack.set(FIX::ClOrdID(action.clOrdID));
+    if (!action.origClOrdID.empty()) {
+        ack.set(FIX::OrigClOrdID(action.origClOrdID));
+    }
+    ack.set(FIX::OrderQty(static_cast<int>(action.size)));
+    ack.set(FIX::Price(action.price));
+    ack.set(FIX::TransactTime(FIX::UtcTimeStamp::now()));
+    onOurOwnExecutionReport(ack);
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::onNewOrderSingle(const FIX42::NewOrderSingle& message, const FIX::SessionID& clientSessionID) {
+    FIX::Symbol symbol;
+    message.get(symbol);
 
-    double spread = 0.04; // Desired spread (e.g., 4 cents)
-    double bidPrice = midPrice - (spread / 2.0);
-    double askPrice = midPrice + (spread / 2.0);
-    int quoteQuantity = m_qtyDist(m_randGen);
+    ClientFill fill;
+    FIX42::ExecutionReport execReport = matchClientOrder(message, m_orderBook->getMarketData(symbol.getValue()), fill);
+    if (fill.qtyDelta != 0) {
+        recordFill(fill.symbol, fill.qtyDelta, fill.price);
+    }
+
+    if (m_mmApp) {
+        // Pass the execReport by non-const reference as required by MarketMakerApp::sendExecutionReportToClient
+        m_mmApp->sendExecutionReportToClient(execReport, clientSessionID);
+    }
+}
 
-    bidPrice = std::round(bidPrice * 100.0) / 100.0;
-    askPrice = std::round(askPrice * 100.0) / 100.0;
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::onNewOrderBatch(std::vector<OrderBatcher::Order>& orders) {
+    // One book read per symbol in the batch: orders in the same batch match against
+    // the same top of book, as they would had they arrived in the same instant
+    std::unordered_map<std::string, typename Book::MarketData> markets;
+    std::vector<ClientFill> fills;
+    MarketMakerApplication::ReportBatch reports;
+    reports.reserve(orders.size());
+
+    FIX::Symbol symbol;
+    for (OrderBatcher::Order& order : orders) {
+        try {
+            order.message.get(symbol);
+            auto market = markets.find(symbol.getValue());
+            if (market == markets.end()) {
+                market = markets.emplace(symbol.getValue(), m_orderBook->getMarketData(symbol.getValue())).first;
+            }
+            ClientFill fill;
+            reports.push_back(std::make_pair(matchClientOrder(order.message, market->second, fill), order.sessionID));
+            if (fill.qtyDelta != 0) {
+                fills.push_back(fill);
+            }
+        } catch (const FIX::FieldNotFound& e) {
+            // Unbatched, QuickFIX answers this with a session Reject; here the order still gets its one answer
+            std::cerr << "StrategyEngine: Field not found in batched client order: " << e.what() << std::endl;
+            reports.push_back(std::make_pair(rejectClientOrder(order.message, std::string("Missing field: ") + e.what()),
+                                             order.sessionID));
+        }
+    }
 
-    std::cout << "StrategyEngine: My current desired quotes for AAPL: BID "
-              << std::fixed << std::setprecision(2) << bidPrice
-              << " x " << quoteQuantity << " | ASK "
-              << std::fixed << std::setprecision(2) << askPrice
-              << " x " << quoteQuantity << std::endl;
+    // Every fill of the batch is journaled and booked under one lock acquisition
+    if (!fills.empty()) {
+        std::lock_guard<Lock> locker(m_positionMutex);
+        for (const ClientFill& fill : fills) {
+            bookFill(fill.symbol, fill.qtyDelta, fill.price);
+        }
+    }
+    for (const ClientFill& fill : fills) {
+        publishTrade(fill.symbol, fill.qtyDelta, fill.price);
+    }
+
+    if (m_mmApp) {
+        m_mmApp->sendExecutionReports(reports);
+    }
+
+    uint64_t now = Metrics::nowNs();
+    for (const OrderBatcher::Order& order : orders) {
+        Metrics::recordLatency(Metrics::OrderHandling, now - order.receivedNs);
+    }
 }
 
-void StrategyEngine::onNewOrderSingle(const FIX42::NewOrderSingle& message, const FIX::SessionID& clientSessionID) {
+template <class Book, class QuotingModel, class Lock>
+template <class MarketData>
+FIX42::ExecutionReport BasicStrategyEngine<Book, QuotingModel, Lock>::matchClientOrder(const FIX42::NewOrderSingle& message, const MarketData& market, ClientFill& fill) {
     FIX::ClOrdID clOrdID;
     FIX::Symbol symbol;
     FIX::Side side;
@@ -98,19 +633,38 @@ void StrategyEngine::onNewOrderSingle(const FIX42::NewOrderSingle& message, cons
     }
     std::cout << ", OrdType: " << ordType.getValue() << std::endl;
 
-    double bestBid = m_orderBook->getBestBid(symbol.getValue());
-    double bestAsk = m_orderBook->getBestAsk(symbol.getValue());
-    double midPrice = m_orderBook->getMidPrice(symbol.getValue());
+    double bestBid = market.bid;
+    double bestAsk = market.ask;
+    double midPrice = market.mid;
 
     FIX::ExecType execType = FIX::ExecType_FILL;
     FIX::OrdStatus ordStatus = FIX::OrdStatus_FILLED;
     std::string rejectReason = "";
     double fillPrice = 0.0;
 
-    if (midPrice == 0.0 || bestBid == 0.0 || bestAsk == 0.0) {
+    // Quantities go into int fields on the report, so anything outside (0, kMaxClientOrderQty] is refused
+    bool validQty = orderQty.getValue() > 0 && orderQty.getValue() <= kMaxClientOrderQty;
+    if (!validQty) {
+        rejectReason = "Invalid order quantity.";
+    } else if (side != FIX::Side_BUY && side != FIX::Side_SELL) {
+        rejectReason = "Unsupported side.";
+    } else if (ordType != FIX::OrdType_MARKET && ordType != FIX::OrdType_LIMIT) {
+        rejectReason = "Unsupported order type.";
+    } else if (ordType == FIX::OrdType_LIMIT &&
+               (!message.isSetField(FIX::FIELD::Price) || !(price.getValue() > 0.0) || !std::isfinite(price.getValue()))) {
+        rejectReason = "Invalid limit price.";
+    }
+
+    if (!rejectReason.empty()) {
+        execType = FIX::ExecType_REJECTED;
+        ordStatus = FIX::OrdStatus_REJECTED;
+        Metrics::reject(Metrics::RejectInvalidOrder);
+        std::cerr << "StrategyEngine: Rejecting " << clOrdID.getValue() << ": " << rejectReason << std::endl;
+    } else if (midPrice == 0.0 || bestBid == 0.0 || bestAsk == 0.0) {
         execType = FIX::ExecType_REJECTED;
         ordStatus = FIX::OrdStatus_REJECTED;
         rejectReason = "No valid market data available for matching.";
+        Metrics::reject(Metrics::RejectNoMarketData);
         std::cerr << "StrategyEngine: Rejecting " << clOrdID.getValue() << ": " << rejectReason << std::endl;
     } else {
         if (ordType == FIX::OrdType_MARKET) {
@@ -138,6 +692,7 @@ void StrategyEngine::onNewOrderSingle(const FIX42::NewOrderSingle& message, cons
                 execType = FIX::ExecType_REJECTED;
                 ordStatus = FIX::OrdStatus_REJECTED;
                 rejectReason = "Limit order not immediately marketable against current book.";
+                Metrics::reject(Metrics::RejectNotMarketable);
                 std::cerr << "StrategyEngine: Rejecting " << clOrdID.getValue() << ": " << rejectReason << std::endl;
             }
         }
@@ -146,15 +701,15 @@ void StrategyEngine::onNewOrderSingle(const FIX42::NewOrderSingle& message, cons
     // Prepare and send ExecutionReport via MarketMakerApplication
     // --- START OF CRITICAL FIXES FOR EXECUTIONREPORT CONSTRUCTOR & AMBIGUITY ---
     FIX42::ExecutionReport execReport(
-        FIX::OrderID("MM-ORD-" + clOrdID.getValue()),
-        FIX::ExecID("MM-EXEC-" + clOrdID.getValue()),
+        FIX::OrderID(m_orderIds.next().str()),
+        FIX::ExecID(m_execIds.next().str()),
         FIX::ExecTransType_NEW, // **FIX**: This argument was missing
         execType,
         ordStatus,
         symbol,                 // **FIX**: This argument was missing
         side,
         // **FIX**: Explicitly cast the quantity values to int to resolve ambiguity
-        FIX::LeavesQty(ordStatus == FIX::OrdStatus_FILLED ? 0 : static_cast<int>(orderQty.getValue())),
+        FIX::LeavesQty(ordStatus == FIX::OrdStatus_FILLED || !validQty ? 0 : static_cast<int>(orderQty.getValue())),
         FIX::CumQty(ordStatus == FIX::OrdStatus_FILLED ? static_cast<int>(orderQty.getValue()) : 0),
         FIX::AvgPx(fillPrice)
     );
@@ -187,27 +742,228 @@ void StrategyEngine::onNewOrderSingle(const FIX42::NewOrderSingle& message, cons
         execReport.set(FIX::Text(rejectReason));
     }
 
-    if (m_mmApp) {
-        // Pass the execReport by non-const reference as required by MarketMakerApp::sendExecutionReportToClient
-        m_mmApp->sendExecutionReportToClient(execReport, clientSessionID);
+    if (ordStatus == FIX::OrdStatus_FILLED) {
+        // We are the counterparty: a client BUY leaves us short
+        long long qty = static_cast<long long>(orderQty.getValue());
+        Metrics::increment(Metrics::ClientFills);
+        fill.symbol = symbol.getValue();
+        fill.qtyDelta = side == FIX::Side_BUY ? -qty : qty;
+        fill.price = fillPrice;
     }
+    return execReport;
 }
 
-void StrategyEngine::onOurOwnExecutionReport(const FIX42::ExecutionReport& message) {
+template <class Book, class QuotingModel, class Lock>
+FIX42::ExecutionReport BasicStrategyEngine<Book, QuotingModel, Lock>::rejectClientOrder(const FIX42::NewOrderSingle& message,
+                                                                                const std::string& reason) {
+    // Copy what the order does carry; Symbol and Side are required, so the validator saw them
+    FIX::Symbol symbol;
+    FIX::Side side;
+    if (message.isSetField(FIX::FIELD::Symbol)) {
+        message.get(symbol);
+    }
+    if (message.isSetField(FIX::FIELD::Side)) {
+        message.get(side);
+    }
+    FIX42::ExecutionReport execReport(
+        FIX::OrderID(m_orderIds.next().str()),
+        FIX::ExecID(m_execIds.next().str()),
+        FIX::ExecTransType_NEW,
+        FIX::ExecType(FIX::ExecType_REJECTED),
+        FIX::OrdStatus(FIX::OrdStatus_REJECTED),
+        symbol,
+        side,
+        FIX::LeavesQty(0),
+        FIX::CumQty(0),
+        FIX::AvgPx(0.0)
+    );
+    if (message.isSetField(FIX::FIELD::ClOrdID)) {
+        FIX::ClOrdID clOrdID;
+        message.get(clOrdID);
+        execReport.set(clOrdID);
+    }
+    execReport.setField(FIX::LastQty(0));
+    execReport.setField(FIX::LastPx(0.0));
+    execReport.set(FIX::TransactTime(FIX::UtcTimeStamp::now()));
+    execReport.set(FIX::Text(reason));
+    Metrics::reject(Metrics::RejectInvalidOrder);
+    return execReport;
+}
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::onOurOwnExecutionReport(const FIX42::ExecutionReport& message) {
     FIX::ClOrdID clOrdID;
     FIX::OrdStatus ordStatus;
+    FIX::ExecType execType;
+    FIX::OrderID orderID;
     try {
         message.get(clOrdID);
         message.get(ordStatus);
-        FIX::Locker locker(m_mutex);
-        if (m_ourOpenQuotes.count(clOrdID.getValue())) {
-            std::cout << "StrategyEngine: Our internal quote " << clOrdID.getValue()
-                      << " status changed to: " << ordStatus.getValue() << std::endl;
-            if (ordStatus == FIX::OrdStatus_FILLED || ordStatus == FIX::OrdStatus_CANCELED) {
-                m_ourOpenQuotes.erase(clOrdID.getValue());
+        message.get(execType);
+        message.get(orderID);
+        const std::string& id = clOrdID.getValue();
+        if (m_strategyRuntime && StrategyRuntime::isStrategyOrder(id)) {
+            onStrategyExecutionReport(message);
+            return;
+        }
+
+        std::lock_guard<Lock> locker(m_quoteMutex);
+        if (!m_ourOpenQuotes.isOurs(id)) {
+            std::cerr << "StrategyEngine: ExecutionReport for unknown quote " << id << std::endl;
+            return;
+        }
+
+        std::string origID;
+        if (message.isSetField(FIX::FIELD::OrigClOrdID)) {
+            FIX::OrigClOrdID origClOrdID;
+            message.get(origClOrdID);
+            origID = origClOrdID.getValue();
+        }
+
+        switch (execType.getValue()) {
+        case FIX::ExecType_NEW:
+            Metrics::increment(Metrics::QuoteAcks);
+            recordQuoteLatency(id, false);
+            m_ourOpenQuotes.onNewAck(id, orderID.getValue());
+            m_clOrdIDtoOrderID[id] = orderID;
+            break;
+        case FIX::ExecType_REPLACE: {
+            Metrics::increment(Metrics::QuoteAcks);
+            recordQuoteLatency(id, false);
+            FIX::LeavesQty leavesQty(-1);
+            if (message.isSetField(FIX::FIELD::LeavesQty)) {
+                message.getField(leavesQty);
             }
+            m_ourOpenQuotes.onReplaceAck(id, orderID.getValue(), static_cast<long long>(leavesQty.getValue()));
+            m_clOrdIDtoOrderID.erase(origID);
+            if (m_ourOpenQuotes.isOurs(id)) { // Not if it filled up to the new quantity while in flight
+                m_clOrdIDtoOrderID[id] = orderID;
+            }
+            break;
+        }
+        case FIX::ExecType_CANCELED:
+        case FIX::ExecType_EXPIRED:
+            Metrics::increment(Metrics::QuoteAcks);
+            recordQuoteLatency(id, false);
+            m_ourOpenQuotes.onCanceled(id);
+            m_clOrdIDtoOrderID.erase(origID);
+            m_clOrdIDtoOrderID.erase(id);
+            break;
+        case FIX::ExecType_PARTIAL_FILL:
+        case FIX::ExecType_FILL: {
+            FIX::LeavesQty leavesQty;
+            FIX::Symbol symbol;
+            FIX::Side side;
+            FIX::LastQty lastQty(0);
+            FIX::LastPx lastPx(0);
+            message.get(leavesQty);
+            message.get(symbol);
+            message.get(side);
+            if (message.isSetField(FIX::FIELD::LastQty)) {
+                message.getField(lastQty);
+            }
+            if (message.isSetField(FIX::FIELD::LastPx)) {
+                message.getField(lastPx);
+            }
+            long long filled = static_cast<long long>(lastQty.getValue());
+            // Our bid being hit makes us longer, our offer being lifted makes us shorter
+            recordFill(symbol.getValue(), side == FIX::Side_BUY ? filled : -filled, lastPx.getValue());
+            Metrics::increment(Metrics::QuoteFills);
+            recordQuoteLatency(id, true);
+            m_ourOpenQuotes.onFill(id, static_cast<long long>(leavesQty.getValue()));
+            if (leavesQty.getValue() <= 0) {
+                m_clOrdIDtoOrderID.erase(id);
+                m_quoteSentAt.erase(id);
+            }
+            break;
+        }
+        case FIX::ExecType_REJECTED:
+            Metrics::reject(Metrics::RejectQuoteByExchange);
+            m_quoteSentAt.erase(id);
+            m_ourOpenQuotes.onRejected(id);
+            break;
+        default:
+            break;
         }
     } catch (const FIX::FieldNotFound& e) {
         std::cerr << "StrategyEngine: Field not found in our own ER: " << e.what() << std::endl;
     }
 }
+
+template <class Book, class QuotingModel, class Lock>
+void BasicStrategyEngine<Book, QuotingModel, Lock>::onStrategyExecutionReport(const FIX42::ExecutionReport& message) {
+    FIX::ClOrdID clOrdID;
+    FIX::ExecType execType;
+    FIX::Symbol symbol;
+    FIX::Side side;
+    FIX::LeavesQty leavesQty;
+    message.get(clOrdID);
+    message.get(execType);
+    message.get(symbol);
+    message.get(side);
+    message.get(leavesQty);
+
+    StrategyExecution execution;
+    execution.clOrdID = clOrdID.getValue();
+    execution.leavesQty = static_cast<long long>(leavesQty.getValue());
+    switch (execType.getValue()) {
+    case FIX::ExecType_NEW:
+        execution.type = StrategyExecution::New;
+        break;
+    case FIX::ExecType_PARTIAL_FILL:
+    case FIX::ExecType_FILL: {
+        FIX::LastQty lastQty(0);
+        FIX::LastPx lastPx(0);
+        if (message.isSetField(FIX::FIELD::LastQty)) {
+            message.getField(lastQty);
+        }
+        if (message.isSetField(FIX::FIELD::LastPx)) {
+            message.getField(lastPx);
+        }
+        execution.type = StrategyExecution::Fill;
+        execution.lastQty = static_cast<long long>(lastQty.getValue());
+        execution.lastPx = lastPx.getValue();
+        // Booked like any other fill; the runtime sees it as a fill before it sees this report
+        recordFill(symbol.getValue(), side == FIX::Side_BUY ? execution.lastQty : -execution.lastQty, execution.lastPx);
+        break;
+    }
+    case FIX::ExecType_CANCELED:
+    case FIX::ExecType_EXPIRED:
+        execution.type = StrategyExecution::Canceled;
+        break;
+    case FIX::ExecType_REJECTED:
+        execution.type = StrategyExecution::Rejected;
+        if (message.isSetField(FIX::FIELD::Text)) {
+            FIX::Text text;
+            message.get(text);
+            execution.text = text.getValue();
+        }
+        break;
+    default:
+        execution.type = StrategyExecution::Other;
+        break;
+    }
+    m_strategyRuntime->postExecution(execution);
+}
+
+template <class Book, class QuotingModel, class Lock>
+bool BasicStrategyEngine<Book, QuotingModel, Lock>::sendStrategyOrder(const StrategyOrder& order) {
+    if (!m_mmApp || !m_mmApp->isUpstreamLoggedOn()) {
+        return false;
+    }
+    FIX42::NewOrderSingle message(
+        FIX::ClOrdID(order.clOrdID),
+        FIX::HandlInst(FIX::HandlInst_AUTOMATED_EXECUTION_NO_INTERVENTION),
+        FIX::Symbol(order.symbol),
+        FIX::Side(order.qty > 0 ? FIX::Side_BUY : FIX::Side_SELL),
+        FIX::TransactTime(FIX::UtcTimeStamp::now()),
+        FIX::OrdType(FIX::OrdType_LIMIT)
+    );
+    message.set(FIX::OrderQty(static_cast<int>(order.qty > 0 ? order.qty : -order.qty)));
+    message.set(FIX::Price(order.limitPrice));
+    message.set(FIX::TimeInForce(order.immediateOrCancel ? FIX::TimeInForce_IMMEDIATE_OR_CANCEL : FIX::TimeInForce_DAY));
+    return m_mmApp->sendToUpstream(message);
+}
+
+// Builds of the engine; add a line here to compile another Book/QuotingModel/Lock combination
+template class BasicStrategyEngine<OrderBook, SignalKernel, MutexLock>;
@@ -5,58 +5,230 @@
 #include <quickfix/SessionID.h>
 #include <quickfix/Mutex.h>
 #include <quickfix/fix42/NewOrderSingle.h>
-#include <quickfix/fix42/ExecutionReport.h> // For processing our own ERs (future)
+#include <quickfix/fix42/ExecutionReport.h> // For processing our own ERs
+#include <quickfix/fix42/OrderCancelReject.h>
 
 #include <string>
 #include <map>
 #include <thread>
-#include <random>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "IdGenerator.h"
+#include "SignalKernel.h"
+#include "QuoteBook.h"
+#include "QuotingCycle.h"
+#include "MemoryRegion.h"
+#include <vector>
+#include <unordered_map>
+
+#include "OrderBook.h" // The engine holds Lock policies by value
+#include "OrderBatcher.h"
+#include "StrategyEngineFwd.h"
 
-class OrderBook; // Forward declaration
 class MarketMakerApplication; // Forward declaration for communication
+class FillJournal; // Forward declaration for fill persistence
+class ConflationBuffer; // Forward declaration for conflated quote input
+class MarketAnalytics; // Forward declaration for trade/quote analytics
+class TickStoreWriter; // Forward declaration for the tick archive
+class StrategyRuntime; // Forward declaration for coroutine strategies
+struct StrategyOrder;
 
-class StrategyEngine {
+// Book, QuotingModel and Lock are compile-time policies; every call into them is static.
+// QuotingModel follows SignalKernel's interface: Params, resize(n), relocate(),
+// setMarket(i, mid, spread), setInventory(i, qty), clearInventories(),
+// compute(params), bid(i), ask(i) and implementation().
+// Lock is an OrderBook lock policy that std::lock_guard can hold. It guards positions
+// and quote state on every order and fill, which the quoting, FIX and batcher threads
+// all reach, so it must really lock: NoLock would race. Starting and stopping the
+// quoting thread has its own mutex, off those paths.
+// The explicitly instantiated builds are listed at the end of StrategyEngine.cpp.
+template <class Book, class QuotingModel, class Lock>
+class BasicStrategyEngine {
 public:
+    // Net position the market maker carries in one symbol.
+    // A client BUY fill makes us short, so qty goes negative and cashFlow positive.
+    struct Position {
+        long long qty;
+        double cashFlow;
+
+        Position() : qty(0), cashFlow(0.0) {}
+    };
+
+    // Everything SnapshotManager needs to warm-restart the engine
+    struct StateSnapshot {
+        std::map<std::string, Position> positions;
+        unsigned long long idEpoch;         // ID session epoch; the next run must use a later one
+        unsigned long long journalSequence; // Last fill journal record covered by positions
+
+        StateSnapshot() : idEpoch(0), journalSequence(0) {}
+    };
+
+    // Largest client OrderQty accepted; quantities are reported in int fields
+    static const int kMaxClientOrderQty = 1000000000;
+
     // Constructor takes OrderBook and a reference to the MarketMakerApp for callbacks
-    StrategyEngine(OrderBook* orderBook, MarketMakerApplication* mmApp);
-    ~StrategyEngine();
+    BasicStrategyEngine(Book* orderBook, MarketMakerApplication* mmApp);
+    ~BasicStrategyEngine();
 
     // Setter for MarketMakerApplication pointer (to resolve circular dependency during init)
     void setMarketMakerApp(MarketMakerApplication* mmApp) { m_mmApp = mmApp; }
 
+    // Optional: every fill is appended here so positions survive a crash between snapshots
+    void setFillJournal(FillJournal* journal) { m_fillJournal = journal; }
+
+    // Optional: conflated market data for quoting. When set, each cycle re-quotes only
+    // the symbols that changed, using their latest prices; otherwise it polls the OrderBook.
+    // The signal kernel is resized to the buffer's symbol universe.
+    void setQuoteUpdates(ConflationBuffer* updates);
+
+    // Optional: client and quote fills are published to `analytics` as trades, and with
+    // quoteAroundMicroprice the quoting cycle centres on its microprice instead of the mid.
+    // Symbols are matched to the quoting universe by name.
+    void setAnalytics(MarketAnalytics* analytics, bool quoteAroundMicroprice);
+
+    // Optional: every client and quote fill is also archived to `store`
+    void setTickStore(TickStoreWriter* store) { m_tickStore = store; }
+
+    // Optional: coroutine strategies. Every fill is posted to `runtime`, and reports for
+    // the orders it sends (through sendStrategyOrder) are routed back to it.
+    void setStrategyRuntime(StrategyRuntime* runtime) { m_strategyRuntime = runtime; }
+    // Sends a strategy order upstream; false without a logged-on venue session
+    bool sendStrategyOrder(const StrategyOrder& order);
+
+    void setSignalParams(const typename QuotingModel::Params& params) { m_quoting.params().signal = params; }
+    void setQuoteSize(long long size) { m_quoting.params().quoteSize = size; }
+    // A side stops quoting once |position| in its symbol reaches maxPosition; 0 = no limit
+    void setMaxPosition(long long maxPosition) { m_quoting.params().maxPosition = maxPosition; }
+    // Quote timing on the quoting thread: a pass every refreshMs. With minLifeMs a
+    // symbol's quotes are not changed again until they are that old; the change waits
+    // for it instead. With staleMs a symbol's quotes are pulled once its market has not
+    // updated for that long; staleMs below refreshMs works too, as an update the feed
+    // published but no pass has drained yet still counts. 0 turns either off. Set
+    // before startQuoting().
+    void setQuoteTimers(int refreshMs, int minLifeMs, int staleMs);
+
     // Method to receive client orders from MarketMakerApp
     void onNewOrderSingle(const FIX42::NewOrderSingle& message, const FIX::SessionID& clientSessionID);
+    // OrderBatcher handler: matches a batch of client orders as a group and sends
+    // all their ExecutionReports back to back
+    void onNewOrderBatch(std::vector<OrderBatcher::Order>& orders);
 
-    // Method to receive execution reports for our own quotes (if we sent them to an upstream)
-    // For this mock setup, MarketMakerApp directly acts as the exchange for clients,
-    // and its own quotes are internal for now. This will be more relevant if MMApp also initiates to an exchange.
+    // Method to receive execution reports for our own quotes.
+    // When MarketMakerApp has an upstream exchange session these come from the exchange;
+    // without one our quotes stay internal and acknowledgeLocally() produces the acks.
+    // This drives the QuoteBook state machine and books fills on our quotes.
     void onOurOwnExecutionReport(const FIX42::ExecutionReport& message);
+    void onOurOwnCancelReject(const FIX42::OrderCancelReject& message);
 
-    // Start/Stop the quoting logic thread
+    // Upstream logon/logout: whatever we thought was working there is no longer known
+    void onUpstreamSessionChanged(bool loggedOn);
+
+    // Start/Stop the quoting logic thread. startQuoting() and pauseQuoting() only set a
+    // flag and wake the thread, so session callbacks may call them: QuickFIX runs those
+    // holding the session mutex that the quoting thread takes to send. stopQuoting()
+    // joins the thread and belongs on the shutdown path.
     void startQuoting();
+    void pauseQuoting();
     void stopQuoting();
 
+    // Snapshot / warm-restart support
+    StateSnapshot snapshotState();
+    void restoreState(const StateSnapshot& state);
+    // Applies a position change without journaling it (used by journal replay)
+    void applyFill(const std::string& symbol, long long qtyDelta, double price);
+    // Booked net quantity in one symbol, 0 if never traded
+    long long positionQty(const std::string& symbol);
+
 private:
-    OrderBook* m_orderBook;
+    Book* m_orderBook;
     MarketMakerApplication* m_mmApp; // Pointer back to the MarketMakerApp for sending messages
 
-    FIX::Mutex m_mutex;
-    bool m_quotingRunning;
+    FIX::Mutex m_mutex; // Guards starting and joining m_quotingThread
+    std::atomic<bool> m_quotingRunning; // The thread exists until stopQuoting()
+    std::atomic<bool> m_quotingActive;  // Passes run, and reach sessions, only while set
+    std::mutex m_quoteWakeMutex;
+    std::condition_variable m_quoteWake; // Wakes the quoting thread when either flag changes
     std::thread m_quotingThread;
     FIX::SessionID m_clientSessionID; // Stores the session ID of the connected trade client (for internal tracking)
 
     // Internal state for market making
     std::string generateNewClOrdID();
+    void recordFill(const std::string& symbol, long long qtyDelta, double price);
+    void bookFill(const std::string& symbol, long long qtyDelta, double price); // Caller holds m_positionMutex
+    void publishTrade(const std::string& symbol, long long qtyDelta, double price);
+
+    // A client fill waiting to be booked; qtyDelta is 0 when the order did not fill
+    struct ClientFill {
+        std::string symbol;
+        long long qtyDelta;
+        double price;
+
+        ClientFill() : qtyDelta(0), price(0.0) {}
+    };
+    // Matches one client order against `market` (a Book::MarketData) and builds its
+    // ExecutionReport. Nothing is booked or sent; a fill is returned in `fill`.
+    template <class MarketData>
+    FIX42::ExecutionReport matchClientOrder(const FIX42::NewOrderSingle& message, const MarketData& market,
+                                            ClientFill& fill);
+    // A rejected ExecutionReport (OrdStatus=8) for an order that could not be matched at all
+    FIX42::ExecutionReport rejectClientOrder(const FIX42::NewOrderSingle& message, const std::string& reason);
+
+    FillJournal* m_fillJournal;
+    Lock m_positionMutex; // Guards m_positions and keeps them in step with the journal
+    std::map<std::string, Position> m_positions;
+
+    // Unique across threads and restarts; see IdGenerator.h
+    IdGenerator m_quoteIds;
+    IdGenerator m_orderIds;
+    IdGenerator m_execIds;
+
     void manageQuotes(); // The core quoting logic function
+    bool canQuote(); // Some session to quote to is logged on
+    void routeQuoteAction(const QuoteBook::Action& action);
+    void acknowledgeLocally(const QuoteBook::Action& action);
+    bool sendUpstream(const QuoteBook::Action& action);
+    void recordQuoteLatency(const std::string& clOrdID, bool isFill); // Caller holds m_quoteMutex
+    void onStrategyExecutionReport(const FIX42::ExecutionReport& message);
+
+    // Round trip from sending a quote request upstream to its ack or fill
+    struct LatencyStats {
+        unsigned long long count;
+        long long totalUs;
+        long long maxUs;
+
+        LatencyStats() : count(0), totalUs(0), maxUs(0) {}
+    };
 
-    // Random number generation for mock quoting
-    std::mt19937 m_randGen;
-    std::uniform_int_distribution<> m_qtyDist;
+    ConflationBuffer* m_quoteUpdates;
 
-    // A map to track our own outstanding quotes (for future advanced features)
-    std::map<std::string, FIX::OrderID> m_clOrdIDtoOrderID; // Our ClOrdID -> Exchange OrderID for our own quotes
-    std::map<std::string, FIX42::NewOrderSingle> m_ourOpenQuotes; // Our ClOrdID -> original quote message
+    // What each pass quotes, shared with the backtester (see QuotingCycle.h). Only the
+    // quoting thread touches it; m_quoteMutex is held around the parts that reach
+    // m_ourOpenQuotes.
+    BasicQuotingCycle<QuotingModel> m_quoting;
+    std::unordered_map<std::string, size_t> m_quoteIndex; // Symbol -> kernel index
+    // Fires the quoting timers due now, routing any stale pulls; true if a pass is due
+    bool runQuoteTimers(bool refresh);
+    uint64_t m_quoteRefreshNs;
+    uint64_t m_nextRefreshNs;
+
+    MarketAnalytics* m_analytics;
+    std::vector<long> m_analyticsIndex; // Kernel index -> analytics index, -1 if not covered
+    TickStoreWriter* m_tickStore;
+    StrategyRuntime* m_strategyRuntime;
+
+    // Our own quotes: live state per symbol/side plus the requests needed to change it
+    Lock m_quoteMutex; // Guards m_ourOpenQuotes and m_clOrdIDtoOrderID
+    QuoteBook m_ourOpenQuotes;
+    RegionMap<std::string, FIX::OrderID> m_clOrdIDtoOrderID; // Our ClOrdID -> Exchange OrderID for our own quotes
+    std::vector<QuoteBook::Action> m_quoteActions; // Requests produced by the current cycle or timer
+    RegionUnorderedMap<std::string, std::chrono::steady_clock::time_point> m_quoteSentAt; // ClOrdID -> send time
+    LatencyStats m_ackLatency;
+    LatencyStats m_fillLatency;
 };
 
+extern template class BasicStrategyEngine<OrderBook, SignalKernel, MutexLock>;
+
 #endif // STRATEGY_ENGINE_H
@@ -0,0 +1,19 @@
+//
+// StrategyEngineFwd.h
+// HFT
+//
+#ifndef STRATEGY_ENGINE_FWD_H
+#define STRATEGY_ENGINE_FWD_H
+
+#include "OrderBookFwd.h"
+
+class SignalKernel;
+
+template <class Book, class QuotingModel, class Lock>
+class BasicStrategyEngine;
+
+// The market maker's engine: shared OrderBook, vectorised volatility/skew model,
+// positions and quote state behind mutexes
+typedef BasicStrategyEngine<OrderBook, SignalKernel, MutexLock> StrategyEngine;
+
+#endif // STRATEGY_ENGINE_FWD_H
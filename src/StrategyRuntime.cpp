@@ -0,0 +1,383 @@
+// src/StrategyRuntime.cpp
+// Built as C++20 (see CMakeLists.txt); must not include QuickFIX headers.
+#include "CoStrategy.h"
+#include "ThreadTopology.h"
+
+#include <iostream>
+#include <exception>
+
+namespace {
+
+const char kOrderPrefix[] = "MM-CO";
+const size_t kOrderPrefixLength = sizeof(kOrderPrefix) - 1;
+
+// Fills queued for a coroutine that has stopped consuming them are dropped past this
+const size_t kMaxQueuedFills = 65536;
+
+const uint64_t kTimerTickNs = 100000; // Sleeps and order timeouts to 0.1 ms
+
+} // namespace
+
+void StrategyTask::promise_type::unhandled_exception() {
+    try {
+        throw;
+    } catch (const std::exception& e) {
+        std::cerr << "StrategyRuntime: Strategy coroutine ended by exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "StrategyRuntime: Strategy coroutine ended by unknown exception" << std::endl;
+    }
+}
+
+// --- StrategyShard ---
+
+StrategyShard::StrategyShard(size_t index, const StrategyRuntime::OrderSender& sender)
+    : m_index(index), m_sender(sender), m_running(false),
+      m_orderIds((kOrderPrefix + std::to_string(index)).c_str()),
+      m_timers(kTimerTickNs, TscClock::nowNs())
+{}
+
+StrategyShard::~StrategyShard() {
+    stop();
+}
+
+void StrategyShard::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_thread = std::thread([this]() { run(); });
+}
+
+void StrategyShard::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void StrategyShard::spawn(const Body& body) {
+    Event event;
+    event.kind = Event::Spawn;
+    event.body = body;
+    enqueue(event);
+}
+
+void StrategyShard::postQuote(const std::string& symbol, const StrategyQuote& quote) {
+    Event event;
+    event.kind = Event::Quote;
+    event.symbol = symbol;
+    event.quote = quote;
+    enqueue(event);
+}
+
+void StrategyShard::postFill(const StrategyFill& fill) {
+    Event event;
+    event.kind = Event::Fill;
+    event.fill = fill;
+    enqueue(event);
+}
+
+void StrategyShard::postExecution(const StrategyExecution& execution) {
+    Event event;
+    event.kind = Event::Execution;
+    event.execution = execution;
+    enqueue(event);
+}
+
+void StrategyShard::enqueue(Event& event) {
+    size_t queued;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_pending.push_back(std::move(event));
+        queued = m_pending.size();
+    }
+    // Only the first event of a batch needs to wake the loop
+    if (queued == 1) {
+        m_wake.notify_one();
+    }
+}
+
+void StrategyShard::run() {
+    ThreadTopology::apply(ThreadTopology::Strategy);
+    std::vector<Event> events;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        auto ready = [this]() { return !m_pending.empty() || !m_running; };
+        if (m_timers.empty()) {
+            m_wake.wait(lock, ready);
+        } else {
+            uint64_t next = m_timers.nextExpiryNs();
+            uint64_t now = TscClock::nowNs();
+            m_wake.wait_for(lock, std::chrono::nanoseconds(next > now ? next - now : 0), ready);
+        }
+        if (!m_running) {
+            break;
+        }
+
+        // One swap takes every event; producers keep queuing into the other vector
+        events.swap(m_pending);
+        lock.unlock();
+
+        for (Event& event : events) {
+            dispatch(event);
+        }
+        events.clear();
+        fireTimers();
+
+        lock.lock();
+    }
+    lock.unlock();
+    destroySuspended();
+}
+
+void StrategyShard::dispatch(Event& event) {
+    switch (event.kind) {
+    case Event::Quote: {
+        m_latest[event.symbol] = event.quote;
+        auto it = m_quoteWaiters.find(event.symbol);
+        if (it == m_quoteWaiters.end() || it->second.empty()) {
+            return;
+        }
+        // Taken out first: resumed coroutines usually wait again straight away
+        std::vector<QuoteWaiter> waiters;
+        waiters.swap(it->second);
+        for (QuoteWaiter& waiter : waiters) {
+            *waiter.target = event.quote;
+            waiter.handle.resume();
+        }
+        return;
+    }
+    case Event::Fill: {
+        auto it = m_fills.find(event.fill.symbol);
+        if (it == m_fills.end()) {
+            return; // No strategy follows this symbol's fills
+        }
+        FillQueue& queue = it->second;
+        if (queue.waiter) {
+            std::coroutine_handle<> waiter = queue.waiter;
+            *queue.target = event.fill;
+            queue.waiter = nullptr;
+            queue.target = nullptr;
+            waiter.resume();
+            return;
+        }
+        if (queue.fills.size() >= kMaxQueuedFills) {
+            std::cerr << "StrategyRuntime: Fill queue for " << event.fill.symbol << " is full, dropping the oldest" << std::endl;
+            queue.fills.pop_front();
+        }
+        queue.fills.push_back(event.fill);
+        return;
+    }
+    case Event::Execution:
+        onExecution(event.execution);
+        return;
+    case Event::Spawn:
+        try {
+            event.body(*this); // The coroutine runs up to its first suspension here
+        } catch (const std::exception& e) {
+            std::cerr << "StrategyRuntime: Could not start strategy: " << e.what() << std::endl;
+        }
+        return;
+    }
+}
+
+void StrategyShard::onExecution(const StrategyExecution& execution) {
+    auto it = m_orders.find(execution.clOrdID);
+    if (it == m_orders.end()) {
+        return; // Timed out already; its fills still arrive through postFill
+    }
+    PendingOrder& pending = it->second;
+    StrategyReport& report = *pending.report;
+    switch (execution.type) {
+    case StrategyExecution::New:
+        if (pending.immediateOrCancel) {
+            return; // Keep waiting for the outcome
+        }
+        report.status = StrategyReport::Acked;
+        break;
+    case StrategyExecution::Fill:
+        report.filledQty += execution.lastQty;
+        pending.notional += execution.lastQty * execution.lastPx;
+        report.avgPrice = report.filledQty > 0 ? pending.notional / report.filledQty : 0.0;
+        if (execution.leavesQty > 0) {
+            return;
+        }
+        report.status = StrategyReport::Filled;
+        break;
+    case StrategyExecution::Canceled:
+        report.status = StrategyReport::Canceled;
+        break;
+    case StrategyExecution::Rejected:
+        report.status = StrategyReport::Rejected;
+        report.text = execution.text;
+        break;
+    default:
+        return;
+    }
+    std::coroutine_handle<> handle = pending.handle;
+    m_timers.cancel(pending.timeout);
+    m_orders.erase(it);
+    handle.resume();
+}
+
+void StrategyShard::fireTimers() {
+    m_timers.advance(TscClock::nowNs(), [this](const Timer& timer) {
+        if (timer.handle) {
+            timer.handle.resume();
+            return;
+        }
+        auto it = m_orders.find(*timer.clOrdID); // Still there: an answer cancels the timeout
+        PendingOrder pending = it->second;
+        m_orders.erase(it);
+        pending.report->status = StrategyReport::TimedOut;
+        pending.handle.resume();
+    });
+}
+
+void StrategyShard::destroySuspended() {
+    // Every suspended coroutine waits in exactly one of these; order timeouts carry no handle
+    for (auto& entry : m_quoteWaiters) {
+        for (QuoteWaiter& waiter : entry.second) {
+            waiter.handle.destroy();
+        }
+    }
+    for (auto& entry : m_fills) {
+        if (entry.second.waiter) {
+            entry.second.waiter.destroy();
+        }
+    }
+    for (auto& entry : m_orders) {
+        entry.second.handle.destroy();
+    }
+    m_timers.clear([](Timer& timer) {
+        if (timer.handle) {
+            timer.handle.destroy();
+        }
+    });
+    m_quoteWaiters.clear();
+    m_fills.clear();
+    m_orders.clear();
+}
+
+void StrategyShard::waitQuote(const std::string& symbol, std::coroutine_handle<> handle, StrategyQuote* target) {
+    m_quoteWaiters[symbol].push_back(QuoteWaiter{handle, target});
+}
+
+bool StrategyShard::takeFill(const std::string& symbol, StrategyFill& fill) {
+    FillQueue& queue = m_fills[symbol]; // First call starts queuing for symbol
+    if (queue.fills.empty()) {
+        return false;
+    }
+    fill = queue.fills.front();
+    queue.fills.pop_front();
+    return true;
+}
+
+bool StrategyShard::hasFill(const std::string& symbol) const {
+    auto it = m_fills.find(symbol);
+    return it != m_fills.end() && !it->second.fills.empty();
+}
+
+void StrategyShard::waitFill(const std::string& symbol, std::coroutine_handle<> handle, StrategyFill* target) {
+    FillQueue& queue = m_fills[symbol];
+    if (queue.waiter) {
+        std::cerr << "StrategyRuntime: Two strategies wait on fills in " << symbol << "; only the last is resumed" << std::endl;
+    }
+    queue.waiter = handle;
+    queue.target = target;
+}
+
+bool StrategyShard::sendOrder(StrategyOrder& order, Clock::duration timeout, std::coroutine_handle<> handle,
+                              StrategyReport* report) {
+    if (order.qty == 0 || order.limitPrice <= 0.0) {
+        report->status = StrategyReport::Rejected;
+        report->text = "Invalid quantity or price";
+        return false; // Resumes at once
+    }
+    order.clOrdID = m_orderIds.next().str();
+    // Registered before sending: the first report can be queued before the sender returns
+    auto pending = m_orders.emplace(order.clOrdID, PendingOrder{handle, report, order.immediateOrCancel, 0.0, 0}).first;
+    if (!m_sender || !m_sender(order)) {
+        m_orders.erase(order.clOrdID);
+        report->status = StrategyReport::NotSent;
+        return false;
+    }
+    pending->second.timeout = addTimer(deadlineAfter(timeout), nullptr, &pending->first);
+    return true;
+}
+
+StrategyShard::TimerQueue::TimerId StrategyShard::addTimer(uint64_t deadlineNs, std::coroutine_handle<> handle,
+                                                         const std::string* clOrdID) {
+    return m_timers.schedule(deadlineNs, Timer{handle, clOrdID});
+}
+
+const StrategyQuote* StrategyShard::latestQuote(const std::string& symbol) const {
+    auto it = m_latest.find(symbol);
+    return it != m_latest.end() ? &it->second : nullptr;
+}
+
+// --- StrategyRuntime ---
+
+StrategyRuntime::StrategyRuntime(size_t shardCount, const OrderSender& sender) {
+    for (size_t i = 0; i < (shardCount > 0 ? shardCount : 1); ++i) {
+        m_shards.emplace_back(new StrategyShard(i, sender));
+    }
+}
+
+StrategyRuntime::~StrategyRuntime() {
+    stop();
+}
+
+void StrategyRuntime::start() {
+    for (auto& shard : m_shards) {
+        shard->start();
+    }
+}
+
+void StrategyRuntime::stop() {
+    for (auto& shard : m_shards) {
+        shard->stop();
+    }
+}
+
+StrategyShard& StrategyRuntime::shardFor(const std::string& symbol) {
+    return *m_shards[std::hash<std::string>()(symbol) % m_shards.size()];
+}
+
+void StrategyRuntime::postQuote(const std::string& symbol, double bid, double ask, double bidSize, double askSize) {
+    shardFor(symbol).postQuote(symbol, StrategyQuote{bid, ask, bidSize, askSize});
+}
+
+void StrategyRuntime::postFill(const std::string& symbol, long long qty, double price) {
+    shardFor(symbol).postFill(StrategyFill{symbol, qty, price});
+}
+
+void StrategyRuntime::postExecution(const StrategyExecution& execution) {
+    // The shard that sent the order is encoded after the prefix: MM-CO<shard>-...
+    size_t index = 0;
+    size_t position = kOrderPrefixLength;
+    const std::string& id = execution.clOrdID;
+    for (; position < id.size() && id[position] >= '0' && id[position] <= '9'; ++position) {
+        index = index * 10 + static_cast<size_t>(id[position] - '0');
+    }
+    if (!isStrategyOrder(id) || position == kOrderPrefixLength || index >= m_shards.size()) {
+        std::cerr << "StrategyRuntime: ExecutionReport for unknown strategy order " << id << std::endl;
+        return;
+    }
+    m_shards[index]->postExecution(execution);
+}
+
+bool StrategyRuntime::isStrategyOrder(const std::string& clOrdID) {
+    return clOrdID.compare(0, kOrderPrefixLength, kOrderPrefix) == 0;
+}
@@ -0,0 +1,113 @@
+//
+// StrategyRuntime.h
+// HFT
+//
+#ifndef STRATEGY_RUNTIME_H
+#define STRATEGY_RUNTIME_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+// Event loops for coroutine strategies (see CoStrategy.h).
+//
+// Symbols are sharded over a fixed number of single-threaded loops. Market data,
+// fills and execution reports are posted in from the feed and FIX threads; each loop
+// resumes the coroutines waiting on them inline, so a strategy's multi-step
+// workflow (fill -> hedge -> ack -> re-hedge) runs without any further thread switch.
+//
+// This header is plain C++14 so StrategyEngine and main can drive the runtime. The
+// coroutine side is C++20 and lives in its own translation units, which must not
+// include QuickFIX headers (their dynamic exception specifications stop at C++14).
+
+struct StrategyQuote {
+    double bid;
+    double ask;
+    double bidSize;
+    double askSize;
+};
+
+// A fill in one of our symbols: client orders, our quotes and strategy orders alike
+struct StrategyFill {
+    std::string symbol;
+    long long qty; // Signed: positive when we bought
+    double price;
+};
+
+// A strategy order; the runtime assigns the ClOrdID
+struct StrategyOrder {
+    std::string clOrdID;
+    std::string symbol;
+    long long qty; // Signed: positive buys
+    double limitPrice;
+    bool immediateOrCancel;
+
+    StrategyOrder() : qty(0), limitPrice(0.0), immediateOrCancel(true) {}
+};
+
+// Outcome of an order once the strategy is resumed
+struct StrategyReport {
+    enum Status {
+        Acked,    // Resting (only awaited up to the ack when not immediateOrCancel)
+        Filled,
+        Canceled, // Done with filledQty < qty (IOC remainder)
+        Rejected,
+        TimedOut, // No final report within the timeout; later fills still arrive as fills
+        NotSent   // No venue session
+    };
+
+    Status status;
+    long long filledQty; // Unsigned total
+    double avgPrice;
+    std::string text;
+
+    StrategyReport() : status(NotSent), filledQty(0), avgPrice(0.0) {}
+};
+
+// The parts of an ExecutionReport for a strategy order the runtime needs
+struct StrategyExecution {
+    enum Type { New, Fill, Canceled, Rejected, Other };
+
+    std::string clOrdID;
+    Type type;
+    long long lastQty;
+    double lastPx;
+    long long leavesQty;
+    std::string text;
+
+    StrategyExecution() : type(Other), lastQty(0), lastPx(0.0), leavesQty(0) {}
+};
+
+class StrategyShard; // CoStrategy.h
+
+class StrategyRuntime {
+public:
+    // Sends a strategy order to the venue; false when it could not be sent.
+    // Called on the shard's loop thread.
+    typedef std::function<bool(const StrategyOrder& order)> OrderSender;
+
+    StrategyRuntime(size_t shardCount, const OrderSender& sender);
+    ~StrategyRuntime();
+
+    void start();
+    void stop(); // Destroys every coroutine still suspended
+
+    size_t shardCount() const { return m_shards.size(); }
+    StrategyShard& shard(size_t index) { return *m_shards[index]; }
+    StrategyShard& shardFor(const std::string& symbol);
+
+    // Any thread. Quotes and fills go to the symbol's shard, so strategies trade the
+    // symbols of the shard they run on.
+    void postQuote(const std::string& symbol, double bid, double ask, double bidSize, double askSize);
+    void postFill(const std::string& symbol, long long qty, double price);
+    void postExecution(const StrategyExecution& execution);
+
+    // ClOrdIDs the runtime issued ("MM-CO<shard>-...")
+    static bool isStrategyOrder(const std::string& clOrdID);
+
+private:
+    std::vector<std::unique_ptr<StrategyShard> > m_shards;
+};
+
+#endif // STRATEGY_RUNTIME_H
@@ -0,0 +1,242 @@
+// src/ThreadTopology.cpp
+#include "ThreadTopology.h"
+
+#include <alloca.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+const char* const kRoleNames[ThreadTopology::RoleCount] = { "Feed", "Strategy", "Fix", "Background", "Orders" };
+// Thread names are limited to 15 characters
+const char* const kThreadNames[ThreadTopology::RoleCount] = { "mm-feed", "mm-strategy", "mm-fix", "mm-background", "mm-orders" };
+
+#ifdef __linux__
+const int kMpolPreferred = 1; // MPOL_PREFERRED from <numaif.h>; avoids a libnuma dependency
+#endif
+
+thread_local bool t_applied = false;
+
+// Faults in `bytes` of stack below the caller, from the top down as the stack grows
+__attribute__((noinline)) void prefaultStack(size_t bytes) {
+    volatile char* stack = static_cast<volatile char*>(alloca(bytes));
+    for (size_t offset = bytes; offset > 0; offset = offset > 4096 ? offset - 4096 : 0) {
+        stack[offset - 1] = 0;
+    }
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+// "2", "2,3" or "2-5,8"
+bool parseCpuList(const std::string& value, std::vector<int>& cpus) {
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item = trim(item);
+        size_t dash = item.find('-');
+        char* end = nullptr;
+        long first = std::strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (dash != std::string::npos) {
+            last = std::strtol(item.c_str() + dash + 1, &end, 10);
+        }
+        if (item.empty() || *end != '\0' || first < 0 || last < first || last >= CPU_SETSIZE) {
+            return false;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    return true;
+}
+
+bool parsePolicy(const std::string& value, int& policy) {
+    if (value == "other") {
+        policy = SCHED_OTHER;
+    } else if (value == "fifo") {
+        policy = SCHED_FIFO;
+    } else if (value == "rr") {
+        policy = SCHED_RR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseInt(const std::string& value, int& out) {
+    char* end = nullptr;
+    long parsed = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0') {
+        return false;
+    }
+    out = static_cast<int>(parsed);
+    return true;
+}
+
+} // namespace
+
+ThreadTopology::RoleConfig ThreadTopology::s_roles[ThreadTopology::RoleCount];
+
+ThreadTopology::RoleConfig::RoleConfig() : policy(SCHED_OTHER), priority(0), numaNode(-1), stackPrefaultKB(256) {}
+
+const ThreadTopology::RoleConfig& ThreadTopology::config(Role role) {
+    return s_roles[role];
+}
+
+const char* ThreadTopology::roleName(Role role) {
+    return role < RoleCount ? kRoleNames[role] : "?";
+}
+
+bool ThreadTopology::load(const std::string& configFile) {
+    std::ifstream in(configFile.c_str());
+    if (!in) {
+        std::cerr << "ThreadTopology: Cannot open " << configFile << std::endl;
+        return false;
+    }
+
+    bool ok = true;
+    bool inSection = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        if (line[0] == '[') {
+            inSection = line == "[THREADS]";
+            continue;
+        }
+        if (!inSection) {
+            continue;
+        }
+
+        size_t equals = line.find('=');
+        std::string key = trim(line.substr(0, equals));
+        std::string value = equals == std::string::npos ? "" : trim(line.substr(equals + 1));
+
+        int role = 0;
+        while (role < RoleCount && key.compare(0, std::strlen(kRoleNames[role]), kRoleNames[role]) != 0) {
+            ++role;
+        }
+        if (role == RoleCount) {
+            std::cerr << "ThreadTopology: Unknown role in " << key << std::endl;
+            ok = false;
+            continue;
+        }
+
+        RoleConfig& config = s_roles[role];
+        std::string setting = key.substr(std::strlen(kRoleNames[role]));
+        bool valid = false;
+        if (setting == "Cpu") {
+            config.cpus.clear();
+            valid = parseCpuList(value, config.cpus);
+        } else if (setting == "Policy") {
+            valid = parsePolicy(value, config.policy);
+        } else if (setting == "Priority") {
+            valid = parseInt(value, config.priority);
+        } else if (setting == "NumaNode") {
+            valid = parseInt(value, config.numaNode) && config.numaNode < 64;
+        } else if (setting == "StackPrefaultKB") {
+            valid = parseInt(value, config.stackPrefaultKB) && config.stackPrefaultKB >= 0 &&
+                    config.stackPrefaultKB <= 4096;
+        }
+        if (!valid) {
+            std::cerr << "ThreadTopology: Bad setting " << key << "=" << value << std::endl;
+            ok = false;
+        }
+    }
+
+    for (int role = 0; role < RoleCount; ++role) {
+        const RoleConfig& config = s_roles[role];
+        if (config.cpus.empty() && config.policy == SCHED_OTHER && config.numaNode < 0) {
+            continue;
+        }
+        std::cout << "ThreadTopology: " << kRoleNames[role] << " -> cpus";
+        for (int cpu : config.cpus) {
+            std::cout << " " << cpu;
+        }
+        std::cout << (config.cpus.empty() ? " any" : "")
+                  << ", policy " << (config.policy == SCHED_FIFO ? "fifo" : config.policy == SCHED_RR ? "rr" : "other")
+                  << " " << config.priority << ", numa node " << config.numaNode << std::endl;
+    }
+    return ok;
+}
+
+void ThreadTopology::apply(Role role) {
+    t_applied = true;
+    const RoleConfig& config = s_roles[role];
+    pthread_t self = pthread_self();
+
+#ifdef __APPLE__
+    pthread_setname_np(kThreadNames[role]);
+#else
+    pthread_setname_np(self, kThreadNames[role]);
+#endif
+
+#ifdef __linux__
+    if (!config.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : config.cpus) {
+            CPU_SET(cpu, &set);
+        }
+        int rc = pthread_setaffinity_np(self, sizeof(set), &set);
+        if (rc != 0) {
+            std::cerr << "ThreadTopology: Cannot pin " << kRoleNames[role] << " thread: " << std::strerror(rc) << std::endl;
+        }
+    }
+
+    if (config.numaNode >= 0) {
+        // Pages this thread touches first come from its node from now on
+        unsigned long nodeMask = 1UL << config.numaNode;
+        if (syscall(SYS_set_mempolicy, kMpolPreferred, &nodeMask, sizeof(nodeMask) * 8 + 1) != 0) {
+            std::cerr << "ThreadTopology: Cannot prefer NUMA node " << config.numaNode << " for "
+                      << kRoleNames[role] << ": " << std::strerror(errno) << std::endl;
+        }
+    }
+#else
+    if (!config.cpus.empty() || config.numaNode >= 0) {
+        std::cerr << "ThreadTopology: CPU pinning and NUMA placement are not supported on this platform" << std::endl;
+    }
+#endif
+
+    if (config.policy != SCHED_OTHER) {
+        sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = config.priority;
+        int rc = pthread_setschedparam(self, config.policy, &param);
+        if (rc != 0) {
+            std::cerr << "ThreadTopology: Cannot set scheduling policy for " << kRoleNames[role] << " thread: "
+                      << std::strerror(rc) << std::endl;
+        }
+    }
+
+    // After the NUMA policy, so the stack pages come from the preferred node
+    if (config.stackPrefaultKB > 0) {
+        prefaultStack(static_cast<size_t>(config.stackPrefaultKB) * 1024);
+    }
+}
+
+void ThreadTopology::applyOnce(Role role) {
+    if (!t_applied) {
+        apply(role);
+    }
+}
@@ -0,0 +1,57 @@
+//
+// ThreadTopology.h
+// HFT
+//
+#ifndef THREAD_TOPOLOGY_H
+#define THREAD_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+// Where each thread role runs: CPU affinity, scheduling policy and NUMA node,
+// read from the [THREADS] section of the config file. Every thread we create
+// calls apply() first thing with its role; QuickFIX's I/O threads are not ours,
+// so MarketMakerApp calls applyOnce() from its callbacks instead.
+//
+// A role with no settings is only named (for top -H, perf, gdb). Failures to pin
+// or raise priority (e.g. no CAP_SYS_NICE) are reported and otherwise ignored.
+class ThreadTopology {
+public:
+    enum Role {
+        Feed,       // Market data in; the OrderBook is updated on this thread too
+        Strategy,   // Quoting cycle
+        Fix,        // QuickFIX socket threads (acceptor and initiator)
+        Background, // Snapshot writer, metrics endpoint: keep these off the hot cores
+        Orders,     // Batched client order handling (OrderBatcher)
+        RoleCount
+    };
+
+    struct RoleConfig {
+        std::vector<int> cpus; // Empty: leave affinity alone
+        int policy;            // SCHED_OTHER / SCHED_FIFO / SCHED_RR
+        int priority;          // For FIFO/RR
+        int numaNode;          // -1: leave the memory policy alone
+        int stackPrefaultKB;   // Stack touched by apply() so deep calls later do not fault; 0: none
+
+        RoleConfig();
+    };
+
+    // Parses [THREADS] from configFile. Keys are <Role><Setting>, e.g.
+    //   FeedCpu=2  StrategyCpu=3,4  FixPolicy=fifo  FixPriority=50  StrategyNumaNode=0
+    //   StrategyStackPrefaultKB=512
+    // Call before starting any threads. Returns false if a value is malformed.
+    static bool load(const std::string& configFile);
+
+    // Names the calling thread and applies its role's placement
+    static void apply(Role role);
+    // As apply(), but only the first time a given thread calls it
+    static void applyOnce(Role role);
+
+    static const RoleConfig& config(Role role);
+    static const char* roleName(Role role);
+
+private:
+    static RoleConfig s_roles[RoleCount];
+};
+
+#endif // THREAD_TOPOLOGY_H
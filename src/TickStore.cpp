@@ -0,0 +1,537 @@
+// src/TickStore.cpp
+#include "TickStore.h"
+#include "ThreadTopology.h"
+
+#include <iostream>
+#include <chrono>
+#include <limits>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+int64_t wallClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void copySymbol(char (&dest)[16], const std::string& symbol) {
+    std::memset(dest, 0, sizeof(dest));
+    std::strncpy(dest, symbol.c_str(), sizeof(dest) - 1);
+}
+
+std::string readSymbol(const char (&source)[16]) {
+    return std::string(source, strnlen(source, sizeof(source)));
+}
+
+bool writeAll(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, p, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// Column data is padded so every block header stays 8-byte aligned in the file
+size_t padded(size_t bytes) {
+    return (bytes + 7) & ~size_t(7);
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+template <class T>
+void pack(const uint64_t* values, size_t count, char* out) {
+    for (size_t i = 0; i < count; ++i) {
+        T narrow = static_cast<T>(values[i]);
+        std::memcpy(out + i * sizeof(T), &narrow, sizeof(T));
+    }
+}
+
+// Fixed width, no branches in the loop: vectorised by the compiler
+template <class T>
+void widen(const char* data, size_t count, int64_t* out) {
+    for (size_t i = 0; i < count; ++i) {
+        T narrow;
+        std::memcpy(&narrow, data + i * sizeof(T), sizeof(T));
+        out[i] = static_cast<int64_t>(static_cast<uint64_t>(narrow));
+    }
+}
+
+const size_t kColumnCounts[] = { TickStoreFormat::QuoteColumnCount, TickStoreFormat::FillColumnCount };
+
+// Offset just past the last complete, well-formed block of a partition file, walking
+// the headers the same way TickStoreReader::open does. Whatever follows was cut
+// short by a crash or a failed write.
+off_t completeBlocksEnd(int fd, uint32_t kind, off_t fileSize) {
+    off_t offset = 0;
+    TickStoreFormat::BlockHeader header;
+    TickStoreFormat::ColumnHeader columns[TickStoreFormat::QuoteColumnCount];
+    while (offset + static_cast<off_t>(sizeof(header)) <= fileSize) {
+        if (::pread(fd, &header, sizeof(header), offset) != static_cast<ssize_t>(sizeof(header)) ||
+            std::memcmp(header.magic, TickStoreFormat::kBlockMagic, sizeof(header.magic)) != 0 ||
+            header.kind != kind || header.columnCount != kColumnCounts[kind]) {
+            break;
+        }
+        size_t columnBytes = header.columnCount * sizeof(TickStoreFormat::ColumnHeader);
+        if (::pread(fd, columns, columnBytes, offset + sizeof(header)) != static_cast<ssize_t>(columnBytes)) {
+            break;
+        }
+        size_t expected = 0;
+        for (uint32_t c = 0; c < header.columnCount; ++c) {
+            expected += padded(static_cast<size_t>(header.rowCount) * columns[c].width);
+        }
+        off_t total = static_cast<off_t>(sizeof(header) + columnBytes + header.dataBytes);
+        if (expected != header.dataBytes || offset + total > fileSize) {
+            break;
+        }
+        offset += total;
+    }
+    return offset;
+}
+
+} // namespace
+
+// --- Format ---
+
+const char* TickStoreFormat::kindName(uint32_t kind) {
+    return kind == Fills ? "fills" : "quotes";
+}
+
+std::string TickStoreFormat::dayOf(int64_t timeNs) {
+    time_t seconds = static_cast<time_t>(timeNs / 1000000000LL);
+    struct tm utc;
+    gmtime_r(&seconds, &utc);
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y%m%d", &utc);
+    return buffer;
+}
+
+bool TickStoreFormat::parseDay(const std::string& day, int64_t& midnightNs) {
+    if (day.size() != 8 || day.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    struct tm utc;
+    std::memset(&utc, 0, sizeof(utc));
+    utc.tm_year = std::atoi(day.substr(0, 4).c_str()) - 1900;
+    utc.tm_mon = std::atoi(day.substr(4, 2).c_str()) - 1;
+    utc.tm_mday = std::atoi(day.substr(6, 2).c_str());
+    time_t seconds = timegm(&utc);
+    if (seconds == static_cast<time_t>(-1)) {
+        return false;
+    }
+    midnightNs = static_cast<int64_t>(seconds) * 1000000000LL;
+    return true;
+}
+
+void TickStoreFormat::encodeColumn(const int64_t* values, size_t count, Encoding encoding, ColumnHeader& header,
+                                   std::vector<char>& out) {
+    std::memset(&header, 0, sizeof(header));
+    header.encoding = encoding;
+    if (count == 0) {
+        return;
+    }
+
+    // Unsigned arithmetic: deltas between extreme values wrap and unwrap exactly
+    std::vector<uint64_t> packed(count);
+    if (encoding == DeltaZigZag) {
+        header.base = values[0];
+        packed[0] = 0;
+        for (size_t i = 1; i < count; ++i) {
+            packed[i] = zigzag(static_cast<int64_t>(static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(values[i - 1])));
+        }
+    } else {
+        header.base = *std::min_element(values, values + count);
+        for (size_t i = 0; i < count; ++i) {
+            packed[i] = static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(header.base);
+        }
+    }
+
+    uint64_t largest = *std::max_element(packed.begin(), packed.end());
+    header.width = largest == 0 ? 0 : largest <= 0xFF ? 1 : largest <= 0xFFFF ? 2 : largest <= 0xFFFFFFFFULL ? 4 : 8;
+
+    size_t start = out.size();
+    out.resize(start + padded(count * header.width), 0);
+    char* target = out.data() + start;
+    switch (header.width) {
+    case 1: pack<uint8_t>(packed.data(), count, target); break;
+    case 2: pack<uint16_t>(packed.data(), count, target); break;
+    case 4: pack<uint32_t>(packed.data(), count, target); break;
+    case 8: pack<uint64_t>(packed.data(), count, target); break;
+    default: break;
+    }
+}
+
+void TickStoreFormat::decodeColumn(const ColumnHeader& header, const char* data, size_t count, int64_t* values) {
+    switch (header.width) {
+    case 1: widen<uint8_t>(data, count, values); break;
+    case 2: widen<uint16_t>(data, count, values); break;
+    case 4: widen<uint32_t>(data, count, values); break;
+    case 8: widen<uint64_t>(data, count, values); break;
+    default: std::fill(values, values + count, 0); break;
+    }
+
+    if (header.encoding == FrameOfReference) {
+        uint64_t base = static_cast<uint64_t>(header.base);
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = static_cast<int64_t>(static_cast<uint64_t>(values[i]) + base);
+        }
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = unzigzag(static_cast<uint64_t>(values[i]));
+    }
+    uint64_t running = static_cast<uint64_t>(header.base);
+    for (size_t i = 0; i < count; ++i) {
+        running += static_cast<uint64_t>(values[i]);
+        values[i] = static_cast<int64_t>(running);
+    }
+}
+
+// --- TickStoreWriter ---
+
+TickStoreWriter::TickStoreWriter(const std::string& root, size_t blockRows, int maxBlockAgeMs)
+    : m_root(root), m_blockRows(blockRows > 0 ? blockRows : 1),
+      m_maxBlockAgeMs(maxBlockAgeMs > 0 ? maxBlockAgeMs : 0),
+      m_running(false), m_rowsWritten(0), m_bytesWritten(0)
+{
+    ::mkdir(m_root.c_str(), 0755);
+}
+
+TickStoreWriter::~TickStoreWriter() {
+    stop();
+}
+
+void TickStoreWriter::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_thread = std::thread([this]() { run(); });
+}
+
+void TickStoreWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void TickStoreWriter::recordQuote(const std::string& symbol, double bid, double ask, double bidSize, double askSize,
+                                  int64_t timeNs) {
+    Event event;
+    event.timeNs = timeNs;
+    event.kind = TickStoreFormat::Quotes;
+    copySymbol(event.symbol, symbol);
+    event.values[0] = TickStoreFormat::toScaled(bid);
+    event.values[1] = TickStoreFormat::toScaled(ask) - event.values[0];
+    event.values[2] = static_cast<int64_t>(bidSize);
+    event.values[3] = static_cast<int64_t>(askSize);
+    enqueue(event);
+}
+
+void TickStoreWriter::recordFill(const std::string& symbol, long long qtyDelta, double price, int64_t timeNs) {
+    Event event;
+    event.timeNs = timeNs;
+    event.kind = TickStoreFormat::Fills;
+    copySymbol(event.symbol, symbol);
+    event.values[0] = TickStoreFormat::toScaled(price);
+    event.values[1] = qtyDelta;
+    event.values[2] = 0;
+    event.values[3] = 0;
+    enqueue(event);
+}
+
+void TickStoreWriter::enqueue(const Event& event) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        m_pending.push_back(event);
+    }
+}
+
+void TickStoreWriter::run() {
+    ThreadTopology::apply(ThreadTopology::Background);
+    RegionVector<Event> events; // Swapped with m_pending; both keep their capacity
+    bool running = true;
+    while (running) {
+        {
+            // Producers never signal: the writer polls, so recording costs one uncontended lock
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait_for(lock, std::chrono::milliseconds(50), [this]() { return !m_running; });
+            events.swap(m_pending);
+            running = m_running;
+        }
+
+        int64_t now = wallClockNs();
+        for (const Event& event : events) {
+            append(event, now);
+        }
+        events.clear();
+
+        for (auto& entry : m_partitions) {
+            Partition& partition = entry.second;
+            bool stale = partition.oldestRowNs != 0 &&
+                         now - partition.oldestRowNs >= static_cast<int64_t>(m_maxBlockAgeMs) * 1000000LL;
+            if (!running || stale) {
+                writeBlock(entry.first, partition);
+            }
+        }
+    }
+    for (auto& entry : m_partitions) {
+        closePartition(entry.first, entry.second);
+    }
+    m_partitions.clear();
+}
+
+void TickStoreWriter::append(const Event& event, int64_t nowNs) {
+    std::string symbol = readSymbol(event.symbol);
+    std::string key = symbol + "." + TickStoreFormat::kindName(event.kind);
+    Partition& partition = m_partitions[key];
+
+    std::string day = TickStoreFormat::dayOf(event.timeNs);
+    if (partition.day != day) {
+        // Midnight UTC: the old day's file gets its last block and a new file starts
+        closePartition(key, partition);
+        partition.day = day;
+        partition.lastTimeNs = 0;
+        if (!openPartition(symbol, event.kind, partition)) {
+            return;
+        }
+    }
+    if (partition.fd < 0) {
+        return; // Could not be opened; reported once for the day
+    }
+
+    // Rows from several producer threads can interleave slightly out of order
+    int64_t timeNs = event.timeNs > partition.lastTimeNs ? event.timeNs : partition.lastTimeNs;
+    partition.lastTimeNs = timeNs;
+    if (partition.columns[0].empty()) {
+        partition.oldestRowNs = nowNs;
+    }
+    size_t columnCount = kColumnCounts[event.kind];
+    partition.columns[0].push_back(timeNs);
+    for (size_t c = 1; c < columnCount; ++c) {
+        partition.columns[c].push_back(event.values[c - 1]);
+    }
+    if (partition.columns[0].size() >= m_blockRows) {
+        writeBlock(key, partition);
+    }
+}
+
+bool TickStoreWriter::openPartition(const std::string& symbol, uint32_t kind, Partition& partition) {
+    std::string directory = m_root + "/" + partition.day;
+    ::mkdir(directory.c_str(), 0755);
+    std::string path = directory + "/" + symbol + "." + TickStoreFormat::kindName(kind);
+    partition.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (partition.fd < 0) {
+        std::cerr << "TickStoreWriter: Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Reopened after a crash: drop a torn last block so new blocks follow a complete one
+    struct stat st;
+    if (::fstat(partition.fd, &st) != 0) {
+        std::cerr << "TickStoreWriter: Cannot stat " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(partition.fd);
+        partition.fd = -1;
+        return false;
+    }
+    partition.endOffset = completeBlocksEnd(partition.fd, kind, st.st_size);
+    if (partition.endOffset < st.st_size) {
+        std::cerr << "TickStoreWriter: Dropping " << st.st_size - partition.endOffset << " bytes of torn block at offset "
+                  << partition.endOffset << " in " << path << std::endl;
+        if (::ftruncate(partition.fd, partition.endOffset) != 0) {
+            std::cerr << "TickStoreWriter: Cannot truncate " << path << ": " << std::strerror(errno) << std::endl;
+            ::close(partition.fd);
+            partition.fd = -1;
+            return false;
+        }
+    }
+    return true;
+}
+
+void TickStoreWriter::writeBlock(const std::string& key, Partition& partition) {
+    size_t rows = partition.columns[0].size();
+    if (rows == 0 || partition.fd < 0) {
+        return;
+    }
+    uint32_t kind = key.compare(key.size() - 5, 5, "fills") == 0 ? TickStoreFormat::Fills : TickStoreFormat::Quotes;
+    size_t columnCount = kColumnCounts[kind];
+
+    TickStoreFormat::BlockHeader header;
+    std::memcpy(header.magic, TickStoreFormat::kBlockMagic, sizeof(header.magic));
+    header.kind = kind;
+    header.rowCount = static_cast<uint32_t>(rows);
+    header.columnCount = static_cast<uint32_t>(columnCount);
+    header.minTimeNs = partition.columns[0].front();
+    header.maxTimeNs = partition.columns[0].back();
+    header.minPrice = std::numeric_limits<int64_t>::max();
+    header.maxPrice = std::numeric_limits<int64_t>::min();
+    for (size_t i = 0; i < rows; ++i) {
+        int64_t low = partition.columns[1][i];
+        int64_t high = kind == TickStoreFormat::Quotes ? low + partition.columns[TickStoreFormat::QuoteSpread][i] : low;
+        header.minPrice = std::min(header.minPrice, low);
+        header.maxPrice = std::max(header.maxPrice, high);
+    }
+
+    // Headers first, column data appended behind them
+    size_t headerBytes = sizeof(header) + columnCount * sizeof(TickStoreFormat::ColumnHeader);
+    m_blockBuffer.assign(headerBytes, 0);
+    TickStoreFormat::ColumnHeader columnHeaders[TickStoreFormat::QuoteColumnCount];
+    for (size_t c = 0; c < columnCount; ++c) {
+        bool delta = c == 0 || c == 1; // Time and (bid) price move in small steps
+        TickStoreFormat::encodeColumn(partition.columns[c].data(), rows,
+                                      delta ? TickStoreFormat::DeltaZigZag : TickStoreFormat::FrameOfReference,
+                                      columnHeaders[c], m_blockBuffer);
+        partition.columns[c].clear();
+    }
+    header.dataBytes = m_blockBuffer.size() - headerBytes;
+    std::memcpy(m_blockBuffer.data(), &header, sizeof(header));
+    std::memcpy(m_blockBuffer.data() + sizeof(header), columnHeaders, columnCount * sizeof(TickStoreFormat::ColumnHeader));
+    partition.oldestRowNs = 0;
+
+    if (!writeAll(partition.fd, m_blockBuffer.data(), m_blockBuffer.size())) {
+        std::cerr << "TickStoreWriter: Write failed for " << partition.day << "/" << key << ": "
+                  << std::strerror(errno) << std::endl;
+        // Cut off whatever part of the block made it, so the next one starts on a boundary
+        if (::ftruncate(partition.fd, partition.endOffset) != 0) {
+            std::cerr << "TickStoreWriter: Cannot truncate " << partition.day << "/" << key << ", closing it: "
+                      << std::strerror(errno) << std::endl;
+            ::close(partition.fd);
+            partition.fd = -1;
+        }
+        return;
+    }
+    partition.endOffset += static_cast<off_t>(m_blockBuffer.size());
+    m_rowsWritten += rows;
+    m_bytesWritten += m_blockBuffer.size();
+}
+
+void TickStoreWriter::closePartition(const std::string& key, Partition& partition) {
+    writeBlock(key, partition);
+    if (partition.fd >= 0) {
+        ::close(partition.fd);
+        partition.fd = -1;
+    }
+}
+
+// --- TickStoreReader ---
+
+TickStoreReader::TickStoreReader()
+    : m_fd(-1), m_base(nullptr), m_size(0), m_kind(TickStoreFormat::Quotes), m_tornTail(false)
+{}
+
+TickStoreReader::~TickStoreReader() {
+    if (m_base) {
+        ::munmap(const_cast<char*>(m_base), m_size);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+std::string TickStoreReader::pathFor(const std::string& root, const std::string& day, const std::string& symbol,
+                                     uint32_t kind) {
+    return root + "/" + day + "/" + symbol + "." + TickStoreFormat::kindName(kind);
+}
+
+size_t TickStoreReader::columnCount() const {
+    return kColumnCounts[m_kind];
+}
+
+bool TickStoreReader::open(const std::string& path, std::string& error) {
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        error = "Cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0) {
+        error = "Cannot stat " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size == 0) {
+        return true;
+    }
+    void* mapped = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (mapped == MAP_FAILED) {
+        error = "Cannot map " + path + ": " + std::strerror(errno);
+        m_size = 0;
+        return false;
+    }
+    m_base = static_cast<const char*>(mapped);
+    ::madvise(mapped, m_size, MADV_SEQUENTIAL);
+
+    // Index the file by walking the block headers; no column data is touched
+    size_t offset = 0;
+    while (offset + sizeof(TickStoreFormat::BlockHeader) <= m_size) {
+        const TickStoreFormat::BlockHeader* header =
+            reinterpret_cast<const TickStoreFormat::BlockHeader*>(m_base + offset);
+        if (std::memcmp(header->magic, TickStoreFormat::kBlockMagic, sizeof(header->magic)) != 0 ||
+            header->kind > TickStoreFormat::Fills || header->columnCount != kColumnCounts[header->kind] ||
+            (!m_blocks.empty() && header->kind != m_kind)) {
+            error = "Corrupt block at offset " + std::to_string(offset) + " in " + path;
+            return false;
+        }
+        m_kind = header->kind;
+        size_t columnBytes = header->columnCount * sizeof(TickStoreFormat::ColumnHeader);
+        size_t total = sizeof(*header) + columnBytes + header->dataBytes;
+        if (offset + total > m_size) {
+            m_tornTail = true;
+            break;
+        }
+        BlockRef block;
+        block.header = header;
+        block.columns = reinterpret_cast<const TickStoreFormat::ColumnHeader*>(m_base + offset + sizeof(*header));
+        block.data = m_base + offset + sizeof(*header) + columnBytes;
+        size_t expected = 0;
+        for (uint32_t c = 0; c < header->columnCount; ++c) {
+            expected += padded(static_cast<size_t>(header->rowCount) * block.columns[c].width);
+        }
+        if (expected != header->dataBytes) {
+            error = "Column sizes do not match block size at offset " + std::to_string(offset) + " in " + path;
+            return false;
+        }
+        m_blocks.push_back(block);
+        offset += total;
+    }
+    if (offset < m_size && offset + sizeof(TickStoreFormat::BlockHeader) > m_size) {
+        m_tornTail = true;
+    }
+    return true;
+}
+
+void TickStoreReader::decode(const BlockRef& block) {
+    const char* data = block.data;
+    size_t rows = block.header->rowCount;
+    for (uint32_t c = 0; c < block.header->columnCount; ++c) {
+        m_decoded[c].resize(rows);
+        TickStoreFormat::decodeColumn(block.columns[c], data, rows, m_decoded[c].data());
+        data += padded(rows * block.columns[c].width);
+    }
+}
@@ -0,0 +1,241 @@
+//
+// TickStore.h
+// HFT
+//
+#ifndef TICK_STORE_H
+#define TICK_STORE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include <sys/types.h>
+
+#include "MemoryRegion.h"
+
+// Columnar, day-partitioned store of market data ticks and our fills.
+//
+// Layout: <root>/<YYYYMMDD>/<SYMBOL>.quotes and <SYMBOL>.fills (UTC days). Each
+// file is a sequence of self-describing blocks of up to blockRows rows:
+//
+//   BlockHeader | ColumnHeader x columnCount | packed column data
+//
+// Every column is int64 (prices in units of 1/kPriceScale) and is stored either
+//  - DeltaZigZag: first value in the column header, then zigzagged deltas, or
+//  - FrameOfReference: block minimum in the column header, then value - minimum
+// packed at the narrowest byte width (0, 1, 2, 4 or 8) that fits the block.
+// Timestamps and prices use deltas; spreads and sizes use frame of reference.
+// Fixed widths per block keep decoding to branch-free loops the compiler vectorises.
+//
+// Block headers carry min/max time and price, so a reader walks the headers and
+// decodes only the blocks a query can touch. Files are append-only; a block torn
+// by a crash is detected (its data runs past the end of the file) and ignored.
+namespace TickStoreFormat {
+
+const char kBlockMagic[4] = {'T', 'K', 'B', '1'};
+const double kPriceScale = 1e6;
+
+enum Kind : uint32_t { Quotes = 0, Fills = 1 };
+enum Encoding : uint8_t { DeltaZigZag = 0, FrameOfReference = 1 };
+
+// Quotes: time, bid, ask - bid, bid size, ask size. Fills: time, price, signed qty.
+enum QuoteColumn { QuoteTime, QuoteBid, QuoteSpread, QuoteBidSize, QuoteAskSize, QuoteColumnCount };
+enum FillColumn { FillTime, FillPrice, FillQty, FillColumnCount };
+
+struct BlockHeader {
+    char magic[4];
+    uint32_t kind;
+    uint32_t rowCount;
+    uint32_t columnCount;
+    uint64_t dataBytes;  // Packed column data following the column headers
+    int64_t minTimeNs;
+    int64_t maxTimeNs;
+    int64_t minPrice;    // Scaled; bid/ask for quotes, fill price for fills
+    int64_t maxPrice;
+};
+
+struct ColumnHeader {
+    uint8_t encoding;
+    uint8_t width;       // Bytes per packed value
+    uint8_t reserved[6];
+    int64_t base;        // First value (DeltaZigZag) or block minimum (FrameOfReference)
+};
+
+inline int64_t toScaled(double price) {
+    return static_cast<int64_t>(price * kPriceScale + (price < 0.0 ? -0.5 : 0.5));
+}
+
+inline double fromScaled(int64_t scaled) {
+    return static_cast<double>(scaled) / kPriceScale;
+}
+
+const char* kindName(uint32_t kind); // "quotes" / "fills", also the file extension
+
+// Partition directory name for a UTC timestamp, e.g. "20250606"
+std::string dayOf(int64_t timeNs);
+// Midnight UTC of a YYYYMMDD day in ns since the epoch; false if malformed
+bool parseDay(const std::string& day, int64_t& midnightNs);
+
+// Column codec, exposed for the reader and writer
+void encodeColumn(const int64_t* values, size_t count, Encoding encoding, ColumnHeader& header,
+                  std::vector<char>& out);
+void decodeColumn(const ColumnHeader& header, const char* data, size_t count, int64_t* values);
+
+} // namespace TickStoreFormat
+
+// Background writer fed from the live pipeline. Producers only copy the event into
+// a queue under a short lock; the writer thread partitions, encodes and appends.
+class TickStoreWriter {
+public:
+    // Rows per block trade compression for durability: a partial block is also
+    // written once its oldest row is older than maxBlockAgeMs
+    TickStoreWriter(const std::string& root, size_t blockRows, int maxBlockAgeMs);
+    ~TickStoreWriter();
+
+    void start();
+    void stop(); // Writes every partial block first
+
+    // Any thread; timeNs is wall-clock ns
+    void recordQuote(const std::string& symbol, double bid, double ask, double bidSize, double askSize,
+                     int64_t timeNs);
+    void recordFill(const std::string& symbol, long long qtyDelta, double price, int64_t timeNs);
+
+    uint64_t rowsWritten() const { return m_rowsWritten; }
+    uint64_t bytesWritten() const { return m_bytesWritten; }
+
+private:
+    struct Event {
+        int64_t timeNs;
+        uint32_t kind;
+        char symbol[16];
+        int64_t values[4]; // Columns after time, scaled
+    };
+
+    // Rows buffered for one day/symbol/kind file
+    struct Partition {
+        std::string day;
+        int fd;
+        off_t endOffset;     // End of the last complete block in the file
+        int64_t lastTimeNs;
+        int64_t oldestRowNs; // Wall clock when the first buffered row arrived
+        std::vector<int64_t> columns[TickStoreFormat::QuoteColumnCount];
+
+        Partition() : fd(-1), endOffset(0), lastTimeNs(0), oldestRowNs(0) {}
+    };
+
+    void run();
+    void enqueue(const Event& event);
+    void append(const Event& event, int64_t nowNs);
+    void writeBlock(const std::string& key, Partition& partition);
+    void closePartition(const std::string& key, Partition& partition);
+    bool openPartition(const std::string& symbol, uint32_t kind, Partition& partition);
+
+    std::string m_root;
+    size_t m_blockRows;
+    int m_maxBlockAgeMs;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    RegionVector<Event> m_pending; // Guarded by m_mutex
+    bool m_running;
+    std::thread m_thread;
+
+    // Writer thread only
+    std::map<std::string, Partition> m_partitions; // "<symbol>.<kind>" -> open partition
+    std::vector<char> m_blockBuffer;
+    uint64_t m_rowsWritten;
+    uint64_t m_bytesWritten;
+};
+
+// Memory-mapped reader for one partition file
+class TickStoreReader {
+public:
+    // One decoded block, trimmed to the query's time range
+    struct Batch {
+        size_t rows;
+        const int64_t* columns[TickStoreFormat::QuoteColumnCount]; // Column 0 is time
+    };
+
+    struct ScanStats {
+        size_t blocksRead;
+        size_t blocksSkipped;
+        size_t rows;
+        uint64_t bytesDecoded;
+
+        ScanStats() : blocksRead(0), blocksSkipped(0), rows(0), bytesDecoded(0) {}
+    };
+
+    TickStoreReader();
+    ~TickStoreReader();
+
+    bool open(const std::string& path, std::string& error);
+    static std::string pathFor(const std::string& root, const std::string& day, const std::string& symbol, uint32_t kind);
+
+    uint32_t kind() const { return m_kind; }
+    size_t columnCount() const;
+    size_t blockCount() const { return m_blocks.size(); }
+    size_t fileBytes() const { return m_size; }
+    bool tornTail() const { return m_tornTail; } // The last block was cut short and is ignored
+
+    // Calls fn(const Batch&) for every block overlapping [fromNs, toNs] whose price
+    // range overlaps [minPrice, maxPrice] (scaled; pass the int64 limits for any)
+    template <class Fn>
+    ScanStats scan(int64_t fromNs, int64_t toNs, int64_t minPrice, int64_t maxPrice, Fn&& fn);
+
+private:
+    struct BlockRef {
+        const TickStoreFormat::BlockHeader* header;
+        const TickStoreFormat::ColumnHeader* columns;
+        const char* data;
+    };
+
+    void decode(const BlockRef& block);
+
+    int m_fd;
+    const char* m_base;
+    size_t m_size;
+    uint32_t m_kind;
+    bool m_tornTail;
+    std::vector<BlockRef> m_blocks;
+    std::vector<int64_t> m_decoded[TickStoreFormat::QuoteColumnCount];
+};
+
+template <class Fn>
+TickStoreReader::ScanStats TickStoreReader::scan(int64_t fromNs, int64_t toNs, int64_t minPrice, int64_t maxPrice,
+                                                 Fn&& fn) {
+    ScanStats stats;
+    for (const BlockRef& block : m_blocks) {
+        const TickStoreFormat::BlockHeader& header = *block.header;
+        if (header.maxTimeNs < fromNs || header.minTimeNs > toNs ||
+            header.maxPrice < minPrice || header.minPrice > maxPrice) {
+            ++stats.blocksSkipped;
+            continue;
+        }
+        decode(block);
+        ++stats.blocksRead;
+        stats.bytesDecoded += header.dataBytes;
+
+        // Timestamps never go backwards within a partition, so the range is contiguous
+        const std::vector<int64_t>& time = m_decoded[0];
+        size_t begin = std::lower_bound(time.begin(), time.end(), fromNs) - time.begin();
+        size_t end = std::upper_bound(time.begin() + begin, time.end(), toNs) - time.begin();
+        if (begin == end) {
+            continue;
+        }
+        Batch batch;
+        batch.rows = end - begin;
+        for (size_t c = 0; c < TickStoreFormat::QuoteColumnCount; ++c) {
+            batch.columns[c] = c < header.columnCount ? m_decoded[c].data() + begin : nullptr;
+        }
+        stats.rows += batch.rows;
+        fn(batch);
+    }
+    return stats;
+}
+
+#endif // TICK_STORE_H
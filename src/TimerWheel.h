@@ -0,0 +1,348 @@
+//
+// TimerWheel.h
+// HFT
+//
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "MemoryRegion.h"
+
+// Hierarchical timing wheel: four levels of 256 slots each, so a wheel with a 1 ms tick
+// covers about 49 days before deadlines have to be parked and re-placed. Scheduling and
+// cancelling are O(1). advance() costs O(1) per expired timer, plus an occasional cascade
+// that moves one upper-level slot down a level. Occupancy bitmaps let advance() and
+// nextExpiryNs() skip empty slots without walking them.
+//
+// Timers are nodes in one pool, linked into their slot by index. A fired or cancelled
+// node goes onto a free list for reuse, so once the pool is reserved no timer allocates.
+// A TimerId carries the node's generation, so cancelling an id that has already fired,
+// or whose node was reused, is a harmless no-op. Zero is never a valid id.
+//
+// Deadlines are in TscClock::nowNs() nanoseconds (any monotonic ns clock works if it is
+// used consistently). They are rounded up to the next tick, so a timer never fires
+// early, and fires at most one tick plus the caller's polling interval late. The wheel
+// is not thread-safe. Each event loop owns its wheel, or guards it with the lock that
+// already protects the state its timers refer to.
+template <typename T>
+class TimerWheel {
+public:
+    typedef uint64_t TimerId;
+
+    TimerWheel(uint64_t tickNs, uint64_t startNs)
+        : m_tickNs(tickNs ? tickNs : 1), m_startNs(startNs), m_tick(0), m_size(0), m_freeHead(kNil) {
+        resetSlots();
+    }
+
+    // Grows the node pool up front so scheduling up to count timers never allocates
+    void reserve(size_t count) { m_nodes.reserve(count); }
+
+    TimerId schedule(uint64_t deadlineNs, const T& payload) { return schedule(deadlineNs, T(payload)); }
+
+    TimerId schedule(uint64_t deadlineNs, T&& payload) {
+        uint32_t index = allocate();
+        Node& node = m_nodes[index];
+        node.deadline = tickAtOrAfter(deadlineNs);
+        node.payload = std::move(payload);
+        node.active = true;
+        place(index);
+        ++m_size;
+        return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+    }
+
+    // False if the timer already fired or was cancelled
+    bool cancel(TimerId id) {
+        Node* node = find(id);
+        if (!node) {
+            return false;
+        }
+        uint32_t index = static_cast<uint32_t>(id & 0xffffffffu) - 1;
+        unlink(index);
+        release(index);
+        --m_size;
+        return true;
+    }
+
+    bool pending(TimerId id) const { return find(id) != nullptr; }
+
+    // Fires every timer whose deadline is at or before nowNs, in deadline-tick order,
+    // calling onExpire(T&) for each. The callback may schedule and cancel timers,
+    // including ones due in this same advance().
+    template <typename OnExpire>
+    size_t advance(uint64_t nowNs, OnExpire&& onExpire) {
+        if (nowNs < m_startNs) {
+            return 0;
+        }
+        uint64_t target = (nowNs - m_startNs) / m_tickNs;
+        size_t fired = 0;
+        while (m_tick <= target) {
+            uint64_t tick = m_tick;
+            if ((tick & kSlotMask) == 0) {
+                cascade(tick);
+            }
+            uint64_t due = nextEventTick();
+            if (due > target) {
+                m_tick = target + 1;
+                break;
+            }
+            if (due != tick && (due & kSlotMask) == 0) {
+                m_tick = due; // An upper-level slot cascades there
+                continue;
+            }
+            m_tick = due + 1; // Timers scheduled from the callback land after this tick
+            // Only this tick's timers: the callback may append ones for the next block here
+            uint32_t& head = m_heads[due & kSlotMask];
+            while (head != kNil && m_nodes[head].deadline == due) {
+                uint32_t index = head;
+                unlink(index);
+                T payload = std::move(m_nodes[index].payload);
+                release(index);
+                --m_size;
+                ++fired;
+                onExpire(payload);
+            }
+        }
+        return fired;
+    }
+
+    // When advance() next has work to do: the earliest pending deadline, or an earlier
+    // point where an upper-level slot is due to cascade. Max if nothing is pending.
+    uint64_t nextExpiryNs() const {
+        uint64_t tick = nextEventTick();
+        return tick == kNever ? kNever : m_startNs + tick * m_tickNs;
+    }
+
+    // Drops every pending timer, handing each payload to onDrop(T&) first. The callback
+    // must not schedule or cancel.
+    template <typename OnDrop>
+    void clear(OnDrop&& onDrop) {
+        for (uint32_t index = 0; index < m_nodes.size(); ++index) {
+            if (m_nodes[index].active) {
+                onDrop(m_nodes[index].payload);
+                release(index);
+            }
+        }
+        resetSlots();
+        m_size = 0;
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    uint64_t tickNs() const { return m_tickNs; }
+
+private:
+    static const int kLevels = 4;
+    static const int kSlotBits = 8;
+    static const int kSlots = 1 << kSlotBits;
+    static const uint64_t kSlotMask = kSlots - 1;
+    static const uint32_t kNil = 0xffffffffu;
+    static const uint64_t kNever = ~uint64_t(0);
+
+    struct Node {
+        uint64_t deadline = 0; // Tick
+        uint32_t prev = kNil;
+        uint32_t next = kNil;  // Also the free-list link
+        uint32_t generation = 1;
+        uint16_t bucket = 0;   // level * kSlots + slot
+        bool active = false;
+        T payload = T();
+    };
+
+    void resetSlots() {
+        for (int bucket = 0; bucket < kLevels * kSlots; ++bucket) {
+            m_heads[bucket] = kNil;
+            m_tails[bucket] = kNil;
+        }
+        for (uint64_t& word : m_occupied) {
+            word = 0;
+        }
+    }
+
+    uint64_t tickAtOrAfter(uint64_t ns) const {
+        if (ns <= m_startNs) {
+            return 0;
+        }
+        return (ns - m_startNs + m_tickNs - 1) / m_tickNs;
+    }
+
+    const Node* find(TimerId id) const {
+        uint32_t slot = static_cast<uint32_t>(id & 0xffffffffu);
+        if (slot == 0 || slot > m_nodes.size()) {
+            return nullptr;
+        }
+        const Node& node = m_nodes[slot - 1];
+        return node.active && node.generation == static_cast<uint32_t>(id >> 32) ? &node : nullptr;
+    }
+
+    Node* find(TimerId id) { return const_cast<Node*>(static_cast<const TimerWheel*>(this)->find(id)); }
+
+    uint32_t allocate() {
+        if (m_freeHead != kNil) {
+            uint32_t index = m_freeHead;
+            m_freeHead = m_nodes[index].next;
+            return index;
+        }
+        m_nodes.emplace_back();
+        return static_cast<uint32_t>(m_nodes.size() - 1);
+    }
+
+    void release(uint32_t index) {
+        Node& node = m_nodes[index];
+        node.active = false;
+        node.payload = T();
+        if (++node.generation == 0) {
+            node.generation = 1;
+        }
+        node.prev = kNil;
+        node.next = m_freeHead;
+        m_freeHead = index;
+    }
+
+    // The lowest level whose slot range, seen from m_tick, still contains the deadline.
+    // Deadlines already past go into the slot advance() processes next.
+    void place(uint32_t index) {
+        Node& node = m_nodes[index];
+        if (node.deadline < m_tick) {
+            node.deadline = m_tick;
+        }
+        int level = 0;
+        while (level < kLevels &&
+               (node.deadline >> (kSlotBits * (level + 1))) != (m_tick >> (kSlotBits * (level + 1)))) {
+            ++level;
+        }
+        uint64_t slot;
+        if (level < kLevels) {
+            slot = (node.deadline >> (kSlotBits * level)) & kSlotMask;
+        } else {
+            // Beyond the top level's span. Park it in the top-level slot that is reached
+            // last; it is placed again from there when that slot cascades.
+            level = kLevels - 1;
+            int shift = kSlotBits * level;
+            uint64_t current = (m_tick >> shift) & kSlotMask;
+            uint64_t wanted = (node.deadline >> shift) & kSlotMask;
+            bool nextRound = (node.deadline >> (shift + kSlotBits)) == (m_tick >> (shift + kSlotBits)) + 1;
+            slot = nextRound && wanted < current ? wanted : (current + kSlotMask) & kSlotMask;
+        }
+        link(index, static_cast<uint16_t>(level * kSlots + slot));
+    }
+
+    // Appends, so a slot fires its timers in the order they reached it
+    void link(uint32_t index, uint16_t bucket) {
+        Node& node = m_nodes[index];
+        node.bucket = bucket;
+        node.prev = m_tails[bucket];
+        node.next = kNil;
+        if (node.prev != kNil) {
+            m_nodes[node.prev].next = index;
+        } else {
+            m_heads[bucket] = index;
+            m_occupied[bucket >> 6] |= uint64_t(1) << (bucket & 63);
+        }
+        m_tails[bucket] = index;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = m_nodes[index];
+        if (node.prev != kNil) {
+            m_nodes[node.prev].next = node.next;
+        } else {
+            m_heads[node.bucket] = node.next;
+            if (node.next == kNil) {
+                m_occupied[node.bucket >> 6] &= ~(uint64_t(1) << (node.bucket & 63));
+            }
+        }
+        if (node.next != kNil) {
+            m_nodes[node.next].prev = node.prev;
+        } else {
+            m_tails[node.bucket] = node.prev;
+        }
+        node.prev = kNil;
+        node.next = kNil;
+    }
+
+    // At a tick whose low bits are all zero, re-place the upper-level slots that tick
+    // enters, highest level first, so their timers move down towards level 0
+    void cascade(uint64_t tick) {
+        for (int level = kLevels - 1; level > 0; --level) {
+            int shift = kSlotBits * level;
+            if ((tick & ((uint64_t(1) << shift) - 1)) != 0) {
+                continue;
+            }
+            uint16_t bucket = static_cast<uint16_t>(level * kSlots + ((tick >> shift) & kSlotMask));
+            uint32_t index = m_heads[bucket];
+            m_heads[bucket] = kNil;
+            m_tails[bucket] = kNil;
+            m_occupied[bucket >> 6] &= ~(uint64_t(1) << (bucket & 63));
+            while (index != kNil) {
+                uint32_t next = m_nodes[index].next;
+                place(index);
+                index = next;
+            }
+        }
+    }
+
+    // The first tick from m_tick on with an occupied slot: a level-0 slot fires there, an
+    // upper-level one cascades. Past any cascade still pending at m_tick itself, a lower
+    // level's candidate always comes before an upper level's. Only the top level wraps,
+    // for deadlines parked beyond its span.
+    uint64_t nextEventTick() const {
+        if (m_size == 0) {
+            return kNever;
+        }
+        for (int level = kLevels - 1; level > 0; --level) {
+            int shift = kSlotBits * level;
+            if ((m_tick & ((uint64_t(1) << shift) - 1)) == 0 &&
+                firstOccupied(level, static_cast<int>((m_tick >> shift) & kSlotMask)) ==
+                    static_cast<int>((m_tick >> shift) & kSlotMask)) {
+                return m_tick;
+            }
+        }
+        for (int level = 0; level < kLevels; ++level) {
+            int shift = kSlotBits * level;
+            int from = static_cast<int>((m_tick >> shift) & kSlotMask) + (level > 0 ? 1 : 0);
+            uint64_t block = (m_tick >> (shift + kSlotBits)) << (shift + kSlotBits);
+            int slot = from < kSlots ? firstOccupied(level, from) : -1;
+            if (slot >= 0) {
+                return block | (static_cast<uint64_t>(slot) << shift);
+            }
+            if (level == kLevels - 1) {
+                slot = firstOccupied(level, 0);
+                if (slot >= 0) {
+                    return block + (uint64_t(1) << (shift + kSlotBits)) + (static_cast<uint64_t>(slot) << shift);
+                }
+            }
+        }
+        return kNever;
+    }
+
+    // First occupied slot at or after from within a level, or -1
+    int firstOccupied(int level, int from) const {
+        int base = level * kSlots;
+        for (int word = from >> 6; word < kSlots / 64; ++word) {
+            uint64_t bits = m_occupied[(base >> 6) + word];
+            if (word == (from >> 6)) {
+                bits &= ~uint64_t(0) << (from & 63);
+            }
+            if (bits) {
+                return word * 64 + __builtin_ctzll(bits);
+            }
+        }
+        return -1;
+    }
+
+    uint64_t m_tickNs;
+    uint64_t m_startNs;
+    uint64_t m_tick; // Next tick advance() processes; every earlier tick has fired
+    size_t m_size;
+    uint32_t m_freeHead;
+    RegionVector<Node> m_nodes; // Timer pool on the huge-page arena
+    uint32_t m_heads[kLevels * kSlots];
+    uint32_t m_tails[kLevels * kSlots];
+    uint64_t m_occupied[kLevels * kSlots / 64];
+};
+
+#endif // TIMER_WHEEL_H
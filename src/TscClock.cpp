@@ -0,0 +1,73 @@
+// src/TscClock.cpp
+#include "TscClock.h"
+
+#include <iostream>
+#include <thread>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+bool TscClock::s_useTsc = false;
+uint64_t TscClock::s_baseTicks = 0;
+uint64_t TscClock::s_baseNs = 0;
+uint64_t TscClock::s_nsPerTick32 = 0;
+double TscClock::s_ticksPerNs = 0.0;
+
+#if defined(__x86_64__)
+namespace {
+
+// CPUID 0x80000007 EDX bit 8: the TSC ticks at a constant rate in every P/C-state
+bool hasInvariantTsc() {
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) {
+        return false;
+    }
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;
+}
+
+// A TSC reading paired with the steady_clock reading taken closest to it
+void sample(uint64_t& ticks, uint64_t& ns) {
+    uint64_t best = ~uint64_t(0);
+    for (int i = 0; i < 5; ++i) {
+        uint64_t before = __rdtsc();
+        uint64_t steady = TscClock::steadyNs();
+        uint64_t after = __rdtsc();
+        if (after - before < best) {
+            best = after - before;
+            ticks = before + (after - before) / 2;
+            ns = steady;
+        }
+    }
+}
+
+} // namespace
+#endif
+
+bool TscClock::calibrate() {
+#if defined(__x86_64__)
+    if (!hasInvariantTsc()) {
+        std::cout << "TscClock: No invariant TSC, using steady_clock" << std::endl;
+        return false;
+    }
+    uint64_t ticks0 = 0, ns0 = 0, ticks1 = 0, ns1 = 0;
+    sample(ticks0, ns0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    sample(ticks1, ns1);
+    if (ticks1 <= ticks0 || ns1 <= ns0) {
+        std::cerr << "TscClock: TSC did not advance with steady_clock, using steady_clock" << std::endl;
+        return false;
+    }
+    s_ticksPerNs = static_cast<double>(ticks1 - ticks0) / static_cast<double>(ns1 - ns0);
+    s_nsPerTick32 = static_cast<uint64_t>((static_cast<double>(ns1 - ns0) / static_cast<double>(ticks1 - ticks0)) *
+                                          4294967296.0);
+    s_baseTicks = ticks1;
+    s_baseNs = ns1;
+    s_useTsc = true;
+    std::cout << "TscClock: TSC at " << s_ticksPerNs << " GHz" << std::endl;
+    return true;
+#else
+    return false;
+#endif
+}
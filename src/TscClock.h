@@ -0,0 +1,52 @@
+//
+// TscClock.h
+// HFT
+//
+#ifndef TSC_CLOCK_H
+#define TSC_CLOCK_H
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+// Monotonic nanoseconds for the hot path: latency stamps (Metrics::nowNs) and timer
+// deadlines (TimerWheel). On x86-64 with an invariant TSC, reading it is one rdtsc and
+// a multiply instead of a clock_gettime call. calibrate() measures the TSC rate against
+// steady_clock and anchors it there, so readings stay on steady_clock's origin and can
+// be mixed with it. Until calibrate() has run, or without an invariant TSC, nowNs()
+// reads steady_clock.
+class TscClock {
+public:
+    static uint64_t nowNs() {
+#if defined(__x86_64__)
+        if (s_useTsc) {
+            uint64_t ticks = __rdtsc() - s_baseTicks;
+            return s_baseNs + static_cast<uint64_t>((static_cast<unsigned __int128>(ticks) * s_nsPerTick32) >> 32);
+        }
+#endif
+        return steadyNs();
+    }
+
+    static uint64_t steadyNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Call once from main before starting threads; takes about 20 ms. Returns whether
+    // the TSC is in use.
+    static bool calibrate();
+    static bool usingTsc() { return s_useTsc; }
+    static double ticksPerNs() { return s_ticksPerNs; }
+
+private:
+    static bool s_useTsc;
+    static uint64_t s_baseTicks;
+    static uint64_t s_baseNs;
+    static uint64_t s_nsPerTick32; // ns per tick, 32.32 fixed point
+    static double s_ticksPerNs;
+};
+
+#endif // TSC_CLOCK_H
@@ -0,0 +1,233 @@
+// src/main_backtest.cpp
+// Replays recorded market data through the quoting pipeline on a simulated clock and
+// reports PnL, inventory and fill statistics. Lists of values for the quoting
+// parameters run every combination, in parallel across cores.
+#include "Backtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static void usage(const char* program) {
+    std::cout << "usage: " << program << " <history.csv | history.bin> [options]\n"
+              << "       " << program << " --synthetic <events> [options]\n"
+              << "\n"
+              << "Quoting parameters (comma-separated lists run every combination):\n"
+              << "  --spread a,b,...      base half spread (default 0.02)\n"
+              << "  --skew a,b,...        price skew per unit of inventory (default 0.0001)\n"
+              << "  --vol a,b,...         volatility multiplier (default 1.0)\n"
+              << "  --alpha a,b,...       volatility EWMA alpha (default 0.05)\n"
+              << "  --size a,b,...        quote size (default 200)\n"
+              << "  --interval-us a,b,... quote cycle period, 0 = on every update (default 0)\n"
+              << "Simulation:\n"
+              << "  --latency-us N        order entry and report latency, each way (default 20)\n"
+              << "  --maker-fee F         per share, negative is a rebate (default -0.002)\n"
+              << "  --taker-fee F         per share (default 0.003)\n"
+              << "  --max-position N      stop quoting a side at this inventory (default 0 = no limit)\n"
+              << "  --min-life-us N       do not change quotes younger than this (default 0 = off)\n"
+              << "  --stale-us N          pull a symbol's quotes once its market is this quiet (default 0 = off)\n"
+              << "  --microprice          quote around the microprice instead of the mid\n"
+              << "  --tick T              tick size (default 0.01)\n"
+              << "Other:\n"
+              << "  --threads N           sweep worker threads (default: one per core)\n"
+              << "  --save FILE           write the loaded history in binary form and continue\n"
+              << "  --per-symbol          per-symbol breakdown of each run\n"
+              << "  --seed N              seed for --synthetic (default 1)" << std::endl;
+}
+
+static bool parseList(const std::string& text, std::vector<double>& values) {
+    values.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        char* end = nullptr;
+        double value = std::strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0') {
+            return false;
+        }
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+static void printResult(const BacktestResult& result, const MarketHistory& history, bool perSymbol) {
+    const BacktestConfig& config = result.config;
+    std::printf("%8.4f %8.5f %5.2f %6.3f %6lld %9.0f | %12.2f %10.2f %8llu %7llu %6llu %10lld %7lld %8llu %8llu %8llu %8.1f\n",
+                config.quoting.signal.baseHalfSpread, config.quoting.signal.skewPerUnit, config.quoting.signal.volMultiplier,
+                config.quoting.signal.ewmaAlpha, config.quoting.quoteSize, config.quoteIntervalNs / 1000.0,
+                result.pnl(), result.fees(),
+                static_cast<unsigned long long>(result.makerFills + result.takerFills),
+                static_cast<unsigned long long>(result.makerFills),
+                static_cast<unsigned long long>(result.takerFills),
+                result.volume(), result.maxAbsPosition(),
+                static_cast<unsigned long long>(result.requests.news),
+                static_cast<unsigned long long>(result.requests.replaces),
+                static_cast<unsigned long long>(result.requests.cancels),
+                result.wallSeconds > 0.0 ? result.events / result.wallSeconds / 1e6 : 0.0);
+    if (!perSymbol) {
+        return;
+    }
+    for (size_t i = 0; i < result.symbols.size(); ++i) {
+        const BacktestResult::SymbolResult& symbol = result.symbols[i];
+        std::printf("    %-8s pnl %12.2f  fees %10.2f  position %8lld  max |position| %8lld  fills %8llu  volume %10lld\n",
+                    history.symbols[i].c_str(), symbol.pnl(), symbol.fees, symbol.position, symbol.maxAbsPosition,
+                    static_cast<unsigned long long>(symbol.fills), symbol.volume);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 0;
+    }
+
+    std::string input;
+    size_t syntheticEvents = 0;
+    uint64_t seed = 1;
+    std::string savePath;
+    bool perSymbol = false;
+    unsigned threads = 0;
+    BacktestConfig base;
+    std::vector<double> spreads(1, base.quoting.signal.baseHalfSpread);
+    std::vector<double> skews(1, base.quoting.signal.skewPerUnit);
+    std::vector<double> vols(1, base.quoting.signal.volMultiplier);
+    std::vector<double> alphas(1, base.quoting.signal.ewmaAlpha);
+    std::vector<double> sizes(1, static_cast<double>(base.quoting.quoteSize));
+    std::vector<double> intervalsUs(1, 0.0);
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        std::string value = hasValue ? argv[i + 1] : "";
+        bool ok = true;
+        if (arg == "--per-symbol") {
+            perSymbol = true;
+            continue;
+        } else if (arg == "--microprice") {
+            base.quoting.quoteAroundMicroprice = true;
+            continue;
+        } else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else if (arg.compare(0, 2, "--") != 0) {
+            input = arg;
+            continue;
+        } else if (!hasValue) {
+            ok = false;
+        } else if (arg == "--spread") {
+            ok = parseList(value, spreads);
+        } else if (arg == "--skew") {
+            ok = parseList(value, skews);
+        } else if (arg == "--vol") {
+            ok = parseList(value, vols);
+        } else if (arg == "--alpha") {
+            ok = parseList(value, alphas);
+        } else if (arg == "--size") {
+            ok = parseList(value, sizes);
+        } else if (arg == "--interval-us") {
+            ok = parseList(value, intervalsUs);
+        } else if (arg == "--latency-us") {
+            base.orderLatencyNs = base.reportLatencyNs = std::strtoull(value.c_str(), nullptr, 10) * 1000;
+        } else if (arg == "--maker-fee") {
+            base.makerFee = std::atof(value.c_str());
+        } else if (arg == "--taker-fee") {
+            base.takerFee = std::atof(value.c_str());
+        } else if (arg == "--max-position") {
+            base.quoting.maxPosition = std::atoll(value.c_str());
+        } else if (arg == "--min-life-us") {
+            base.quoting.minQuoteLifeNs = std::strtoull(value.c_str(), nullptr, 10) * 1000;
+        } else if (arg == "--stale-us") {
+            base.quoting.staleNs = std::strtoull(value.c_str(), nullptr, 10) * 1000;
+        } else if (arg == "--tick") {
+            base.quoting.signal.tickSize = std::atof(value.c_str());
+            ok = base.quoting.signal.tickSize > 0.0;
+        } else if (arg == "--threads") {
+            threads = static_cast<unsigned>(std::atoi(value.c_str()));
+        } else if (arg == "--save") {
+            savePath = value;
+        } else if (arg == "--synthetic") {
+            syntheticEvents = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--seed") {
+            seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "backtest: Bad or missing value for " << arg << std::endl;
+            return 1;
+        }
+        ++i;
+    }
+
+    // 1. Load the history once; every run shares it read-only
+    MarketHistory history;
+    std::string error;
+    auto loadStart = std::chrono::steady_clock::now();
+    if (syntheticEvents > 0) {
+        // Same universe and base prices as MockMarketDataSource
+        history = MarketHistory::synthetic({
+            {"AAPL", 170.0}, {"MSFT", 420.0}, {"GOOG", 180.0}, {"AMZN", 185.0},
+            {"NVDA", 1000.0}, {"TSLA", 175.0}, {"META", 490.0}, {"NFLX", 650.0},
+            {"ADBE", 520.0}, {"CRM", 240.0}
+        }, syntheticEvents, seed);
+    } else if (input.empty()) {
+        usage(argv[0]);
+        return 1;
+    } else if (!(MarketHistory::isBinary(input) ? history.load(input, error) : history.loadCsv(input, error))) {
+        std::cerr << "backtest: " << error << std::endl;
+        return 1;
+    }
+    std::cout << "backtest: " << history.events.size() << " events over " << history.symbols.size()
+              << " symbols loaded in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count() << "s" << std::endl;
+    if (!savePath.empty()) {
+        if (!history.save(savePath, error)) {
+            std::cerr << "backtest: " << error << std::endl;
+            return 1;
+        }
+        std::cout << "backtest: History saved to " << savePath << std::endl;
+    }
+
+    // 2. Every combination of the listed parameters
+    std::vector<BacktestConfig> configs;
+    for (double spread : spreads) {
+        for (double skew : skews) {
+            for (double vol : vols) {
+                for (double alpha : alphas) {
+                    for (double size : sizes) {
+                        for (double intervalUs : intervalsUs) {
+                            BacktestConfig config = base;
+                            config.quoting.signal.baseHalfSpread = spread;
+                            config.quoting.signal.skewPerUnit = skew;
+                            config.quoting.signal.volMultiplier = vol;
+                            config.quoting.signal.ewmaAlpha = alpha;
+                            config.quoting.quoteSize = static_cast<long long>(size);
+                            config.quoteIntervalNs = static_cast<uint64_t>(intervalUs * 1000.0);
+                            configs.push_back(config);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // 3. Run them
+    auto runStart = std::chrono::steady_clock::now();
+    std::vector<BacktestResult> results = runBacktests(history, configs, threads);
+    double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+    std::printf("%8s %8s %5s %6s %6s %9s | %12s %10s %8s %7s %6s %10s %7s %8s %8s %8s %8s\n",
+                "spread", "skew", "vol", "alpha", "size", "cycle_us", "pnl", "fees", "fills", "maker", "taker",
+                "volume", "max_pos", "news", "replaces", "cancels", "Mev/s");
+    for (const BacktestResult& result : results) {
+        printResult(result, history, perSymbol);
+    }
+    std::printf("%zu runs, %.0f events in %.2fs (%.1fM events/s overall)\n", results.size(),
+                static_cast<double>(history.events.size()) * results.size(), runSeconds,
+                runSeconds > 0.0 ? history.events.size() * results.size() / runSeconds / 1e6 : 0.0);
+    return 0;
+}
@@ -0,0 +1,83 @@
+// src/main_exchange_sim.cpp
+#include "ExchangeSimulator.h"
+#include "MarketDataProcessor.h"
+#include "MockMarketDataSource.h"
+#include "OrderBook.h"
+#include "ThreadTopology.h"
+#include "FixTransport.h"
+#include "TscClock.h"
+
+#include <quickfix/FileStore.h>
+#include <quickfix/FileLog.h>
+#include <quickfix/SessionSettings.h>
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <memory>
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cout << "usage: " << argv[0] << " ExchangeSim.cfg" << std::endl;
+        return 0;
+    }
+
+    std::string configFile = argv[1];
+
+    try {
+        ThreadTopology::load(configFile);
+        TscClock::calibrate(); // Order expiry deadlines run on the TSC
+
+        // The venue runs its own market, independent of the prices the market maker sees
+        OrderBook marketBook;
+        MarketDataProcessor mdProcessor(&marketBook);
+        MockMarketDataSource mockDataSource(&mdProcessor);
+
+        ExchangeSimulator exchange(&marketBook);
+        mdProcessor.addListener([&exchange](const std::string& symbol, double bid, double ask, double, double) {
+            exchange.onMarketTick(symbol, bid, ask);
+        });
+
+        FIX::SessionSettings settings(configFile);
+        const FIX::Dictionary& defaults = settings.get();
+        if (defaults.has("DayOrderEndTime")) {
+            int hour = 0, minute = 0, second = 0;
+            if (std::sscanf(defaults.getString("DayOrderEndTime").c_str(), "%d:%d:%d", &hour, &minute, &second) != 3) {
+                std::cerr << "Exchange Simulator: DayOrderEndTime must be HH:MM:SS" << std::endl;
+                return 1;
+            }
+            exchange.setDayOrderEndTime(hour * 3600 + minute * 60 + second);
+        }
+        exchange.start();
+
+        FIX::FileStoreFactory storeFactory(settings);
+        FIX::FileLogFactory logFactory(settings);
+        std::unique_ptr<FIX::Acceptor> acceptor = FixTransport::makeAcceptor(exchange, storeFactory, settings, logFactory);
+
+        acceptor->start();
+        std::cout << "Exchange Simulator FIX Acceptor started." << std::endl;
+
+        mockDataSource.startGeneratingData();
+
+        std::cout << "Press ENTER to quit" << std::endl;
+        std::string line;
+        std::getline(std::cin, line);
+
+        mockDataSource.stopGeneratingData();
+        acceptor->stop();
+        exchange.stop();
+        std::cout << "Exchange Simulator stopped." << std::endl;
+
+        return 0;
+
+    } catch (const FIX::Exception& e) {
+        std::cerr << "FIX Exception: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Standard Exception: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "Unknown Exception" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,373 @@
+// src/main_fixdict_gen.cpp
+// Build step: compiles a QuickFIX data dictionary (FIX42.xml) into a C++ header of
+// constexpr tables for FixValidator: every field's type and enum values, indexed by
+// tag, and for each requested MsgType its required fields and a switch that says
+// which tags it may carry. Only the message types named on the command line are
+// compiled in; the rest are unsupported by the validator.
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct XmlElement {
+    std::string name; // Empty for a closing tag
+    std::string closing;
+    std::map<std::string, std::string> attributes;
+    bool selfClosing;
+};
+
+// Just enough XML for QuickFIX dictionaries: elements with quoted attributes;
+// declarations and comments are skipped
+class XmlReader {
+public:
+    explicit XmlReader(const std::string& text) : m_text(text), m_pos(0) {}
+
+    bool next(XmlElement& element) {
+        for (;;) {
+            size_t open = m_text.find('<', m_pos);
+            if (open == std::string::npos) {
+                return false;
+            }
+            if (m_text.compare(open, 4, "<!--") == 0) {
+                m_pos = skipPast(open, "-->");
+                continue;
+            }
+            if (m_text.compare(open, 2, "<?") == 0 || m_text.compare(open, 2, "<!") == 0) {
+                m_pos = skipPast(open, ">");
+                continue;
+            }
+            size_t close = m_text.find('>', open);
+            if (close == std::string::npos) {
+                throw std::runtime_error("Unterminated element");
+            }
+            m_pos = close + 1;
+            parse(m_text.substr(open + 1, close - open - 1), element);
+            return true;
+        }
+    }
+
+private:
+    size_t skipPast(size_t from, const char* end) const {
+        size_t found = m_text.find(end, from);
+        if (found == std::string::npos) {
+            throw std::runtime_error("Unterminated declaration");
+        }
+        return found + std::string(end).size();
+    }
+
+    static void parse(std::string body, XmlElement& element) {
+        element = XmlElement();
+        element.selfClosing = !body.empty() && body.back() == '/';
+        if (element.selfClosing) {
+            body.pop_back();
+        }
+        if (!body.empty() && body[0] == '/') {
+            element.closing = trim(body.substr(1));
+            return;
+        }
+        size_t i = 0;
+        while (i < body.size() && !isspace(static_cast<unsigned char>(body[i]))) {
+            ++i;
+        }
+        element.name = body.substr(0, i);
+        while (i < body.size()) {
+            while (i < body.size() && isspace(static_cast<unsigned char>(body[i]))) {
+                ++i;
+            }
+            size_t equals = body.find('=', i);
+            if (equals == std::string::npos) {
+                break;
+            }
+            std::string key = trim(body.substr(i, equals - i));
+            size_t quote = body.find_first_of("'\"", equals);
+            size_t endQuote = quote == std::string::npos ? quote : body.find(body[quote], quote + 1);
+            if (endQuote == std::string::npos) {
+                throw std::runtime_error("Unquoted attribute in <" + element.name + ">");
+            }
+            element.attributes[key] = body.substr(quote + 1, endQuote - quote - 1);
+            i = endQuote + 1;
+        }
+    }
+
+    static std::string trim(const std::string& text) {
+        size_t begin = text.find_first_not_of(" \t\r\n");
+        size_t end = text.find_last_not_of(" \t\r\n");
+        return begin == std::string::npos ? std::string() : text.substr(begin, end - begin + 1);
+    }
+
+    const std::string& m_text;
+    size_t m_pos;
+};
+
+struct FieldSpec {
+    int tag;
+    std::string name;
+    std::string type;
+    std::vector<std::string> values;
+
+    FieldSpec() : tag(0) {}
+};
+
+struct MessageSpec {
+    std::string name;
+    std::string msgType;
+    std::vector<std::string> required; // Top-level required fields, by name
+    std::vector<std::string> fields;   // Every field it may carry, group members included
+};
+
+// XML type -> FieldType enumerator in the generated header
+const std::map<std::string, std::string>& fieldTypes() {
+    static const std::map<std::string, std::string> types = {
+        {"STRING", "String"},         {"CHAR", "Char"},
+        {"INT", "Int"},               {"LENGTH", "Length"},
+        {"SEQNUM", "Int"},            {"NUMINGROUP", "Int"},
+        {"DAYOFMONTH", "DayOfMonth"}, {"FLOAT", "Float"},
+        {"PRICE", "Float"},           {"PRICEOFFSET", "Float"},
+        {"QTY", "Float"},             {"AMT", "Float"},
+        {"PERCENTAGE", "Float"},      {"BOOLEAN", "Boolean"},
+        {"UTCTIMESTAMP", "UtcTimestamp"}, {"UTCDATE", "UtcDate"},
+        {"UTCDATEONLY", "UtcDate"},   {"UTCTIMEONLY", "UtcTimeOnly"},
+        {"LOCALMKTDATE", "LocalMktDate"}, {"MONTHYEAR", "MonthYear"},
+        {"MULTIPLEVALUESTRING", "MultipleValueString"}, {"CURRENCY", "String"},
+        {"EXCHANGE", "String"},       {"COUNTRY", "String"},
+        {"DATA", "Data"},
+    };
+    return types;
+}
+
+std::string escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out;
+}
+
+void load(const std::string& path, std::map<int, FieldSpec>& fields, std::vector<MessageSpec>& messages) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+
+    XmlReader reader(text);
+    XmlElement element;
+    std::string section;
+    MessageSpec* message = nullptr;
+    FieldSpec* field = nullptr;
+    int groupDepth = 0;
+    while (reader.next(element)) {
+        if (!element.closing.empty()) {
+            if (element.closing == "message") {
+                message = nullptr;
+            } else if (element.closing == "group") {
+                --groupDepth;
+            } else if (element.closing == "field") {
+                field = nullptr;
+            } else if (element.closing == section) {
+                section.clear();
+            }
+            continue;
+        }
+        const std::string& name = element.name;
+        if (name == "header" || name == "trailer" || name == "messages" || name == "fields" || name == "components") {
+            section = element.selfClosing ? std::string() : name;
+        } else if (name == "component") {
+            throw std::runtime_error("Components are not supported (in " + section + ")");
+        } else if (section == "messages" && name == "message") {
+            messages.push_back(MessageSpec());
+            message = &messages.back();
+            message->name = element.attributes["name"];
+            message->msgType = element.attributes["msgtype"];
+            groupDepth = 0;
+        } else if (section == "messages" && message && (name == "field" || name == "group")) {
+            message->fields.push_back(element.attributes["name"]);
+            if (groupDepth == 0 && element.attributes["required"] == "Y") {
+                message->required.push_back(element.attributes["name"]);
+            }
+            if (name == "group" && !element.selfClosing) {
+                ++groupDepth;
+            }
+        } else if (section == "fields" && name == "field") {
+            FieldSpec spec;
+            spec.tag = std::atoi(element.attributes["number"].c_str());
+            spec.name = element.attributes["name"];
+            spec.type = element.attributes["type"];
+            if (spec.tag <= 0 || fieldTypes().find(spec.type) == fieldTypes().end()) {
+                throw std::runtime_error("Bad field definition for " + spec.name + " (" + spec.type + ")");
+            }
+            fields[spec.tag] = spec;
+            field = element.selfClosing ? nullptr : &fields[spec.tag];
+        } else if (section == "fields" && name == "value" && field) {
+            field->values.push_back(element.attributes["enum"]);
+        }
+    }
+}
+
+void write(std::ostream& out, const std::string& source, const std::map<int, FieldSpec>& fields,
+           const std::vector<const MessageSpec*>& messages) {
+    std::map<std::string, int> tags;
+    for (const auto& entry : fields) {
+        tags[entry.second.name] = entry.first;
+    }
+    int maxTag = fields.rbegin()->first;
+
+    out << "// Generated by fixdict_gen from " << source.substr(source.find_last_of('/') + 1) << "; do not edit.\n"
+        << "#ifndef FIX42_DICTIONARY_H\n#define FIX42_DICTIONARY_H\n\n"
+        << "#include <cstddef>\n#include <cstdint>\n#include <cstring>\n\n"
+        << "namespace Fix42Dictionary {\n\n"
+        << "enum FieldType : uint8_t {\n    Undefined,\n    String,\n    Char,\n    Int,\n    Length,\n    DayOfMonth,\n"
+        << "    Float,\n    Boolean,\n    UtcTimestamp,\n    UtcDate,\n    UtcTimeOnly,\n    LocalMktDate,\n"
+        << "    MonthYear,\n    MultipleValueString,\n    Data\n};\n\n"
+        << "// Enum values: single characters in chars when they all are, else the strings\n"
+        << "struct FieldDef {\n    FieldType type;\n    const char* name;\n    const char* chars;\n"
+        << "    const char* const* strings;\n    uint16_t stringCount;\n};\n\n"
+        << "struct MessageDef {\n    const char* msgType;\n    const char* name;\n    const int* required;\n"
+        << "    uint16_t requiredCount;\n    bool (*carries)(int tag);\n};\n\n"
+        << "constexpr int kMaxTag = " << maxTag << ";\n\n";
+
+    for (const auto& entry : fields) {
+        const FieldSpec& field = entry.second;
+        bool allChars = std::all_of(field.values.begin(), field.values.end(),
+                                    [](const std::string& value) { return value.size() == 1; });
+        if (!field.values.empty() && !allChars) {
+            out << "constexpr const char* const kValues" << field.tag << "[] = {";
+            for (size_t i = 0; i < field.values.size(); ++i) {
+                out << (i ? ", " : "") << '"' << escape(field.values[i]) << '"';
+            }
+            out << "};\n";
+        }
+    }
+
+    out << "\nconstexpr FieldDef kFields[kMaxTag + 1] = {\n";
+    for (int tag = 0; tag <= maxTag; ++tag) {
+        auto found = fields.find(tag);
+        if (found == fields.end()) {
+            out << "    {Undefined, nullptr, nullptr, nullptr, 0},\n";
+            continue;
+        }
+        const FieldSpec& field = found->second;
+        bool allChars = std::all_of(field.values.begin(), field.values.end(),
+                                    [](const std::string& value) { return value.size() == 1; });
+        out << "    {" << fieldTypes().at(field.type) << ", \"" << field.name << "\", ";
+        if (field.values.empty()) {
+            out << "nullptr, nullptr, 0";
+        } else if (allChars) {
+            std::string chars;
+            for (const std::string& value : field.values) {
+                chars += value;
+            }
+            out << '"' << escape(chars) << "\", nullptr, 0";
+        } else {
+            out << "nullptr, kValues" << tag << ", " << field.values.size();
+        }
+        out << "}, // " << tag << "\n";
+    }
+    out << "};\n";
+
+    for (const MessageSpec* message : messages) {
+        std::set<int> carried;
+        for (const std::string& name : message->fields) {
+            if (!tags.count(name)) {
+                throw std::runtime_error(message->name + " uses undefined field " + name);
+            }
+            carried.insert(tags[name]);
+        }
+        out << "\n// " << message->name << " (" << message->msgType << ")\n";
+        out << "constexpr int kRequired" << message->name << "[] = {";
+        for (size_t i = 0; i < message->required.size(); ++i) {
+            out << (i ? ", " : "") << tags[message->required[i]];
+        }
+        if (message->required.empty()) {
+            out << "0";
+        }
+        out << "};\n";
+        out << "inline bool carries" << message->name << "(int tag) {\n    switch (tag) {\n";
+        for (int tag : carried) {
+            out << "    case " << tag << ":\n";
+        }
+        out << "        return true;\n    default:\n        return false;\n    }\n}\n";
+        out << "constexpr MessageDef k" << message->name << " = {\"" << escape(message->msgType) << "\", \""
+            << message->name << "\", kRequired" << message->name << ", " << message->required.size() << ", &carries"
+            << message->name << "};\n";
+    }
+
+    out << "\n// The message types compiled in, or null\n"
+        << "inline const MessageDef* findMessage(const char* msgType, size_t length) {\n"
+        << "    if (length == 1) {\n        switch (msgType[0]) {\n";
+    for (const MessageSpec* message : messages) {
+        if (message->msgType.size() == 1) {
+            out << "        case '" << escape(message->msgType) << "':\n            return &k" << message->name << ";\n";
+        }
+    }
+    out << "        default:\n            return nullptr;\n        }\n    }\n";
+    for (const MessageSpec* message : messages) {
+        if (message->msgType.size() != 1) {
+            out << "    if (length == " << message->msgType.size() << " && std::memcmp(msgType, \""
+                << escape(message->msgType) << "\", length) == 0) {\n        return &k" << message->name << ";\n    }\n";
+        }
+    }
+    out << "    return nullptr;\n}\n\n} // namespace Fix42Dictionary\n\n#endif // FIX42_DICTIONARY_H\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "usage: " << argv[0] << " <FIX42.xml> <output.h> <MsgType>..." << std::endl;
+        return 1;
+    }
+    try {
+        std::map<int, FieldSpec> fields;
+        std::vector<MessageSpec> messages;
+        load(argv[1], fields, messages);
+        if (fields.empty()) {
+            throw std::runtime_error(std::string("No fields in ") + argv[1]);
+        }
+
+        std::vector<const MessageSpec*> selected;
+        for (int i = 3; i < argc; ++i) {
+            auto found = std::find_if(messages.begin(), messages.end(),
+                                      [&](const MessageSpec& message) { return message.msgType == argv[i]; });
+            if (found == messages.end()) {
+                throw std::runtime_error(std::string("No message with MsgType ") + argv[i]);
+            }
+            selected.push_back(&*found);
+        }
+
+        // Written whole to a temporary and renamed, so a failed run leaves no half header
+        std::string output = argv[2];
+        std::string temporary = output + ".tmp";
+        {
+            std::ofstream out(temporary.c_str());
+            write(out, argv[1], fields, selected);
+            if (!out) {
+                throw std::runtime_error("Cannot write " + temporary);
+            }
+        }
+        if (std::rename(temporary.c_str(), output.c_str()) != 0) {
+            throw std::runtime_error("Cannot rename " + temporary + " to " + output);
+        }
+        std::cout << "fixdict_gen: " << fields.size() << " fields, " << selected.size() << " message types -> "
+                  << output << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "fixdict_gen: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -4,16 +4,37 @@
 #include "MockMarketDataSource.h"
 #include "OrderBook.h"
 #include "StrategyEngine.h" // Include StrategyEngine header
+#include "Snapshot.h"
+#include "Metrics.h"
+#include "ThreadTopology.h"
+#include "OrderBatcher.h"
+#include "MarketAnalytics.h"
+#include "TickStore.h"
+#include "StrategyRuntime.h"
+#include "FillHedger.h"
+#include "FixTransport.h"
+#include "TscClock.h"
+#include "MemoryRegion.h"
 
 #include <quickfix/FileStore.h>
 #include <quickfix/FileLog.h>
-#include <quickfix/SocketAcceptor.h>
 #include <quickfix/SessionSettings.h>
 
 #include <iostream>
 #include <string>
 #include <fstream>
-#include <thread> // For std::thread
+#include <memory>
+#include <thread>
+#include <chrono>
+
+// Optional settings live in the [DEFAULT] section of MarketMaker.cfg
+static std::string getSettingOr(const FIX::Dictionary& dict, const std::string& key, const std::string& fallback) {
+    return dict.has(key) ? dict.getString(key) : fallback;
+}
+
+static int getIntSettingOr(const FIX::Dictionary& dict, const std::string& key, int fallback) {
+    return dict.has(key) ? dict.getInt(key) : fallback;
+}
 
 int main(int argc, char** argv) {
     if (argc != 2) {
@@ -24,15 +45,72 @@ int main(int argc, char** argv) {
     std::string configFile = argv[1];
 
     try {
+        FIX::SessionSettings settings(configFile);
+        const FIX::Dictionary& defaults = settings.get();
+        // Per-role CPU, scheduling and NUMA placement from [THREADS]
+        ThreadTopology::load(configFile);
+
+        // Hot structures live on a pre-faulted huge-page arena; set it up before creating any of them
+        MemoryRegion::reportFaults("at startup");
+        MemoryRegion::Config memoryConfig;
+        if (!MemoryRegion::parsePageSize(getSettingOr(defaults, "HugePages", "2m"), memoryConfig.pages)) {
+            std::cerr << "Market Maker: HugePages must be 1g, 2m, thp, 4k or off" << std::endl;
+            return 1;
+        }
+        memoryConfig.bytes = static_cast<size_t>(getIntSettingOr(defaults, "MemoryRegionMB", 64)) << 20;
+        memoryConfig.heapReserveBytes = static_cast<size_t>(getIntSettingOr(defaults, "HeapReserveMB", 64)) << 20;
+        memoryConfig.mallocArenas = getIntSettingOr(defaults, "MallocArenas", 0);
+        memoryConfig.lockMemory = getSettingOr(defaults, "LockMemory", "N") == "Y";
+        MemoryRegion::init(memoryConfig);
+        MemoryRegion::reportFaults("after pre-fault");
+
+        // Latency stamps and timer deadlines read the TSC from here on
+        TscClock::calibrate();
+
+        // Metrics go to shared memory first, before any other thread exists (see Metrics.h)
+        Metrics::publish(getSettingOr(defaults, "MetricsShmName", "/mm_metrics"));
+        MetricsHttpServer metricsHttp;
+        int metricsHttpPort = getIntSettingOr(defaults, "MetricsHttpPort", 0);
+        if (metricsHttpPort > 0) {
+            metricsHttp.start(metricsHttpPort);
+        }
+
         // 1. Initialize Core Components
         OrderBook orderBook;
-        MockMarketDataSource mockDataSource(&orderBook); // Market data source pushes to OrderBook
-        MarketDataProcessor mdProcessor(&orderBook);     // Processor handles market data updates
-                                                        // (In this setup, MockMarketDataSource directly updates OrderBook,
-                                                        // so MDProcessor could be simplified or used for additional processing)
+        MarketDataProcessor mdProcessor(&orderBook);        // Fans ticks out: OrderBook sees every one
+        MockMarketDataSource mockDataSource(&mdProcessor);  // Market data source pushes to the processor
+
+        // Quoting only needs the latest price per symbol, so it reads through a conflation buffer
+        ConflationBuffer quoteUpdates(mockDataSource.getSymbols());
+        mdProcessor.addConflatedConsumer(&quoteUpdates);
+
+        // VWAP, OHLCV bars, microprice and imbalance per symbol, from every tick and fill
+        MarketAnalytics::Params analyticsParams;
+        analyticsParams.barIntervalNs = static_cast<uint64_t>(getIntSettingOr(defaults, "AnalyticsBarIntervalMs", 1000)) * 1000000ULL;
+        analyticsParams.volumeBarSize = getIntSettingOr(defaults, "AnalyticsVolumeBarSize", 10000);
+        MarketAnalytics analytics(mockDataSource.getSymbols(), analyticsParams);
+        mdProcessor.addAnalytics(&analytics);
+
+        // Columnar archive of every tick and fill for research queries (tick_query)
+        std::unique_ptr<TickStoreWriter> tickStore;
+        std::string tickStorePath = getSettingOr(defaults, "TickStorePath", "ticks");
+        if (!tickStorePath.empty()) {
+            tickStore.reset(new TickStoreWriter(tickStorePath,
+                                                static_cast<size_t>(getIntSettingOr(defaults, "TickStoreBlockRows", 4096)),
+                                                getIntSettingOr(defaults, "TickStoreMaxBlockAgeMs", 10000)));
+            mdProcessor.addTickStore(tickStore.get());
+            tickStore->start();
+        }
 
         // 2. Initialize Strategy Engine
         StrategyEngine strategyEngine(&orderBook, nullptr); // Pass nullptr for MarketMakerApp initially, set later
+        strategyEngine.setQuoteUpdates(&quoteUpdates);
+        strategyEngine.setAnalytics(&analytics, getSettingOr(defaults, "QuoteAroundMicroprice", "N") == "Y");
+        strategyEngine.setTickStore(tickStore.get());
+        strategyEngine.setQuoteTimers(getIntSettingOr(defaults, "QuoteRefreshMs", 3000),
+                                      getIntSettingOr(defaults, "MinQuoteLifeMs", 0),
+                                      getIntSettingOr(defaults, "QuoteStaleMs", 0));
+        strategyEngine.setMaxPosition(getIntSettingOr(defaults, "MaxPosition", 0));
 
         // 3. Initialize Market Maker Application (FIX Acceptor)
         // Pass the OrderBook and the StrategyEngine to the MarketMakerApplication
@@ -41,33 +119,113 @@ int main(int argc, char** argv) {
         // 4. Link StrategyEngine back to MarketMakerApp (resolves circular dependency)
         strategyEngine.setMarketMakerApp(&marketMakerApp);
 
+        // 5. Warm restart: restore book, positions and the ID epoch before accepting orders
+        std::string snapshotDir = getSettingOr(defaults, "SnapshotPath", "snapshot");
+        FillJournal fillJournal(snapshotDir + "/fills.journal");
+        strategyEngine.setFillJournal(&fillJournal);
+        SnapshotManager snapshotManager(&orderBook, &strategyEngine, &fillJournal, snapshotDir,
+                                        getIntSettingOr(defaults, "SnapshotIntervalMs", 1000),
+                                        getIntSettingOr(defaults, "SnapshotMaxBookAgeSec", 30));
+        snapshotManager.restore();
+        // Fold the replayed tail into a fresh snapshot; each snapshot empties the journal up to it
+        snapshotManager.takeSnapshot();
+        snapshotManager.start();
+
+        // Batched order entry: client orders are matched in groups on the Orders thread
+        std::unique_ptr<OrderBatcher> orderBatcher;
+        if (getSettingOr(defaults, "OrderBatching", "N") == "Y") {
+            orderBatcher.reset(new OrderBatcher(
+                [&strategyEngine](std::vector<OrderBatcher::Order>& batch) { strategyEngine.onNewOrderBatch(batch); },
+                getIntSettingOr(defaults, "OrderBatchMaxDelayUs", 50),
+                static_cast<size_t>(getIntSettingOr(defaults, "OrderBatchMaxSize", 64))));
+            marketMakerApp.setOrderBatcher(orderBatcher.get());
+            orderBatcher->start();
+        }
+
+        // Coroutine strategies on their own event loops, sharded by symbol
+        std::unique_ptr<StrategyRuntime> strategyRuntime;
+        if (getSettingOr(defaults, "HedgeFills", "N") == "Y") {
+            strategyRuntime.reset(new StrategyRuntime(
+                static_cast<size_t>(getIntSettingOr(defaults, "StrategyShards", 1)),
+                [&strategyEngine](const StrategyOrder& order) { return strategyEngine.sendStrategyOrder(order); }));
+            StrategyRuntime* runtime = strategyRuntime.get();
+            mdProcessor.addListener([runtime](const std::string& symbol, double bid, double ask, double bidSize,
+                                              double askSize) {
+                runtime->postQuote(symbol, bid, ask, bidSize, askSize);
+            });
+            strategyEngine.setStrategyRuntime(runtime);
+            strategyRuntime->start();
+
+            FillHedgerParams hedgerParams;
+            hedgerParams.minQty = getIntSettingOr(defaults, "HedgeMinQty", 100);
+            hedgerParams.maxAttempts = getIntSettingOr(defaults, "HedgeMaxAttempts", 3);
+            hedgerParams.ackTimeoutMs = getIntSettingOr(defaults, "HedgeAckTimeoutMs", 500);
+            hedgerParams.retryDelayMs = getIntSettingOr(defaults, "HedgeRetryDelayMs", 100);
+            // Before the sessions start, so no fill is booked between reading a position and the hedger starting
+            startFillHedgers(*strategyRuntime, mockDataSource.getSymbols(), hedgerParams,
+                             [&strategyEngine](const std::string& symbol) { return strategyEngine.positionQty(symbol); });
+        }
 
         // QUICKFIX Engine Setup
-        FIX::SessionSettings settings(configFile);
         FIX::FileStoreFactory storeFactory(settings);
         FIX::FileLogFactory logFactory(settings);
-        FIX::SocketAcceptor acceptor(marketMakerApp, storeFactory, settings, logFactory);
+        // Sockets, or shared memory for sessions with ConnectionTransport=shm
+        std::unique_ptr<FIX::Acceptor> acceptor =
+            FixTransport::makeAcceptor(marketMakerApp, storeFactory, settings, logFactory);
+
+        // An initiator [SESSION] in the config is our upstream venue; quotes are routed there
+        std::unique_ptr<FIX::Initiator> initiator;
+        for (const FIX::SessionID& sessionID : settings.getSessions()) {
+            const FIX::Dictionary& sessionSettings = settings.get(sessionID);
+            if (sessionSettings.has("ConnectionType") && sessionSettings.getString("ConnectionType") == "initiator") {
+                marketMakerApp.setUpstreamSessionID(sessionID);
+                initiator = FixTransport::makeInitiator(marketMakerApp, storeFactory, settings, logFactory);
+                break;
+            }
+        }
 
         // Start FIX Acceptor
-        acceptor.start();
+        acceptor->start();
         std::cout << "Market Maker FIX Acceptor started." << std::endl;
+        if (initiator) {
+            initiator->start();
+            std::cout << "Market Maker upstream FIX Initiator started." << std::endl;
+        }
 
-        // Start Mock Market Data Source in a separate thread
+        // Start Mock Market Data Source (it runs on its own feed thread)
         std::cout << "Starting Mock Market Data Source..." << std::endl;
-        std::thread mdThread([&mockDataSource]() {
-            mockDataSource.startGeneratingData();
-        });
+        mockDataSource.startGeneratingData();
+
+        // Once every path has run a few times the counts should stop moving
+        std::this_thread::sleep_for(std::chrono::milliseconds(getIntSettingOr(defaults, "WarmUpMs", 1000)));
+        MemoryRegion::reportFaults("after warm-up");
 
         // Keep main thread alive
         std::cout << "Press ENTER to quit" << std::endl;
         std::string line;
         std::getline(std::cin, line);
+        MemoryRegion::reportFaults("in steady state"); // The change since warm-up
 
         // Shutdown sequence
         std::cout << "Shutting down..." << std::endl;
-        mockDataSource.stopGeneratingData();
-        mdThread.join(); // Wait for MD thread to finish
-        acceptor.stop();
+        mockDataSource.stopGeneratingData(); // Joins the feed thread
+        if (strategyRuntime) {
+            strategyRuntime->stop(); // No new hedges; fills still in flight are booked by the engine
+        }
+        strategyEngine.stopQuoting(); // Joins the quoting thread; session callbacks only pause it
+        if (orderBatcher) {
+            orderBatcher->stop(); // Matches whatever was still queued and answers it while the sessions are up
+        }
+        if (initiator) {
+            initiator->stop();
+        }
+        acceptor->stop();
+        snapshotManager.stop(); // Takes a final snapshot
+        if (tickStore) {
+            tickStore->stop(); // Writes the partial blocks once no more ticks or fills can arrive
+        }
+        metricsHttp.stop();
+        Metrics::unpublish();
 
         std::cout << "Market Maker stopped." << std::endl;
 
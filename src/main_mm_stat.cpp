@@ -0,0 +1,96 @@
+// src/main_mm_stat.cpp
+// Live view of a running market_maker's metrics, read from its shared-memory segment.
+// Never talks to the process itself, so watching it adds nothing to the hot path.
+#include "Metrics.h"
+
+#include <signal.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// The values rates are computed from, copied out of the live segment
+struct Sample {
+    uint64_t counters[Metrics::CounterCount];
+    uint64_t allocations;
+};
+
+static Sample takeSample(const Metrics::Segment& segment) {
+    Sample sample;
+    for (unsigned i = 0; i < Metrics::CounterCount; ++i) {
+        sample.counters[i] = segment.counters[i].value.load(std::memory_order_relaxed);
+    }
+    sample.allocations = Metrics::allocations(segment);
+    return sample;
+}
+
+static void printStats(const Metrics::Segment& now, const Sample& current, const Sample& before, double seconds) {
+    std::printf("pid %u%s\n", now.pid, kill(static_cast<pid_t>(now.pid), 0) == 0 ? "" : " (exited)");
+
+    std::printf("%-22s %14s %12s\n", "counter", "total", "per sec");
+    for (unsigned i = 0; i < Metrics::CounterCount; ++i) {
+        std::printf("%-22s %14llu %12.1f\n", Metrics::counterName(i),
+                    static_cast<unsigned long long>(current.counters[i]),
+                    (current.counters[i] - before.counters[i]) / seconds);
+    }
+    std::printf("%-22s %14llu %12.1f\n", "allocations", static_cast<unsigned long long>(current.allocations),
+                (current.allocations - before.allocations) / seconds);
+
+    std::printf("\n%-28s %10s\n", "rejects", "total");
+    for (unsigned i = 0; i < Metrics::RejectReasonCount; ++i) {
+        std::printf("%-28s %10llu\n", Metrics::rejectName(i),
+                    static_cast<unsigned long long>(now.rejects[i].value.load(std::memory_order_relaxed)));
+    }
+
+    std::printf("\n%-22s %10s\n", "gauge", "value");
+    for (unsigned i = 0; i < Metrics::GaugeCount; ++i) {
+        std::printf("%-22s %10llu\n", Metrics::gaugeName(i),
+                    static_cast<unsigned long long>(now.gauges[i].value.load(std::memory_order_relaxed)));
+    }
+
+    std::printf("\n%-16s %10s %10s %10s %10s %10s\n", "latency (us)", "count", "p50", "p99", "p99.9", "max");
+    for (unsigned i = 0; i < Metrics::StageCount; ++i) {
+        const Metrics::Histogram& h = now.stages[i];
+        std::printf("%-16s %10llu %10.1f %10.1f %10.1f %10.1f\n", Metrics::stageName(i),
+                    static_cast<unsigned long long>(h.count.load(std::memory_order_relaxed)),
+                    Metrics::percentile(h, 0.5) / 1000.0, Metrics::percentile(h, 0.99) / 1000.0,
+                    Metrics::percentile(h, 0.999) / 1000.0, h.maxNs.load(std::memory_order_relaxed) / 1000.0);
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 3) {
+        std::cout << "usage: " << argv[0] << " [shm_name (default /mm_metrics)] [interval_seconds (0 = print once)]" << std::endl;
+        return 0;
+    }
+    std::string name = argc > 1 ? argv[1] : "/mm_metrics";
+    int interval = argc > 2 ? std::atoi(argv[2]) : 1;
+
+    const Metrics::Segment* segment = Metrics::attach(name);
+    if (!segment) {
+        std::cerr << "mm_stat: No metrics segment " << name << " (is market_maker running with metrics enabled?)" << std::endl;
+        return 1;
+    }
+
+    if (interval <= 0) {
+        std::cout << Metrics::render(*segment);
+        return 0;
+    }
+
+    // Rates are the difference between two copies taken one interval apart
+    Sample previous = takeSample(*segment);
+    auto previousTime = std::chrono::steady_clock::now();
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::seconds(interval));
+        Sample current = takeSample(*segment);
+        auto now = std::chrono::steady_clock::now();
+        printStats(*segment, current, previous, std::chrono::duration<double>(now - previousTime).count());
+        previous = current;
+        previousTime = now;
+    }
+}
@@ -1,10 +1,10 @@
 // src/main_mock_client.cpp
 #include "MockTradeClient.h"
 #include "OrderBook.h" // Crucial: Include OrderBook header
+#include "FixTransport.h"
 
 #include <quickfix/FileStore.h>
 #include <quickfix/FileLog.h> // Using FileLog as per your last main_mock_client.cpp
-#include <quickfix/SocketInitiator.h>
 #include <quickfix/SessionSettings.h>
 
 #include <iostream>
@@ -12,6 +12,7 @@
 #include <fstream> // Required if you're reading config from a file
 #include <thread>  // For std::this_thread::sleep_for
 #include <chrono>  // For std::chrono::seconds
+#include <memory>
 
 int main(int argc, char** argv) {
     if (argc != 2) {
@@ -33,9 +34,11 @@ int main(int argc, char** argv) {
         FIX::SessionSettings settings(configFile);
         FIX::FileStoreFactory storeFactory(settings);
         FIX::FileLogFactory logFactory(settings); // Using FileLogFactory
-        FIX::SocketInitiator initiator(mockClientApp, storeFactory, settings, logFactory);
+        // Sockets, or shared memory with ConnectionTransport=shm
+        std::unique_ptr<FIX::Initiator> initiator =
+            FixTransport::makeInitiator(mockClientApp, storeFactory, settings, logFactory);
 
-        initiator.start();
+        initiator->start();
         std::cout << "Mock Trade Client FIX Initiator started." << std::endl;
 
         // Start the continuous order sending loop in MockTradeClient
@@ -47,7 +50,7 @@ int main(int argc, char** argv) {
 
         // Stop the continuous order sending loop before stopping the initiator
         mockClientApp.stopSendingOrders();
-        initiator.stop();
+        initiator->stop();
         std::cout << "Mock Trade Client stopped." << std::endl;
 
         return 0;
@@ -0,0 +1,452 @@
+// src/main_soak_client.cpp
+// Long-running fuzz and soak test for market_maker's client order entry. Drives the
+// session with a mix of good and bad orders for --duration-s, checks every answer
+// (see SoakClient.h), watches the market maker's snapshot and metrics segment for
+// book, position and memory problems, and exits nonzero if anything broke or the
+// run came in under the throughput baseline.
+#include "SoakClient.h"
+#include "SnapshotFormat.h"
+#include "Metrics.h"
+#include "FixTransport.h"
+
+#include <quickfix/FileStore.h>
+#include <quickfix/FileLog.h>
+#include <quickfix/SessionSettings.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void usage(const char* program) {
+    std::cout << "usage: " << program << " <client.cfg> [options]\n"
+              << "\n"
+              << "Load:\n"
+              << "  --duration-s N          run time (default 60)\n"
+              << "  --rate N                orders per second, 0 = as fast as the window allows (default 0)\n"
+              << "  --window N              orders in flight before waiting for answers (default 64)\n"
+              << "  --mix v,i,d,e,s,r       relative weights of valid, invalid, duplicate-ID, extreme-price,\n"
+              << "                          stale-timestamp orders and resend requests (default 70,12,5,5,6,2)\n"
+              << "  --timeout-ms N          an order unanswered this long is a violation (default 5000)\n"
+              << "  --seed N                (default 1)\n"
+              << "Monitoring:\n"
+              << "  --report-s N            seconds between report lines (default 10)\n"
+              << "  --warmup-s N            excluded from throughput, drift and growth gates (default 10)\n"
+              << "  --metrics NAME          market_maker's metrics segment, empty to skip (default /mm_metrics)\n"
+              << "  --snapshot-dir DIR      market_maker's SnapshotPath, empty to skip (default snapshot)\n"
+              << "Gates (any failure exits 1):\n"
+              << "  --baseline FILE         fail below its throughput by more than --tolerance\n"
+              << "  --tolerance F           (default 0.1)\n"
+              << "  --write-baseline FILE   record this run's throughput\n"
+              << "  --max-rss-growth-mb N   market_maker RSS growth after warmup (default 64)\n"
+              << "  --max-live-alloc-growth N  growth of live allocations after warmup (default 100000)\n"
+              << "  --max-region-growth-kb N   growth of MemoryRegion arena use after warmup (default 1024)\n"
+              << "  --max-region-fallbacks N   arena allocations sent to the heap after warmup (default 0)\n"
+              << "  --max-p99-drift F       last interval's p99 over the first's (default 3.0)" << std::endl;
+}
+
+// One report interval, as seen from both ends
+struct Interval {
+    double elapsedS;
+    double answeredPerS;
+    uint64_t p50Ns;
+    uint64_t p99Ns;
+    uint64_t maxNs;
+    long long rssBytes;      // -1 when unknown
+    long long liveAllocations;
+    long long regionBytes;     // Arena blocks never go through operator new, so count them apart
+    long long regionFallbacks;
+    uint64_t violations;
+};
+
+static long long residentBytes(uint32_t pid) {
+    std::ifstream statm(("/proc/" + std::to_string(pid) + "/statm").c_str());
+    long long pages = 0;
+    long long resident = 0;
+    if (!(statm >> pages >> resident)) {
+        return -1;
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+static bool readBaseline(const std::string& path, double& throughput) {
+    std::ifstream in(path.c_str());
+    std::string key;
+    double value;
+    while (in >> key >> value) {
+        if (key == "answered_per_sec") {
+            throughput = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Top of book must be two-sided, uncrossed and its stored mid consistent
+static unsigned checkBook(const SnapshotFormat::Contents& snapshot,
+                          std::map<std::string, std::pair<double, double> >& prices) {
+    unsigned problems = 0;
+    for (const SnapshotFormat::SymbolRecord& record : snapshot.symbols) {
+        std::string symbol = SnapshotFormat::readSymbol(record.symbol);
+        if (record.bid == 0.0 && record.ask == 0.0) {
+            continue; // No data for the symbol yet
+        }
+        if (!(record.bid > 0.0) || !(record.ask > record.bid) ||
+            std::fabs(record.mid - (record.bid + record.ask) / 2.0) > 1e-6 * record.mid) {
+            std::cerr << "soak_client: VIOLATION book for " << symbol << " bid " << record.bid << " ask "
+                      << record.ask << " mid " << record.mid << std::endl;
+            ++problems;
+            continue;
+        }
+        prices[symbol] = std::make_pair(record.bid, record.ask);
+    }
+    return problems;
+}
+
+static std::map<std::string, long long> positionsOf(const SnapshotFormat::Contents& snapshot) {
+    std::map<std::string, long long> positions;
+    for (const SnapshotFormat::PositionRecord& record : snapshot.positions) {
+        positions[SnapshotFormat::readSymbol(record.symbol)] = record.qty;
+    }
+    return positions;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 0;
+    }
+
+    std::string configFile;
+    SoakClient::Options options;
+    double durationS = 60.0;
+    double reportS = 10.0;
+    double warmupS = 10.0;
+    std::string metricsName = "/mm_metrics";
+    std::string snapshotDir = "snapshot";
+    std::string baselinePath;
+    std::string writeBaselinePath;
+    double tolerance = 0.1;
+    double maxRssGrowthMb = 64.0;
+    long long maxLiveAllocGrowth = 100000;
+    long long maxRegionGrowthKb = 1024;
+    long long maxRegionFallbacks = 0;
+    double maxP99Drift = 3.0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        std::string value = hasValue ? argv[i + 1] : "";
+        bool ok = true;
+        if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else if (arg.compare(0, 2, "--") != 0) {
+            configFile = arg;
+            continue;
+        } else if (!hasValue) {
+            ok = false;
+        } else if (arg == "--duration-s") {
+            durationS = std::atof(value.c_str());
+        } else if (arg == "--rate") {
+            options.rate = static_cast<unsigned>(std::atoi(value.c_str()));
+        } else if (arg == "--window") {
+            options.window = static_cast<unsigned>(std::atoi(value.c_str()));
+        } else if (arg == "--mix") {
+            std::stringstream stream(value);
+            std::string item;
+            int k = 0;
+            while (std::getline(stream, item, ',') && k < SoakClient::KindCount) {
+                options.weights[k++] = static_cast<unsigned>(std::atoi(item.c_str()));
+            }
+            ok = k == SoakClient::KindCount;
+        } else if (arg == "--timeout-ms") {
+            options.timeoutMs = static_cast<unsigned>(std::atoi(value.c_str()));
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--report-s") {
+            reportS = std::atof(value.c_str());
+            ok = reportS > 0.0;
+        } else if (arg == "--warmup-s") {
+            warmupS = std::atof(value.c_str());
+        } else if (arg == "--metrics") {
+            metricsName = value;
+        } else if (arg == "--snapshot-dir") {
+            snapshotDir = value;
+        } else if (arg == "--baseline") {
+            baselinePath = value;
+        } else if (arg == "--write-baseline") {
+            writeBaselinePath = value;
+        } else if (arg == "--tolerance") {
+            tolerance = std::atof(value.c_str());
+        } else if (arg == "--max-rss-growth-mb") {
+            maxRssGrowthMb = std::atof(value.c_str());
+        } else if (arg == "--max-live-alloc-growth") {
+            maxLiveAllocGrowth = std::atoll(value.c_str());
+        } else if (arg == "--max-region-growth-kb") {
+            maxRegionGrowthKb = std::atoll(value.c_str());
+        } else if (arg == "--max-region-fallbacks") {
+            maxRegionFallbacks = std::atoll(value.c_str());
+        } else if (arg == "--max-p99-drift") {
+            maxP99Drift = std::atof(value.c_str());
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "soak_client: Bad or missing value for " << arg << std::endl;
+            return 1;
+        }
+        ++i;
+    }
+    if (configFile.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+    double baselineThroughput = 0.0;
+    if (!baselinePath.empty() && !readBaseline(baselinePath, baselineThroughput)) {
+        std::cerr << "soak_client: No answered_per_sec in " << baselinePath << std::endl;
+        return 1;
+    }
+
+    try {
+        SoakClient client(options);
+        FIX::SessionSettings settings(configFile);
+        FIX::FileStoreFactory storeFactory(settings);
+        FIX::FileLogFactory logFactory(settings);
+        std::unique_ptr<FIX::Initiator> initiator = FixTransport::makeInitiator(client, storeFactory, settings, logFactory);
+        initiator->start();
+
+        for (int waited = 0; !client.isLoggedOn() && waited < 300; ++waited) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (!client.isLoggedOn()) {
+            std::cerr << "soak_client: No logon within 30s" << std::endl;
+            initiator->stop();
+            return 1;
+        }
+
+        const Metrics::Segment* segment = metricsName.empty() ? nullptr : Metrics::attach(metricsName);
+        if (!metricsName.empty() && !segment) {
+            std::cerr << "soak_client: No metrics segment " << metricsName << "; memory gates are skipped" << std::endl;
+        }
+        std::string snapshotPath = snapshotDir.empty() ? "" : snapshotDir + "/latest.snap";
+        SnapshotFormat::Contents startSnapshot;
+        bool haveStartSnapshot = !snapshotPath.empty() && SnapshotFormat::read(snapshotPath, startSnapshot);
+        if (!snapshotPath.empty() && !haveStartSnapshot) {
+            std::cerr << "soak_client: No readable snapshot at " << snapshotPath
+                      << "; book and position checks are skipped" << std::endl;
+        }
+        uint64_t startQuoteFills = segment ? segment->counters[Metrics::QuoteFills].value.load() : 0;
+        unsigned bookProblems = 0;
+        if (haveStartSnapshot) {
+            std::map<std::string, std::pair<double, double> > prices;
+            bookProblems += checkBook(startSnapshot, prices);
+            client.setReferencePrices(prices);
+        }
+
+        // 1. Soak
+        std::printf("%8s %10s %10s %10s %10s %10s %12s %10s %10s %10s\n", "elapsed", "answers/s", "p50_us", "p99_us",
+                    "max_us", "rss_mb", "live_allocs", "region_kb", "fallbacks", "violations");
+        std::vector<Interval> intervals;
+        SoakClient::Stats previous = client.stats();
+        SoakClient::Latencies latencies;
+        auto start = std::chrono::steady_clock::now();
+        auto previousTime = start;
+        client.start();
+        double elapsed = 0.0;
+        while (elapsed < durationS) {
+            double step = std::min(reportS, durationS - elapsed);
+            std::this_thread::sleep_for(std::chrono::duration<double>(step));
+            auto now = std::chrono::steady_clock::now();
+            elapsed = std::chrono::duration<double>(now - start).count();
+            double seconds = std::chrono::duration<double>(now - previousTime).count();
+            previousTime = now;
+
+            client.expireOverdue();
+            SoakClient::Stats stats = client.stats();
+            client.takeLatencies(latencies);
+
+            SnapshotFormat::Contents snapshot;
+            if (haveStartSnapshot && SnapshotFormat::read(snapshotPath, snapshot)) {
+                std::map<std::string, std::pair<double, double> > prices;
+                bookProblems += checkBook(snapshot, prices);
+                client.setReferencePrices(prices);
+            }
+
+            Interval interval;
+            interval.elapsedS = elapsed;
+            interval.answeredPerS = (stats.answered - previous.answered) / seconds;
+            interval.p50Ns = latencies.percentile(0.5);
+            interval.p99Ns = latencies.percentile(0.99);
+            interval.maxNs = latencies.maxNs;
+            interval.rssBytes = segment ? residentBytes(segment->pid) : -1;
+            interval.liveAllocations = segment ? static_cast<long long>(Metrics::allocations(*segment) -
+                                                                         Metrics::deallocations(*segment)) : 0;
+            interval.regionBytes = segment ? static_cast<long long>(
+                segment->gauges[Metrics::RegionBytesUsed].value.load(std::memory_order_relaxed)) : 0;
+            interval.regionFallbacks = segment ? static_cast<long long>(
+                segment->gauges[Metrics::RegionHeapFallbacks].value.load(std::memory_order_relaxed)) : 0;
+            interval.violations = stats.violations + bookProblems;
+            intervals.push_back(interval);
+            previous = stats;
+
+            std::printf("%8.0f %10.1f %10.1f %10.1f %10.1f %10.1f %12lld %10lld %10lld %10llu\n", interval.elapsedS,
+                        interval.answeredPerS, interval.p50Ns / 1000.0, interval.p99Ns / 1000.0,
+                        interval.maxNs / 1000.0, interval.rssBytes < 0 ? -1.0 : interval.rssBytes / 1048576.0,
+                        interval.liveAllocations, interval.regionBytes / 1024, interval.regionFallbacks,
+                        static_cast<unsigned long long>(interval.violations));
+            std::fflush(stdout);
+        }
+        client.stop();
+        if (!client.drain(options.timeoutMs)) {
+            client.expireOverdue();
+        }
+
+        // 2. Totals
+        SoakClient::Stats stats = client.stats();
+        const char* kindNames[SoakClient::KindCount] = {"valid", "invalid", "duplicate", "extreme", "stale", "resend"};
+        std::printf("\nsent:");
+        for (int k = 0; k < SoakClient::KindCount; ++k) {
+            std::printf(" %s %llu", kindNames[k], static_cast<unsigned long long>(stats.sent[k]));
+        }
+        std::printf("\nanswered %llu: fills %llu, rejects %llu, session rejects %llu; resent reports ignored %llu\n",
+                    static_cast<unsigned long long>(stats.answered), static_cast<unsigned long long>(stats.fills),
+                    static_cast<unsigned long long>(stats.rejects),
+                    static_cast<unsigned long long>(stats.sessionRejects),
+                    static_cast<unsigned long long>(stats.possDups));
+
+        bool passed = stats.violations == 0 && bookProblems == 0;
+        std::printf("violations: %llu in answers, %u in the book\n",
+                    static_cast<unsigned long long>(stats.violations), bookProblems);
+
+        // 3. Position consistency: the market maker's position moves opposite to ours.
+        // Only meaningful when nothing else traded with it during the run.
+        if (haveStartSnapshot) {
+            int64_t lastAnswer = client.lastAnswerWallNs();
+            SnapshotFormat::Contents endSnapshot;
+            bool haveEnd = false;
+            for (int waited = 0; waited < 100; ++waited) {
+                if (SnapshotFormat::read(snapshotPath, endSnapshot) && endSnapshot.header.takenAtNs > lastAnswer) {
+                    haveEnd = true;
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            bool otherFills = segment && segment->counters[Metrics::QuoteFills].value.load() != startQuoteFills;
+            if (!haveEnd) {
+                std::printf("positions: no snapshot newer than the last fill; not checked\n");
+            } else if (otherFills) {
+                std::printf("positions: quotes were filled upstream during the run; not checked\n");
+            } else {
+                std::map<std::string, long long> before = positionsOf(startSnapshot);
+                std::map<std::string, long long> after = positionsOf(endSnapshot);
+                std::map<std::string, long long> ours = client.positions();
+                unsigned mismatches = 0;
+                for (const auto& entry : after) {
+                    long long expected = -ours[entry.first];
+                    long long moved = entry.second - before[entry.first];
+                    if (moved != expected) {
+                        std::cerr << "soak_client: VIOLATION position in " << entry.first << " moved by " << moved
+                                  << ", client fills say " << expected << std::endl;
+                        ++mismatches;
+                    }
+                }
+                for (const auto& entry : ours) {
+                    if (entry.second != 0 && !after.count(entry.first)) {
+                        std::cerr << "soak_client: VIOLATION no market maker position in " << entry.first
+                                  << " after client fills of " << entry.second << std::endl;
+                        ++mismatches;
+                    }
+                }
+                std::printf("positions: %u mismatches%s\n", mismatches,
+                            segment ? "" : " (assumes no upstream quote fills: no metrics segment)");
+                passed = passed && mismatches == 0;
+            }
+        }
+
+        // 4. Gates, over the intervals after warmup
+        std::vector<Interval> steady;
+        for (const Interval& interval : intervals) {
+            if (interval.elapsedS > warmupS) {
+                steady.push_back(interval);
+            }
+        }
+        if (steady.size() < 2) {
+            std::printf("gates: fewer than two intervals after warmup; throughput, drift and growth not checked\n");
+        } else {
+            const Interval& first = steady.front();
+            const Interval& last = steady.back();
+            double throughput = 0.0;
+            for (const Interval& interval : steady) {
+                throughput += interval.answeredPerS;
+            }
+            throughput /= steady.size();
+
+            std::printf("throughput: %.1f answers/s", throughput);
+            if (baselineThroughput > 0.0) {
+                bool ok = throughput >= baselineThroughput * (1.0 - tolerance);
+                std::printf(" vs baseline %.1f: %s", baselineThroughput, ok ? "ok" : "FAILED");
+                passed = passed && ok;
+            }
+            std::printf("\n");
+
+            double drift = first.p99Ns > 0 ? static_cast<double>(last.p99Ns) / first.p99Ns : 1.0;
+            bool driftOk = drift <= maxP99Drift;
+            std::printf("p99 drift: %.1fus -> %.1fus (x%.2f): %s\n", first.p99Ns / 1000.0, last.p99Ns / 1000.0, drift,
+                        driftOk ? "ok" : "FAILED");
+            passed = passed && driftOk;
+
+            if (segment && first.rssBytes >= 0 && last.rssBytes >= 0) {
+                double growthMb = (last.rssBytes - first.rssBytes) / 1048576.0;
+                bool ok = growthMb <= maxRssGrowthMb;
+                std::printf("rss growth: %.1fMB: %s\n", growthMb, ok ? "ok" : "FAILED");
+                passed = passed && ok;
+            }
+            if (segment) {
+                long long growth = last.liveAllocations - first.liveAllocations;
+                bool ok = growth <= maxLiveAllocGrowth;
+                std::printf("live allocation growth: %lld: %s\n", growth, ok ? "ok" : "FAILED");
+                passed = passed && ok;
+
+                // Freed arena blocks are reused, so steady-state churn leaves the bump offset alone
+                long long regionGrowthKb = (last.regionBytes - first.regionBytes) / 1024;
+                ok = regionGrowthKb <= maxRegionGrowthKb;
+                std::printf("memory region growth: %lldKB: %s\n", regionGrowthKb, ok ? "ok" : "FAILED");
+                passed = passed && ok;
+
+                long long fallbacks = last.regionFallbacks - first.regionFallbacks;
+                ok = fallbacks <= maxRegionFallbacks;
+                std::printf("memory region heap fallbacks: %lld: %s\n", fallbacks, ok ? "ok" : "FAILED");
+                passed = passed && ok;
+            }
+
+            if (!writeBaselinePath.empty()) {
+                std::ofstream out(writeBaselinePath.c_str());
+                out << "answered_per_sec " << throughput << "\n";
+                if (!out) {
+                    std::cerr << "soak_client: Could not write " << writeBaselinePath << std::endl;
+                    passed = false;
+                }
+            }
+        }
+
+        initiator->stop();
+        std::printf("%s\n", passed ? "PASSED" : "FAILED");
+        return passed ? 0 : 1;
+
+    } catch (const FIX::Exception& e) {
+        std::cerr << "FIX Exception: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Standard Exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
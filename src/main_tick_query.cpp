@@ -0,0 +1,249 @@
+// src/main_tick_query.cpp
+// Research queries against the tick store written by market_maker: a summary of one
+// symbol's day (default), the rows as CSV, or OHLC bars. Only blocks overlapping the
+// requested time window are decoded.
+#include "TickStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+
+static void usage(const char* program) {
+    std::cout << "usage: " << program << " <store_dir> <YYYYMMDD> <SYMBOL> [options]\n"
+              << "  --fills             query our fills instead of market data quotes\n"
+              << "  --from HH:MM:SS     start of the window, UTC (default 00:00:00)\n"
+              << "  --to HH:MM:SS       end of the window, inclusive (default end of day)\n"
+              << "  --min-price P       only blocks trading at or above P\n"
+              << "  --max-price P       only blocks trading at or below P\n"
+              << "  --csv               print the rows instead of a summary\n"
+              << "  --bars SECONDS      print OHLC bars of the bid (quotes) or fill price" << std::endl;
+}
+
+// HH:MM:SS[.fraction] to ns since midnight
+static bool parseTimeOfDay(const std::string& text, int64_t& ns) {
+    int hours = 0;
+    int minutes = 0;
+    double seconds = 0.0;
+    if (std::sscanf(text.c_str(), "%d:%d:%lf", &hours, &minutes, &seconds) != 3 ||
+        hours < 0 || hours > 24 || minutes < 0 || minutes > 59 || seconds < 0.0 || seconds >= 61.0) {
+        return false;
+    }
+    ns = (hours * 3600LL + minutes * 60LL) * 1000000000LL + static_cast<int64_t>(seconds * 1e9);
+    return true;
+}
+
+static std::string formatTime(int64_t timeNs, int64_t midnightNs) {
+    int64_t ns = timeNs - midnightNs;
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%02lld:%02lld:%02lld.%09lld",
+                  static_cast<long long>(ns / 3600000000000LL), static_cast<long long>(ns / 60000000000LL % 60),
+                  static_cast<long long>(ns / 1000000000LL % 60), static_cast<long long>(ns % 1000000000LL));
+    return buffer;
+}
+
+struct Bar {
+    int64_t startNs;
+    int64_t open;
+    int64_t high;
+    int64_t low;
+    int64_t close;
+    size_t rows;
+    long long volume; // Fills only
+};
+
+static void printBar(const Bar& bar, int64_t midnightNs, bool fills) {
+    std::printf("%s  open %12.6f  high %12.6f  low %12.6f  close %12.6f  %s %8zu",
+                formatTime(bar.startNs, midnightNs).c_str(), TickStoreFormat::fromScaled(bar.open),
+                TickStoreFormat::fromScaled(bar.high), TickStoreFormat::fromScaled(bar.low),
+                TickStoreFormat::fromScaled(bar.close), fills ? "fills" : "ticks", bar.rows);
+    if (fills) {
+        std::printf("  volume %10lld", bar.volume);
+    }
+    std::printf("\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        usage(argv[0]);
+        return 0;
+    }
+    std::string root = argv[1];
+    std::string day = argv[2];
+    std::string symbol = argv[3];
+
+    uint32_t kind = TickStoreFormat::Quotes;
+    bool csv = false;
+    int64_t barNs = 0;
+    int64_t fromOffsetNs = 0;
+    int64_t toOffsetNs = 86400LL * 1000000000LL - 1;
+    int64_t minPrice = std::numeric_limits<int64_t>::min();
+    int64_t maxPrice = std::numeric_limits<int64_t>::max();
+
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        std::string value = hasValue ? argv[i + 1] : "";
+        bool ok = true;
+        if (arg == "--fills") {
+            kind = TickStoreFormat::Fills;
+            continue;
+        } else if (arg == "--csv") {
+            csv = true;
+            continue;
+        } else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else if (!hasValue) {
+            ok = false;
+        } else if (arg == "--from") {
+            ok = parseTimeOfDay(value, fromOffsetNs);
+        } else if (arg == "--to") {
+            ok = parseTimeOfDay(value, toOffsetNs);
+        } else if (arg == "--min-price") {
+            minPrice = TickStoreFormat::toScaled(std::atof(value.c_str()));
+        } else if (arg == "--max-price") {
+            maxPrice = TickStoreFormat::toScaled(std::atof(value.c_str()));
+        } else if (arg == "--bars") {
+            barNs = static_cast<int64_t>(std::atof(value.c_str()) * 1e9);
+            ok = barNs > 0;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "tick_query: Bad or missing value for " << arg << std::endl;
+            return 1;
+        }
+        ++i;
+    }
+
+    int64_t midnightNs = 0;
+    if (!TickStoreFormat::parseDay(day, midnightNs)) {
+        std::cerr << "tick_query: Day must be YYYYMMDD, got " << day << std::endl;
+        return 1;
+    }
+
+    TickStoreReader reader;
+    std::string error;
+    std::string path = TickStoreReader::pathFor(root, day, symbol, kind);
+    if (!reader.open(path, error)) {
+        std::cerr << "tick_query: " << error << std::endl;
+        return 1;
+    }
+    if (reader.tornTail()) {
+        std::cerr << "tick_query: Last block of " << path << " is incomplete and was ignored" << std::endl;
+    }
+
+    bool fills = kind == TickStoreFormat::Fills;
+    if (csv) {
+        std::cout << (fills ? "time,price,qty" : "time,bid,ask,bid_size,ask_size") << "\n";
+    }
+
+    // Summary accumulators
+    int64_t firstTime = 0;
+    int64_t lastTime = 0;
+    int64_t lowPrice = std::numeric_limits<int64_t>::max();
+    int64_t highPrice = std::numeric_limits<int64_t>::min();
+    double spreadSum = 0.0;
+    long long volume = 0;
+    long long netQty = 0;
+    double notional = 0.0;
+    Bar bar = Bar();
+    bool barOpen = false;
+
+    auto start = std::chrono::steady_clock::now();
+    TickStoreReader::ScanStats stats = reader.scan(
+        midnightNs + fromOffsetNs, midnightNs + toOffsetNs, minPrice, maxPrice,
+        [&](const TickStoreReader::Batch& batch) {
+            const int64_t* time = batch.columns[0];
+            const int64_t* price = batch.columns[1];
+            if (firstTime == 0) {
+                firstTime = time[0];
+            }
+            lastTime = time[batch.rows - 1];
+
+            for (size_t i = 0; i < batch.rows; ++i) {
+                if (csv) {
+                    if (fills) {
+                        std::printf("%s,%.6f,%lld\n", formatTime(time[i], midnightNs).c_str(),
+                                    TickStoreFormat::fromScaled(price[i]), static_cast<long long>(batch.columns[2][i]));
+                    } else {
+                        std::printf("%s,%.6f,%.6f,%lld,%lld\n", formatTime(time[i], midnightNs).c_str(),
+                                    TickStoreFormat::fromScaled(price[i]),
+                                    TickStoreFormat::fromScaled(price[i] + batch.columns[TickStoreFormat::QuoteSpread][i]),
+                                    static_cast<long long>(batch.columns[TickStoreFormat::QuoteBidSize][i]),
+                                    static_cast<long long>(batch.columns[TickStoreFormat::QuoteAskSize][i]));
+                    }
+                    continue;
+                }
+                long long qty = fills ? batch.columns[TickStoreFormat::FillQty][i] : 0;
+                if (barNs > 0) {
+                    int64_t barStart = midnightNs + (time[i] - midnightNs) / barNs * barNs;
+                    if (barOpen && barStart != bar.startNs) {
+                        printBar(bar, midnightNs, fills);
+                        barOpen = false;
+                    }
+                    if (!barOpen) {
+                        bar = Bar();
+                        bar.startNs = barStart;
+                        bar.open = bar.high = bar.low = price[i];
+                        barOpen = true;
+                    }
+                    bar.high = std::max(bar.high, price[i]);
+                    bar.low = std::min(bar.low, price[i]);
+                    bar.close = price[i];
+                    ++bar.rows;
+                    bar.volume += qty < 0 ? -qty : qty;
+                    continue;
+                }
+                lowPrice = std::min(lowPrice, price[i]);
+                highPrice = std::max(highPrice, price[i]);
+                if (fills) {
+                    long long size = qty < 0 ? -qty : qty;
+                    volume += size;
+                    netQty += qty;
+                    notional += TickStoreFormat::fromScaled(price[i]) * static_cast<double>(size);
+                } else {
+                    spreadSum += TickStoreFormat::fromScaled(batch.columns[TickStoreFormat::QuoteSpread][i]);
+                }
+            }
+        });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (barOpen) {
+        printBar(bar, midnightNs, fills);
+    }
+    if (csv || barNs > 0) {
+        return 0;
+    }
+
+    // Raw size is every column as a plain int64
+    double rawBytes = static_cast<double>(stats.rows) * reader.columnCount() * sizeof(int64_t);
+    std::cout << "tick_query: " << path << "\n"
+              << "  blocks      " << stats.blocksRead << " decoded, " << stats.blocksSkipped << " skipped of "
+              << reader.blockCount() << " (" << reader.fileBytes() << " bytes on disk)\n"
+              << "  rows        " << stats.rows << "\n";
+    if (stats.rows == 0) {
+        std::cout << std::flush;
+        return 0;
+    }
+    std::printf("  compression %.2fx (%llu bytes decoded vs %.0f raw)\n",
+                stats.bytesDecoded > 0 ? rawBytes / static_cast<double>(stats.bytesDecoded) : 0.0,
+                static_cast<unsigned long long>(stats.bytesDecoded), rawBytes);
+    std::printf("  scan        %.3f ms, %.1f M rows/s\n", seconds * 1e3,
+                seconds > 0.0 ? stats.rows / seconds / 1e6 : 0.0);
+    std::printf("  time        %s .. %s\n", formatTime(firstTime, midnightNs).c_str(),
+                formatTime(lastTime, midnightNs).c_str());
+    std::printf("  %s       %.6f .. %.6f\n", fills ? "price" : "bid  ", TickStoreFormat::fromScaled(lowPrice),
+                TickStoreFormat::fromScaled(highPrice));
+    if (fills) {
+        std::printf("  volume      %lld (net %lld), vwap %.6f\n", volume, netQty,
+                    volume > 0 ? notional / static_cast<double>(volume) : 0.0);
+    } else {
+        std::printf("  avg spread  %.6f\n", spreadSum / static_cast<double>(stats.rows));
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+// tests/QuoteBookTest.cpp
+// QuoteBook state machine: what reconcile() sends after acks, fills and replaces
+#include "QuoteBook.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+int s_failures = 0;
+
+#define CHECK(condition)                                                          \
+    do {                                                                          \
+        if (!(condition)) {                                                       \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+                         #condition);                                             \
+            ++s_failures;                                                         \
+        }                                                                         \
+    } while (0)
+
+// A bid quoted, acked and then partially filled: 200 @ 10.00 with 153 filled
+std::string partiallyFilledBid(QuoteBook& book, IdGenerator& ids) {
+    std::vector<QuoteBook::Action> actions;
+    book.reconcile("X", QuoteBook::Bid, 10.00, 200, ids, actions);
+    std::string clOrdID = actions[0].clOrdID;
+    book.onNewAck(clOrdID, "O1");
+    book.onFill(clOrdID, 47);
+    return clOrdID;
+}
+
+void testPartialFillThenSameQuoteIsUnchanged() {
+    QuoteBook book;
+    IdGenerator ids("T");
+    partiallyFilledBid(book, ids);
+
+    // What is left working is what we want: nothing to send
+    std::vector<QuoteBook::Action> actions;
+    book.reconcile("X", QuoteBook::Bid, 10.00, 47, ids, actions);
+    CHECK(actions.empty());
+    CHECK(book.stats().unchanged == 1);
+}
+
+void testTopUpSendsOrderQtyIncludingCumQty() {
+    QuoteBook book;
+    IdGenerator ids("T");
+    partiallyFilledBid(book, ids);
+
+    std::vector<QuoteBook::Action> actions;
+    book.reconcile("X", QuoteBook::Bid, 10.00, 200, ids, actions);
+    CHECK(actions.size() == 1);
+    CHECK(actions[0].type == QuoteBook::Action::Replace);
+    CHECK(actions[0].size == 353);
+    CHECK(actions[0].cumQty == 153);
+
+    // The venue leaves newQty - cumQty = 200 working; the next pass is quiet
+    book.onReplaceAck(actions[0].clOrdID, "O1", 200);
+    actions.clear();
+    book.reconcile("X", QuoteBook::Bid, 10.00, 200, ids, actions);
+    CHECK(actions.empty());
+}
+
+void testFillsWhileReplacePending() {
+    QuoteBook book;
+    IdGenerator ids("T");
+    std::string original = partiallyFilledBid(book, ids);
+
+    std::vector<QuoteBook::Action> actions;
+    book.reconcile("X", QuoteBook::Bid, 10.01, 47, ids, actions);
+    CHECK(actions.size() == 1);
+    CHECK(actions[0].size == 200);
+
+    // 7 more fill on the original before the replace lands; the ack carries no LeavesQty
+    book.onFill(original, 40);
+    book.onReplaceAck(actions[0].clOrdID, "O1");
+    const QuoteBook::Quote* quote = book.find("X", QuoteBook::Bid);
+    CHECK(quote && quote->state == QuoteBook::Live);
+    CHECK(quote && quote->leavesQty() == 40);
+}
+
+void testReplaceAckWithNothingLeftFreesTheSide() {
+    QuoteBook book;
+    IdGenerator ids("T");
+    std::string original = partiallyFilledBid(book, ids);
+
+    std::vector<QuoteBook::Action> actions;
+    book.reconcile("X", QuoteBook::Bid, 10.01, 20, ids, actions);
+    book.onFill(original, 10);
+    book.onReplaceAck(actions[0].clOrdID, "O1", 0);
+    CHECK(book.find("X", QuoteBook::Bid) == nullptr);
+    CHECK(!book.isOurs(actions[0].clOrdID));
+    CHECK(!book.isOurs(original));
+}
+
+} // namespace
+
+int main() {
+    testPartialFillThenSameQuoteIsUnchanged();
+    testTopUpSendsOrderQtyIncludingCumQty();
+    testFillsWhileReplacePending();
+    testReplaceAckWithNothingLeftFreesTheSide();
+    if (s_failures > 0) {
+        std::fprintf(stderr, "QuoteBookTest: %d check(s) failed\n", s_failures);
+        return 1;
+    }
+    std::printf("QuoteBookTest: ok\n");
+    return 0;
+}